@@ -0,0 +1,430 @@
+/**
+ * @brief Microbenchmarks of driver, parser, facade and flight recorder hot paths.
+ *
+ * Built as de_rpi_gpio_bench in TEST_MODE_NO_WIRINGPI_LINK - no hardware is touched.
+ * Results are printed as JSON so runs can be diffed:
+ *
+ *      de_rpi_gpio_bench [name filter] > bench.json
+ *
+ * ns_per_op:       wall time per operation.
+ * allocs_per_op:   calls to any form of operator new per operation.
+ * ops_per_sec:     throughput.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <cstddef>
+#include <unistd.h>
+
+#include "../de_common/de_databus/messages.hpp"
+#include "../gpio/gpio_driver.hpp"
+#include "../gpio/gpio_parser.hpp"
+#include "../gpio/gpio_facade.hpp"
+#include "../gpio/gpio_status_codec.hpp"
+#include "../gpio/gpio_command_codec.hpp"
+#include "../gpio/gpio_main.hpp"
+#include "../gpio/gpio_recorder.hpp"
+
+
+#define BENCH_MIN_TIME_NS   200000000ull  // each benchmark runs at least this long
+
+
+using namespace de::gpio;
+
+
+static std::atomic<uint64_t> s_allocations {0};
+
+
+/**
+ * @brief every form of operator new & delete goes through these two.
+ * not inlined - the compiler would otherwise pair its free() with operator new and warn.
+ */
+__attribute__((noinline)) static void* benchAllocate (size_t size, const size_t alignment = 0) noexcept
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+__attribute__((noinline)) static void benchRelease (void* p) noexcept
+{
+    std::free(p);
+}
+
+static void* benchAllocateOrThrow (const size_t size, const size_t alignment = 0)
+{
+    void* p = benchAllocate(size, alignment);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+
+void* operator new (size_t size) { return benchAllocateOrThrow(size); }
+void* operator new[] (size_t size) { return benchAllocateOrThrow(size); }
+void* operator new (size_t size, std::align_val_t alignment) { return benchAllocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[] (size_t size, std::align_val_t alignment) { return benchAllocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept { return benchAllocate(size); }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept { return benchAllocate(size); }
+void* operator new (size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return benchAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new[] (size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return benchAllocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete (void* p) noexcept { benchRelease(p); }
+void operator delete[] (void* p) noexcept { benchRelease(p); }
+void operator delete (void* p, size_t) noexcept { benchRelease(p); }
+void operator delete[] (void* p, size_t) noexcept { benchRelease(p); }
+void operator delete (void* p, std::align_val_t) noexcept { benchRelease(p); }
+void operator delete[] (void* p, std::align_val_t) noexcept { benchRelease(p); }
+void operator delete (void* p, size_t, std::align_val_t) noexcept { benchRelease(p); }
+void operator delete[] (void* p, size_t, std::align_val_t) noexcept { benchRelease(p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept { benchRelease(p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept { benchRelease(p); }
+void operator delete (void* p, std::align_val_t, const std::nothrow_t&) noexcept { benchRelease(p); }
+void operator delete[] (void* p, std::align_val_t, const std::nothrow_t&) noexcept { benchRelease(p); }
+
+
+/**
+ * @brief discards console output of the code under test.
+ */
+class CNullBuffer : public std::streambuf
+{
+    protected:
+        int overflow (int c) override { return c; }
+};
+
+
+typedef struct BENCH_RESULT{
+        std::string name;
+        uint param;
+        uint64_t iterations;
+        double ns_per_op;
+        double allocs_per_op;
+        double ops_per_sec;
+    } BENCH_RESULT;
+
+
+static std::vector<BENCH_RESULT> s_results;
+static std::string s_filter;
+
+
+/**
+ * @brief run op in growing batches until BENCH_MIN_TIME_NS elapsed.
+ */
+template <typename OP>
+static void runBench (const std::string& name, const uint param, OP op)
+{
+    if (!s_filter.empty() && (name.find(s_filter) == std::string::npos)) return ;
+
+    // warm up caches & lazy allocations.
+    for (uint i = 0; i < 100; ++i) op();
+
+    uint64_t iterations = 0;
+    uint64_t batch = 16;
+    uint64_t elapsed_ns = 0;
+    uint64_t allocations = 0;
+
+    while (elapsed_ns < BENCH_MIN_TIME_NS)
+    {
+        const uint64_t allocations_start = s_allocations.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < batch; ++i) op();
+
+        elapsed_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        allocations += s_allocations.load(std::memory_order_relaxed) - allocations_start;
+        iterations += batch;
+        batch *= 2;
+    }
+
+    BENCH_RESULT result;
+    result.name = name;
+    result.param = param;
+    result.iterations = iterations;
+    result.ns_per_op = static_cast<double>(elapsed_ns) / iterations;
+    result.allocs_per_op = static_cast<double>(allocations) / iterations;
+    result.ops_per_sec = 1e9 / result.ns_per_op;
+    s_results.push_back(result);
+}
+
+
+static GPIO makeGPIO (const uint pin_number, const uint pin_mode, const std::string& name)
+{
+    GPIO gpio;
+    gpio.pin_number = pin_number;
+    gpio.pin_mode = pin_mode;
+    gpio.pin_value = (pin_mode == PWM_OUTPUT) ? 50 : 0;
+    gpio.pin_pwm_width = 0;
+    gpio.gpio_type = ENUM_GPIO_TYPE::GENERIC;
+    gpio.pin_name = name;
+    return gpio;
+}
+
+
+/**
+ * @brief remove all pins then configure pins 0..count-1 as named outputs.
+ * pin 18 is PWM_OUTPUT when included.
+ */
+static void configurePins (const uint count)
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    driver.init();
+
+    for (uint i = 0; i < count; ++i)
+    {
+        driver.configurePort(makeGPIO(i, (i == 18) ? PWM_OUTPUT : OUTPUT, "pin_" + std::to_string(i)));
+    }
+}
+
+
+static void benchDriver ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    configurePins(MAX_GPIO_PINS);
+
+    uint value = 0;
+    runBench("driver.writePin", 0, [&](){ driver.writePin(17, value ^= 1); });
+
+    uint width = 0;
+    runBench("driver.writePWM", 0, [&](){ driver.writePWM(18, 50, (width += 7) % MAX_PWM); });
+
+    // lookup cost against number of configured pins - last configured pin is looked up.
+    for (const uint count : {1u, 8u, 16u, 32u, 54u})
+    {
+        configurePins(count);
+        const std::string name = "pin_" + std::to_string(count - 1);
+        const uint pin_number = count - 1;
+
+        runBench("driver.getGPIOByName", count, [&](){ if (driver.getGPIOByName(name) == nullptr) std::abort(); });
+        runBench("driver.getGPIOByNumber", count, [&](){ if (driver.getGPIOByNumber(pin_number) == nullptr) std::abort(); });
+    }
+}
+
+
+static std::string textMessage (const int message_type, const Json_de& cmd)
+{
+    const Json_de message = {
+        {ANDRUAV_PROTOCOL_MESSAGE_TYPE, message_type},
+        {ANDRUAV_PROTOCOL_SENDER, "bench"},
+        {ANDRUAV_PROTOCOL_MESSAGE_PERMISSION, 0},
+        {ANDRUAV_PROTOCOL_MESSAGE_CMD, cmd}
+    };
+
+    return message.dump();
+}
+
+
+static std::string binaryMessage (const int message_type, const std::vector<uint8_t>& payload)
+{
+    std::string message = textMessage(message_type, {{"a", GPIO_ACTION_PORT_WRITE}});
+    message.push_back('\0');
+    message.append(reinterpret_cast<const char*>(payload.data()), payload.size());
+    return message;
+}
+
+
+/**
+ * @brief parseMessage with pre-parsed JSON, and JSON decode + parseMessage as in onReceive.
+ */
+static void benchParseMessage (const std::string& name, const std::string& message)
+{
+    CGPIOParser& parser = CGPIOParser::getInstance();
+
+    const size_t header_length = strlen(message.c_str());
+    Json_de parsed = Json_de::parse(message.c_str(), message.c_str() + header_length);
+
+    runBench("parser.parseMessage." + name, 0, [&](){
+        Json_de json = parsed;
+        parser.parseMessage(json, message.c_str(), message.size());
+    });
+
+    runBench("parser.decode+parseMessage." + name, 0, [&](){
+        Json_de json = Json_de::parse(message.c_str(), message.c_str() + header_length);
+        parser.parseMessage(json, message.c_str(), message.size());
+    });
+}
+
+
+static void benchParser ()
+{
+    configurePins(MAX_GPIO_PINS);
+
+    benchParseMessage("port_config", textMessage(TYPE_AndruavMessage_GPIO_ACTION,
+        {{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 20}, {"m", OUTPUT}, {"v", 0}, {"n", "pin_20"}}));
+
+    benchParseMessage("port_write", textMessage(TYPE_AndruavMessage_GPIO_ACTION,
+        {{"a", GPIO_ACTION_PORT_WRITE}, {"n", "pin_17"}, {"v", 1}}));
+
+    benchParseMessage("port_write_pwm", textMessage(TYPE_AndruavMessage_GPIO_ACTION,
+        {{"a", GPIO_ACTION_PORT_WRITE}, {"p", 18}, {"v", 50}, {"d", 300}}));
+
+    Json_de batch = Json_de::array();
+    for (uint i = 0; i < 8; ++i) batch.push_back({{"p", 20 + i}, {"v", i & 1}});
+    benchParseMessage("port_write_batch8", textMessage(TYPE_AndruavMessage_GPIO_ACTION,
+        {{"a", GPIO_ACTION_PORT_WRITE}, {"l", batch}}));
+
+    benchParseMessage("port_read", textMessage(TYPE_AndruavMessage_GPIO_ACTION,
+        {{"a", GPIO_ACTION_PORT_READ}, {"p", 17}}));
+
+    benchParseMessage("gpio_status", textMessage(TYPE_AndruavMessage_GPIO_REMOTE_EXECUTE,
+        {{"a", TYPE_AndruavMessage_GPIO_STATUS}}));
+
+    // binary fast path - same commands as port_write and port_write_batch8.
+    std::vector<uint8_t> payload;
+    GPIO_WRITE_COMMAND command = {17, 1, 0, false};
+    CGPIOCommandCodec::encodeWrite(&command, 1, payload);
+    benchParseMessage("binary_port_write", binaryMessage(TYPE_AndruavMessage_GPIO_ACTION, payload));
+
+    GPIO_WRITE_COMMAND commands[8];
+    for (uint i = 0; i < 8; ++i) commands[i] = {20 + i, i & 1, 0, false};
+    CGPIOCommandCodec::encodeWrite(commands, 8, payload);
+    benchParseMessage("binary_port_write_batch8", binaryMessage(TYPE_AndruavMessage_GPIO_ACTION, payload));
+
+    // decode only - no pin writes.
+    runBench("codec.decodeWrite.batch8", 0, [&](){
+        GPIO_WRITE_COMMAND decoded[8];
+        size_t count;
+        CGPIOCommandCodec::decodeWrite(payload.data(), payload.size(), decoded, 8, count);
+    });
+
+    const std::string json_batch = textMessage(TYPE_AndruavMessage_GPIO_ACTION, {{"a", GPIO_ACTION_PORT_WRITE}, {"l", batch}});
+    runBench("codec.jsonParse.batch8", 0, [&](){
+        Json_de json = Json_de::parse(json_batch);
+    });
+}
+
+
+/**
+ * @brief status message as built before the facade cache - one JSON tree per call.
+ */
+static std::string rebuildStatusJSON (const std::vector<GPIO>& gpios)
+{
+    Json_de json_array = Json_de::array();
+
+    for (const GPIO& gpio : gpios)
+    {
+        Json_de json_gpio = {
+            {"i", ""},
+            {"p", gpio.pin_number},
+            {"b", gpio.pin_number},
+            {"m", gpio.pin_mode},
+            {"t", gpio.gpio_type},
+            {"d", gpio.pin_pwm_width},
+            {"v", gpio.pin_value}
+        };
+        if (!gpio.pin_name.empty()) json_gpio["n"] = gpio.pin_name;
+        json_array.push_back(json_gpio);
+    }
+
+    const Json_de message = {{"a", GPIO_ACTION_INFO}, {"s", json_array}};
+    return message.dump();
+}
+
+
+static void benchFacade ()
+{
+    CGPIO_Facade& facade = CGPIO_Facade::getInstance();
+    CGPIODriver& driver = CGPIODriver::getInstance();
+
+    for (const uint count : {1u, 8u, 16u, 32u, 54u})
+    {
+        configurePins(count);
+
+        runBench("facade.API_sendGPIOStatus", count, [&](){ facade.API_sendGPIOStatus("", true); });
+
+        // one pin changes between messages - cached entries of other pins are reused.
+        uint value = 0;
+        runBench("facade.API_sendGPIOStatus.one_changed", count, [&](){
+            driver.writePin(0, value ^= 1);
+            facade.API_sendGPIOStatus("", true);
+        });
+
+        runBench("facade.rebuildStatusJSON", count, [&](){
+            const std::string message = rebuildStatusJSON(driver.getGPIOStatus());
+        });
+
+        std::vector<uint8_t> buffer;
+        runBench("codec.encodeStatus", count, [&](){
+            const std::vector<GPIO> gpios = driver.getGPIOStatus();
+            CGPIOStatusCodec::encode(gpios.data(), gpios.size(), buffer);
+        });
+    }
+}
+
+
+/**
+ * @brief record append - called on every write, command & edge while the recorder is open.
+ * ring is in a file under /tmp that is removed afterwards.
+ */
+static void benchRecorder ()
+{
+    CGPIORecorder& recorder = CGPIORecorder::getInstance();
+    CGPIODriver& driver = CGPIODriver::getInstance();
+
+    const std::string path = "/tmp/de_rpi_gpio_bench_" + std::to_string(getpid()) + ".rec";
+    if (!recorder.open(path, GPIO_RECORDER_DEFAULT_RECORDS)) return ;
+
+    uint value = 0;
+    runBench("recorder.record", 0, [&](){ recorder.record(GPIO_RECORD_PIN, 17, value ^= 1); });
+
+    // same write as driver.writePin - difference is the cost of recording it.
+    configurePins(MAX_GPIO_PINS);
+    runBench("driver.writePin.recorded", 0, [&](){ driver.writePin(17, value ^= 1); });
+
+    recorder.close();
+    unlink(path.c_str());
+}
+
+
+static void printResults ()
+{
+    std::ostringstream out;
+    out.precision(6);
+    out << std::fixed;
+
+    out << "{\n  \"benchmark\": \"de_rpi_gpio\",\n  \"version\": \"" << __APP__VERSION__ << "\",\n  \"results\": [\n";
+    for (size_t i = 0; i < s_results.size(); ++i)
+    {
+        const BENCH_RESULT& result = s_results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"param\": " << result.param
+            << ", \"iterations\": " << result.iterations
+            << ", \"ns_per_op\": " << result.ns_per_op
+            << ", \"allocs_per_op\": " << result.allocs_per_op
+            << ", \"ops_per_sec\": " << result.ops_per_sec << "}"
+            << ((i + 1 < s_results.size()) ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+
+    fwrite(out.str().data(), 1, out.str().size(), stdout);
+}
+
+
+int main (int argc, char *argv[])
+{
+    if (argc > 1) s_filter = argv[1];
+
+    // code under test logs to console - keep stdout for results only.
+    CNullBuffer null_buffer;
+    std::streambuf* cout_buffer = std::cout.rdbuf(&null_buffer);
+    std::streambuf* cerr_buffer = std::cerr.rdbuf(&null_buffer);
+
+    benchDriver();
+    benchParser();
+    benchFacade();
+    benchRecorder();
+
+    std::cout.rdbuf(cout_buffer);
+    std::cerr.rdbuf(cerr_buffer);
+
+    printResults();
+
+    return 0;
+}
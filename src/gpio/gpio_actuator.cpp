@@ -0,0 +1,436 @@
+#include <iostream>
+#include <cstring>
+#include <pthread.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_driver.hpp"
+#include "gpio_notifier.hpp"
+#include "gpio_actuator.hpp"
+
+
+using namespace de::gpio;
+
+
+void CGPIOActuatorRing::init (const size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+
+    m_slots.reset(new GPIO_ACTUATOR_COMMAND[size]);
+    m_capacity = size;
+    m_mask = size - 1;
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief allocate lanes and start actuator thread.
+ * @param queue_size commands per lane.
+ */
+bool CGPIOActuator::start (const size_t queue_size)
+{
+    if (isRunning()) return true;
+
+    for (GPIO_ACTUATOR_LANE& lane : m_lanes)
+    {
+        lane.ring.init(queue_size == 0 ? GPIO_ACTUATOR_DEFAULT_QUEUE : queue_size);
+    }
+
+    m_batch.reserve(GPIO_ACTUATOR_PINS);
+    m_batch_index.fill(-1);
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit_thread = false;
+    }
+
+    m_thread = std::thread{[&](){ loopActuator(); }};
+    m_running.store(true, std::memory_order_release);
+
+    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "GPIO actuator started - " << m_lanes[0].ring.getCapacity() << " commands per lane." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    return true;
+}
+
+
+/**
+ * @brief stop thread. Commands still queued are executed first.
+ */
+void CGPIOActuator::uninit ()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit_thread = true;
+    }
+
+    m_condition.notify_all();
+
+    if (m_thread.joinable()) m_thread.join();
+
+    m_running.store(false, std::memory_order_release);
+}
+
+
+/**
+ * @brief queue writes that are applied together. Writes to SYSTEM pins go to GPIO_ACTUATOR_LANE_PRIORITY
+ * and replace writes to the same pins still queued in lower lanes.
+ * @return false if lane is full - writes are dropped.
+ */
+bool CGPIOActuator::submitWrites (const uint lane, const GPIO_WRITE_COMMAND* commands, const size_t count)
+{
+    if (count == 0) return true;
+
+    if (!isRunning())
+    {
+        applyWrites(commands, count);
+        return true;
+    }
+
+    if (lane == GPIO_ACTUATOR_LANE_PRIORITY)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint pin_number = commands[i].pin_number;
+            if (pin_number < GPIO_ACTUATOR_PINS) m_pin_generation[pin_number].fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    // trace continues on actuator thread.
+    const GPIO_LATENCY_TRACE trace = CGPIOLatency::getInstance().detach();
+
+    GPIO_ACTUATOR_LANE& actuator_lane = m_lanes[lane];
+    const size_t depth = actuator_lane.ring.push(count, [&](GPIO_ACTUATOR_COMMAND& command, const size_t i){
+        command.type = GPIO_ACTUATOR_COMMAND_WRITE;
+        command.write = commands[i];
+        command.trace = (i == 0) ? trace : GPIO_LATENCY_TRACE();
+        command.generation = getPinGeneration(commands[i].pin_number);
+    });
+
+    onPushed(actuator_lane, count, depth);
+
+    return depth != 0;
+}
+
+
+/**
+ * @brief queue a command that is executed as a whole on actuator thread.
+ * @return false if lane is full - task is dropped.
+ */
+bool CGPIOActuator::submitTask (const uint lane, std::function<void()> task)
+{
+    if (!isRunning())
+    {
+        task();
+        return true;
+    }
+
+    const GPIO_LATENCY_TRACE trace = CGPIOLatency::getInstance().detach();
+
+    GPIO_ACTUATOR_LANE& actuator_lane = m_lanes[lane];
+    const size_t depth = actuator_lane.ring.push(1, [&](GPIO_ACTUATOR_COMMAND& command, const size_t){
+        command.type = GPIO_ACTUATOR_COMMAND_TASK;
+        command.task = std::move(task);
+        command.trace = trace;
+    });
+
+    onPushed(actuator_lane, 1, depth);
+
+    return depth != 0;
+}
+
+
+GPIO_ACTUATOR_STATS CGPIOActuator::getStats (const uint lane) const
+{
+    GPIO_ACTUATOR_STATS stats;
+    if (lane >= GPIO_ACTUATOR_LANES) return stats;
+
+    const GPIO_ACTUATOR_LANE& actuator_lane = m_lanes[lane];
+    stats.depth = actuator_lane.ring.size();
+    stats.max_depth = actuator_lane.max_depth.load(std::memory_order_relaxed);
+    stats.pushed = actuator_lane.pushed.load(std::memory_order_relaxed);
+    stats.executed = actuator_lane.executed.load(std::memory_order_relaxed);
+    stats.coalesced = actuator_lane.coalesced.load(std::memory_order_relaxed);
+    stats.rejected = actuator_lane.rejected.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+
+const char* CGPIOActuator::getLaneName (const uint lane)
+{
+    switch (lane)
+    {
+        case GPIO_ACTUATOR_LANE_PRIORITY:   return "priority";
+        case GPIO_ACTUATOR_LANE_NORMAL:     return "normal";
+        case GPIO_ACTUATOR_LANE_BULK:       return "bulk";
+        default:                            return "unknown";
+    }
+}
+
+
+/**
+ * @brief producer side counters & wake up of actuator thread.
+ * @param depth depth after push - 0 if commands were rejected.
+ */
+void CGPIOActuator::onPushed (GPIO_ACTUATOR_LANE& lane, const size_t count, const size_t depth)
+{
+    if (depth == 0)
+    {
+        add(lane.rejected, count);
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: GPIO actuator queue is full - " << count << " commands dropped." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return ;
+    }
+
+    add(lane.pushed, count);
+    if (depth > lane.max_depth.load(std::memory_order_relaxed))
+    {
+        lane.max_depth.store(depth, std::memory_order_relaxed);
+    }
+
+    // seq_cst head store & waiting load pair with loopActuator - either thread sees the other's store.
+    if (!m_waiting.load(std::memory_order_seq_cst)) return ;
+
+    {
+        // actuator thread is either before its pending check or waiting.
+        const std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_condition.notify_one();
+}
+
+
+void CGPIOActuator::loopActuator ()
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = GPIO_ACTUATOR_PRIORITY;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+    {
+        std::cout << _LOG_CONSOLE_BOLD_TEXT << "WARNING: actuator runs without real-time priority." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+
+    while (true)
+    {
+        // each task is followed by a check of higher lanes.
+        if (drainLane(GPIO_ACTUATOR_LANE_PRIORITY)) continue;
+        if (drainLane(GPIO_ACTUATOR_LANE_NORMAL)) continue;
+        if (drainLane(GPIO_ACTUATOR_LANE_BULK)) continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_exit_thread) break;
+        m_waiting.store(true, std::memory_order_seq_cst);
+        m_condition.wait(lock, [&](){ return m_exit_thread || isPending(); });
+        m_waiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+
+bool CGPIOActuator::isPending () const
+{
+    for (const GPIO_ACTUATOR_LANE& lane : m_lanes)
+    {
+        if (lane.ring.size() != 0) return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief execute commands of a lane up to and including its first task.
+ * Writes before the task are merged and applied before it, so order within the lane is kept.
+ *
+ * @return false if lane was empty.
+ */
+bool CGPIOActuator::drainLane (const uint lane)
+{
+    GPIO_ACTUATOR_LANE& actuator_lane = m_lanes[lane];
+
+    size_t available = actuator_lane.ring.size();
+    if (available == 0) return false;
+
+    for (; available > 0; --available)
+    {
+        GPIO_ACTUATOR_COMMAND& command = actuator_lane.ring.front();
+
+        if (command.type == GPIO_ACTUATOR_COMMAND_WRITE)
+        {
+            addWrite(actuator_lane, command);
+            actuator_lane.ring.pop();
+            continue;
+        }
+
+        flushWrites();
+
+        std::function<void()> task = std::move(command.task);
+        const GPIO_LATENCY_TRACE trace = command.trace;
+        command.task = nullptr;
+        actuator_lane.ring.pop();
+
+        CGPIOLatency& latency = CGPIOLatency::getInstance();
+        if (trace.active) latency.attach(trace);
+        task();
+        latency.end();
+
+        add(actuator_lane.executed, 1);
+
+        return true;
+    }
+
+    flushWrites();
+
+    return true;
+}
+
+
+/**
+ * @brief add write to batch. A pending write to the same pin is replaced.
+ * A write queued before a priority write to its pin is skipped.
+ */
+void CGPIOActuator::addWrite (GPIO_ACTUATOR_LANE& lane, GPIO_ACTUATOR_COMMAND& command)
+{
+    add(lane.executed, 1);
+
+    if (command.generation != getPinGeneration(command.write.pin_number))
+    {
+        add(lane.coalesced, 1);
+        return ;
+    }
+
+    if (command.trace.active && !m_batch_trace.active)
+    {
+        m_batch_trace = command.trace;
+    }
+
+    const uint pin_number = command.write.pin_number;
+    if ((pin_number < GPIO_ACTUATOR_PINS) && (m_batch_index[pin_number] >= 0))
+    {
+        m_batch[m_batch_index[pin_number]] = command.write;
+        add(lane.coalesced, 1);
+        return ;
+    }
+
+    if (pin_number < GPIO_ACTUATOR_PINS)
+    {
+        m_batch_index[pin_number] = static_cast<int>(m_batch.size());
+    }
+    m_batch.push_back(command.write);
+}
+
+
+void CGPIOActuator::flushWrites ()
+{
+    if (m_batch.empty()) return ;
+
+    CGPIOLatency& latency = CGPIOLatency::getInstance();
+    if (m_batch_trace.active) latency.attach(m_batch_trace);
+
+    applyWrites(m_batch.data(), m_batch.size());
+
+    latency.end();
+
+    for (const GPIO_WRITE_COMMAND& command : m_batch)
+    {
+        if (command.pin_number < GPIO_ACTUATOR_PINS) m_batch_index[command.pin_number] = -1;
+    }
+    m_batch.clear();
+    m_batch_trace = GPIO_LATENCY_TRACE();
+}
+
+
+/**
+ * @brief apply several pin writes.
+ * Digital outputs are collected into one set mask and one clear mask and written together.
+ * PWM pins are written after that with the last width of each pin. Pins that end the batch
+ * different from its start are passed to CGPIONotifier.
+ * Pins are read from a snapshot - the sequencer thread writes pin values under the driver lock.
+ */
+void CGPIOActuator::applyWrites (const GPIO_WRITE_COMMAND* commands, const size_t count)
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+
+    uint64_t pin_mask = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (commands[i].pin_number < MAX_GPIO_PINS) pin_mask |= 1ull << commands[i].pin_number;
+    }
+    GPIO_SNAPSHOT snapshot;
+    driver.getGPIOSnapshot(snapshot, pin_mask);
+
+    uint64_t set_mask = 0;
+    uint64_t clear_mask = 0;
+    uint64_t high_mask = 0;     // OUTPUT pins high at start of batch
+    uint64_t quiet_mask = 0;    // pins that are not reported
+    // a pin written twice in the batch keeps its last command.
+    std::array<const GPIO_WRITE_COMMAND*, MAX_GPIO_PINS> pwm_commands;
+    uint64_t pwm_mask = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GPIO_WRITE_COMMAND& command = commands[i];
+        if ((command.pin_number >= MAX_GPIO_PINS) || !(snapshot.used_mask & (1ull << command.pin_number))) continue;
+
+        const GPIO_STATE& state = snapshot.gpios[command.pin_number];
+        const uint64_t bit = 1ull << command.pin_number;
+
+        if (state.pin_mode == OUTPUT)
+        {
+            if (command.value)
+            {
+                set_mask |= bit;
+                clear_mask &= ~bit;
+            }
+            else
+            {
+                clear_mask |= bit;
+                set_mask &= ~bit;
+            }
+
+            if (state.pin_value == 1) high_mask |= bit;
+            if (isPowerLED(state)) quiet_mask |= bit;
+        }
+        else if ((state.pin_mode == PWM_OUTPUT) || (state.pin_mode == SOFT_PWM_OUTPUT))
+        {
+            if (!command.has_pwm_width) continue;
+
+            pwm_commands[command.pin_number] = &command;
+            pwm_mask |= bit;
+        }
+    }
+
+    // final levels against levels at start of batch - a pin written back to its level is unchanged.
+    uint64_t changed_mask = ((set_mask & ~high_mask) | (clear_mask & high_mask)) & ~quiet_mask;
+
+    CGPIOLatency::getInstance().markDispatch();
+
+    if (set_mask | clear_mask)
+    {
+        driver.writePinMasks(set_mask, clear_mask);
+    }
+
+    for (uint64_t pins = pwm_mask; pins; pins &= pins - 1)
+    {
+        const uint pin_number = __builtin_ctzll(pins);
+        const GPIO_WRITE_COMMAND* command = pwm_commands[pin_number];
+        if (snapshot.gpios[pin_number].pin_pwm_width != command->pwm_width)
+        {
+            changed_mask |= 1ull << pin_number;
+        }
+
+        driver.writePWM(pin_number, command->value, command->pwm_width);
+    }
+
+    CGPIONotifier::getInstance().markChanged(changed_mask);
+}
+
+
+/**
+ * @brief power led is written often and not reported.
+ */
+bool CGPIOActuator::isPowerLED (const GPIO_STATE& state)
+{
+    static const char name[] = "power_led";
+
+    return (state.name_length == sizeof(name) - 1) && (memcmp(state.pin_name, name, sizeof(name) - 1) == 0);
+}
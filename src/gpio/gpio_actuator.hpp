@@ -0,0 +1,264 @@
+#ifndef GPIO_ACTUATOR_H_
+#define GPIO_ACTUATOR_H_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <sys/types.h>
+
+#include "gpio_command_codec.hpp"
+#include "gpio_latency.hpp"
+
+
+// lanes - served in this order.
+#define GPIO_ACTUATOR_LANE_PRIORITY     0   // SYSTEM pins & failsafe commands
+#define GPIO_ACTUATOR_LANE_NORMAL       1   // writes, configs & patterns
+#define GPIO_ACTUATOR_LANE_BULK         2   // status queries
+#define GPIO_ACTUATOR_LANES             3
+
+#define GPIO_ACTUATOR_COMMAND_WRITE     0
+#define GPIO_ACTUATOR_COMMAND_TASK      1
+
+#define GPIO_ACTUATOR_DEFAULT_QUEUE 256 // commands per lane - rounded up to a power of two
+#define GPIO_ACTUATOR_PINS 64
+#define GPIO_ACTUATOR_PRIORITY 70 // SCHED_FIFO priority of actuator thread - below sequencer
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief a decoded command waiting in a lane.
+     * WRITE commands are merged per pin, TASK commands run as they are.
+     */
+    typedef struct GPIO_ACTUATOR_COMMAND{
+            uint type = GPIO_ACTUATOR_COMMAND_WRITE;
+            GPIO_WRITE_COMMAND write;
+            std::function<void()> task;
+            GPIO_LATENCY_TRACE trace;       // trace of receive thread - inactive if not traced
+            uint32_t generation = 0;        // of write pin when queued - skipped if a priority write followed
+        } GPIO_ACTUATOR_COMMAND;
+
+
+    typedef struct GPIO_ACTUATOR_STATS{
+            uint64_t depth = 0;             // commands waiting now
+            uint64_t max_depth = 0;
+            uint64_t pushed = 0;
+            uint64_t executed = 0;
+            uint64_t coalesced = 0;         // writes replaced by a later write to the same pin - priority writes included
+            uint64_t rejected = 0;          // commands dropped because lane was full
+        } GPIO_ACTUATOR_STATS;
+
+
+    /**
+     * @brief Single producer single consumer ring of commands.
+     * Producer publishes several commands with one store of head, so the consumer
+     * never sees part of a batch.
+     */
+    class CGPIOActuatorRing
+    {
+        public:
+
+            CGPIOActuatorRing()
+            {
+
+            }
+
+            CGPIOActuatorRing(CGPIOActuatorRing const&)     = delete;
+            void operator=(CGPIOActuatorRing const&)      = delete;
+
+        public:
+
+            void init (const size_t capacity);
+
+            inline size_t getCapacity () const
+            {
+                return m_capacity;
+            }
+
+            /**
+             * @brief seq_cst with the head store of push - orders against the waiting flag of the actuator.
+             */
+            inline size_t size () const
+            {
+                return m_head.load(std::memory_order_seq_cst) - m_tail.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief producer - fill(slot, i) is called for count free slots that are then published together.
+             * @return depth after push, or 0 if there is no room for count commands.
+             */
+            template <typename FILL>
+            inline size_t push (const size_t count, FILL fill)
+            {
+                const uint64_t head = m_head.load(std::memory_order_relaxed);
+                const uint64_t tail = m_tail.load(std::memory_order_acquire);
+                if ((count == 0) || (head + count - tail > m_capacity)) return 0;
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    fill(m_slots[(head + i) & m_mask], i);
+                }
+
+                m_head.store(head + count, std::memory_order_seq_cst);
+
+                return head + count - tail;
+            }
+
+            /**
+             * @brief consumer - oldest command. ring must not be empty.
+             */
+            inline GPIO_ACTUATOR_COMMAND& front ()
+            {
+                return m_slots[m_tail.load(std::memory_order_relaxed) & m_mask];
+            }
+
+            inline void pop ()
+            {
+                m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+        private:
+
+            std::unique_ptr<GPIO_ACTUATOR_COMMAND[]> m_slots;
+            size_t m_capacity = 0;
+            uint64_t m_mask = 0;
+
+            alignas(64) std::atomic<uint64_t> m_head {0};   // producer
+            alignas(64) std::atomic<uint64_t> m_tail {0};   // consumer
+    };
+
+
+    /**
+     * @brief Executes parsed commands on its own thread.
+     *
+     * The receive thread decodes a message and pushes commands into one of three lanes.
+     * The actuator thread serves PRIORITY before NORMAL before BULK, and checks higher lanes
+     * again after every task, so a status query never delays a SYSTEM pin write.
+     * All writes pending in a lane are merged - a later write to a pin replaces an earlier one -
+     * and written together through CGPIODriver::writePinMasks.
+     * A priority write also replaces writes to its pin still queued in lower lanes: each pin has
+     * a generation that priority writes advance, and a write of an older generation is skipped.
+     *
+     * Each lane has one producer: the thread that calls parseMessage.
+     * Commands run inline on the caller while the thread is not started.
+     */
+    class CGPIOActuator
+    {
+        public:
+
+            static CGPIOActuator& getInstance()
+            {
+                static CGPIOActuator instance;
+
+                return instance;
+            }
+
+            CGPIOActuator(CGPIOActuator const&)            = delete;
+            void operator=(CGPIOActuator const&)         = delete;
+
+
+        private:
+
+            CGPIOActuator()
+            {
+
+            }
+
+
+        public:
+
+            ~CGPIOActuator ()
+            {
+                uninit();
+            }
+
+        public:
+
+            bool start (const size_t queue_size);
+            void uninit ();
+
+            inline bool isRunning () const
+            {
+                return m_running.load(std::memory_order_acquire);
+            }
+
+            bool submitWrites (const uint lane, const GPIO_WRITE_COMMAND* commands, const size_t count);
+
+            /**
+             * @brief generation of a pin - a write queued at an older one is replaced by a priority write.
+             */
+            inline uint32_t getPinGeneration (const uint pin_number) const
+            {
+                return (pin_number < GPIO_ACTUATOR_PINS) ? m_pin_generation[pin_number].load(std::memory_order_acquire) : 0;
+            }
+            bool submitTask (const uint lane, std::function<void()> task);
+
+            GPIO_ACTUATOR_STATS getStats (const uint lane) const;
+            static const char* getLaneName (const uint lane);
+
+            /**
+             * @brief write pins now - from a task on actuator thread, after writes queued before it.
+             */
+            void applyWrites (const GPIO_WRITE_COMMAND* commands, const size_t count);
+
+        private:
+
+            /**
+             * @brief counters have a single writer - producer or consumer - and are read by reports.
+             */
+            typedef struct GPIO_ACTUATOR_LANE{
+                    CGPIOActuatorRing ring;
+                    std::atomic<uint64_t> pushed {0};
+                    std::atomic<uint64_t> rejected {0};
+                    std::atomic<uint64_t> max_depth {0};
+                    std::atomic<uint64_t> executed {0};
+                    std::atomic<uint64_t> coalesced {0};
+                } GPIO_ACTUATOR_LANE;
+
+            static inline void add (std::atomic<uint64_t>& counter, const uint64_t value)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+
+            void onPushed (GPIO_ACTUATOR_LANE& lane, const size_t count, const size_t depth);
+            void loopActuator ();
+            bool isPending () const;
+            bool drainLane (const uint lane);
+            void addWrite (GPIO_ACTUATOR_LANE& lane, GPIO_ACTUATOR_COMMAND& command);
+            void flushWrites ();
+            static bool isPowerLED (const GPIO_STATE& state);
+
+        private:
+
+            std::array<GPIO_ACTUATOR_LANE, GPIO_ACTUATOR_LANES> m_lanes;
+
+            // advanced by producer for each priority write to a pin.
+            std::array<std::atomic<uint32_t>, GPIO_ACTUATOR_PINS> m_pin_generation {};
+
+            // writes being merged - actuator thread only.
+            std::vector<GPIO_WRITE_COMMAND> m_batch;
+            std::array<int, GPIO_ACTUATOR_PINS> m_batch_index;
+            GPIO_LATENCY_TRACE m_batch_trace;       // oldest traced write of batch
+
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            std::atomic<bool> m_waiting {false};       // producers notify only a waiting thread
+            std::atomic<bool> m_running {false};
+            std::thread m_thread;
+            bool m_exit_thread = false;
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_backend.hpp"
+
+
+using namespace de::gpio;
+
+
+/**
+ * @brief map GPIO registers. wiringPi is set up too when linked as it does PWM & pulls.
+ */
+bool CGPIOBackendRegisters::open (const std::string& path, const bool register_file)
+{
+    #ifndef TEST_MODE_NO_WIRINGPI_LINK
+    if (wiringPiSetupGpio () == -1)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to setup WiringPi GPIO." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+    #endif
+
+    return m_registers.open(path, register_file);
+}
+
+
+void CGPIOBackendRegisters::setPinMode (const uint pin_number, const uint pin_mode)
+{
+    if ((pin_mode == INPUT) || (pin_mode == OUTPUT))
+    {
+        m_registers.setFunction(pin_number, (pin_mode == OUTPUT) ? GPIO_FSEL_OUTPUT : GPIO_FSEL_INPUT);
+        #ifndef TEST_MODE_NO_WIRINGPI_LINK
+        pullUpDnControl(pin_number, (pin_mode == OUTPUT) ? PUD_DOWN : PUD_UP);
+        #endif
+        return ;
+    }
+
+    #ifndef TEST_MODE_NO_WIRINGPI_LINK
+    pinMode (pin_number, pin_mode);
+    #else
+    std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: gpiomem backend cannot set mode " << pin_mode << " of pin " << pin_number << " without wiringPi." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    #endif
+}
+
+
+bool CGPIOBackendChardev::open (const std::string& chip_path)
+{
+    m_chip_path = chip_path;
+
+    // check chip now - lines are requested when first OUTPUT pin is configured.
+    const int chip_fd = ::open(chip_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (chip_fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open GPIO chip " << chip_path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+    ::close(chip_fd);
+
+    return true;
+}
+
+
+void CGPIOBackendChardev::close ()
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_line_fd >= 0) ::close(m_line_fd);
+    m_line_fd = -1;
+    m_output_mask = 0;
+}
+
+
+/**
+ * @brief OUTPUT pins are added to the output lines, others are released.
+ * INPUT lines are requested by the edge event engine.
+ */
+void CGPIOBackendChardev::setPinMode (const uint pin_number, const uint pin_mode)
+{
+    if (pin_number >= GPIO_BACKEND_PINS) return ;
+
+    if (pin_mode == PWM_OUTPUT)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: chardev backend has no hardware PWM on pin " << pin_number << " - use SOFT_PWM_OUTPUT." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    const uint64_t bit = 1ull << pin_number;
+    uint64_t output_mask = m_output_mask;
+    if (pin_mode == OUTPUT)
+    {
+        output_mask |= bit;
+        m_levels.fetch_and(~bit);   // new outputs start low like other backends
+    }
+    else
+    {
+        output_mask &= ~bit;
+    }
+
+    if (output_mask == m_output_mask) return ;
+
+    requestLines(output_mask);
+}
+
+
+/**
+ * @brief one ioctl changes all lines in both masks.
+ * bits of a line request are in order of requested lines.
+ */
+void CGPIOBackendChardev::writeMasks (const uint64_t set_mask, const uint64_t clear_mask)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    const uint64_t set_bits = set_mask & m_output_mask;
+    const uint64_t clear_bits = clear_mask & m_output_mask & ~set_bits;
+    if ((set_bits | clear_bits) == 0) return ;
+
+    m_levels.fetch_or(set_bits, std::memory_order_relaxed);
+    m_levels.fetch_and(~clear_bits, std::memory_order_relaxed);
+
+    struct gpio_v2_line_values values = {};
+    uint64_t changed = set_bits | clear_bits;
+    while (changed)
+    {
+        const uint pin = __builtin_ctzll(changed);
+        const uint64_t bit = 1ull << pin;
+        const uint64_t line = 1ull << __builtin_popcountll(m_output_mask & (bit - 1));
+        values.mask |= line;
+        if (set_bits & bit) values.bits |= line;
+        changed &= changed - 1;
+    }
+
+    ioctl(m_line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+}
+
+
+/**
+ * @brief replace line request by one with output_mask lines. must be called with m_mutex held.
+ */
+bool CGPIOBackendChardev::requestLines (const uint64_t output_mask)
+{
+    if (m_line_fd >= 0) ::close(m_line_fd);
+    m_line_fd = -1;
+    m_output_mask = 0;
+
+    if (output_mask == 0) return true;
+
+    const int chip_fd = ::open(m_chip_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (chip_fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open GPIO chip " << m_chip_path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    struct gpio_v2_line_request request = {};
+    const uint64_t levels = m_levels.load();
+    uint64_t initial_values = 0;
+    for (uint pin = 0; pin < GPIO_BACKEND_PINS; ++pin)
+    {
+        if (!(output_mask & (1ull << pin))) continue;
+        if (levels & (1ull << pin)) initial_values |= 1ull << request.num_lines;
+        request.offsets[request.num_lines++] = pin;
+    }
+
+    strncpy(request.consumer, "de_rpi_gpio", GPIO_MAX_NAME_SIZE - 1);
+    request.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+    request.config.num_attrs = 1;
+    request.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+    request.config.attrs[0].attr.values = initial_values;
+    request.config.attrs[0].mask = (request.num_lines == 64) ? ~0ull : ((1ull << request.num_lines) - 1);
+
+    const int res = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &request);
+    ::close(chip_fd);
+
+    if (res < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to request GPIO output lines: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    m_line_fd = request.fd;
+    m_output_mask = output_mask;
+
+    return true;
+}
+
+
+#ifndef TEST_MODE_NO_WIRINGPI_LINK
+bool CGPIOBackendWiringPi::open ()
+{
+    if (wiringPiSetupGpio () == -1)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to setup WiringPi GPIO." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+void CGPIOBackendWiringPi::setPinMode (const uint pin_number, const uint pin_mode)
+{
+    pinMode (pin_number, pin_mode);
+    if (pin_mode == OUTPUT)
+    {
+        pullUpDnControl(pin_number, PUD_DOWN);
+    }
+    else if (pin_mode == INPUT)
+    {
+        pullUpDnControl(pin_number, PUD_UP); // Enable pull-up resistor on button
+    }
+}
+#endif
@@ -0,0 +1,476 @@
+#ifndef GPIO_BACKEND_H_
+#define GPIO_BACKEND_H_
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <sys/types.h>
+
+#include "gpio_registers.hpp"
+
+#ifndef TEST_MODE_NO_WIRINGPI_LINK
+#include <wiringPi.h>
+#define GPIO_BACKEND_DEFAULT "wiringpi"
+#else
+#define GPIO_BACKEND_DEFAULT "simulation"
+#define INPUT 0
+#define OUTPUT 1
+#define PWM_OUTPUT 2
+#define SOFT_PWM_OUTPUT 4
+#define PWM_MODE_MS 0
+#define PWM_MODE_BAL 1
+#endif
+
+#define GPIO_BACKEND_PINS 54
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * Hardware backend policies.
+     *
+     * Each policy has the same inline interface. CGPIODriver keeps one policy in a std::variant
+     * and calls it through std::visit, so every call site is compiled once per policy with
+     * the calls inlined, and the policy itself is selected from config at startup.
+     *
+     * reads_inputs is false if INPUT pins cannot be read by the policy - levels are then
+     * read from the edge event lines.
+     */
+
+
+    /**
+     * @brief no hardware - pin modes, levels & PWM registers are kept in memory.
+     * Pull-ups of INPUT pins are applied, writes to non OUTPUT pins are ignored like on hardware.
+     */
+    class CGPIOBackendSimulation
+    {
+        public:
+
+            static constexpr bool reads_inputs = true;
+
+            static const char* getName ()
+            {
+                return "simulation";
+            }
+
+            CGPIOBackendSimulation()
+            {
+                m_modes.fill(INPUT);
+                m_pwm_values.fill(0);
+            }
+
+            CGPIOBackendSimulation(CGPIOBackendSimulation const&)      = delete;
+            void operator=(CGPIOBackendSimulation const&)           = delete;
+
+        public:
+
+            inline void close ()
+            {
+
+            }
+
+            inline void setPinMode (const uint pin_number, const uint pin_mode)
+            {
+                if (pin_number >= GPIO_BACKEND_PINS) return ;
+
+                m_modes[pin_number] = pin_mode;
+                const uint64_t bit = 1ull << pin_number;
+                if (pin_mode == OUTPUT) m_output_mask.fetch_or(bit);
+                else m_output_mask.fetch_and(~bit);
+
+                // INPUT pins are pulled up, OUTPUT pins pulled down.
+                if (pin_mode == INPUT) m_levels.fetch_or(bit);
+                else if (pin_mode == OUTPUT) m_levels.fetch_and(~bit);
+            }
+
+            inline int readPin (const uint pin_number) const
+            {
+                return (m_levels.load(std::memory_order_relaxed) >> pin_number) & 1;
+            }
+
+            inline uint64_t readLevels (const uint64_t pin_mask) const
+            {
+                return m_levels.load(std::memory_order_relaxed) & pin_mask;
+            }
+
+            inline void writePin (const uint pin_number, const uint pin_value)
+            {
+                const uint64_t bit = 1ull << pin_number;
+                writeMasks(pin_value ? bit : 0, pin_value ? 0 : bit);
+            }
+
+            inline void writeMasks (const uint64_t set_mask, const uint64_t clear_mask)
+            {
+                const uint64_t output_mask = m_output_mask.load(std::memory_order_relaxed);
+                if (set_mask & output_mask) m_levels.fetch_or(set_mask & output_mask, std::memory_order_relaxed);
+                if (clear_mask & output_mask) m_levels.fetch_and(~(clear_mask & output_mask), std::memory_order_relaxed);
+            }
+
+            inline void writePWM (const uint pin_number, const uint32_t pwm_value)
+            {
+                if (pin_number < GPIO_BACKEND_PINS) m_pwm_values[pin_number] = pwm_value;
+            }
+
+            inline void setPWMClock (const uint32_t mode, const uint32_t clock_divisor)
+            {
+                m_pwm_mode = mode;
+                m_pwm_clock_divisor = clock_divisor;
+            }
+
+            inline void setPWMRange (const uint32_t pwm_range)
+            {
+                m_pwm_range = pwm_range;
+            }
+
+        public:
+
+            /**
+             * @brief level of an INPUT pin changed - used with injected edge events.
+             */
+            inline void setInputLevel (const uint pin_number, const uint level)
+            {
+                if ((pin_number >= GPIO_BACKEND_PINS) || (m_modes[pin_number] != INPUT)) return ;
+
+                const uint64_t bit = 1ull << pin_number;
+                if (level) m_levels.fetch_or(bit);
+                else m_levels.fetch_and(~bit);
+            }
+
+            inline uint64_t getLevels () const
+            {
+                return m_levels.load();
+            }
+
+            inline uint getPinMode (const uint pin_number) const
+            {
+                return m_modes[pin_number % GPIO_BACKEND_PINS];
+            }
+
+            inline uint32_t getPWMValue (const uint pin_number) const
+            {
+                return m_pwm_values[pin_number % GPIO_BACKEND_PINS];
+            }
+
+            inline uint32_t getPWMMode () const
+            {
+                return m_pwm_mode;
+            }
+
+            inline uint32_t getPWMRange () const
+            {
+                return m_pwm_range;
+            }
+
+            inline uint32_t getPWMClockDivisor () const
+            {
+                return m_pwm_clock_divisor;
+            }
+
+        private:
+
+            std::array<uint, GPIO_BACKEND_PINS> m_modes;
+            // levels are written by soft PWM thread too.
+            std::atomic<uint64_t> m_levels {0};
+            std::atomic<uint64_t> m_output_mask {0};
+            std::array<uint32_t, GPIO_BACKEND_PINS> m_pwm_values;
+            uint32_t m_pwm_mode = PWM_MODE_BAL;
+            uint32_t m_pwm_clock_divisor = 0;
+            uint32_t m_pwm_range = 1024;
+    };
+
+
+    /**
+     * @brief digital pins through memory mapped GPIO registers (/dev/gpiomem).
+     * Hardware PWM and pulls are not in the gpiomem block - wiringPi does them if it is linked.
+     */
+    class CGPIOBackendRegisters
+    {
+        public:
+
+            static constexpr bool reads_inputs = true;
+
+            static const char* getName ()
+            {
+                return "gpiomem";
+            }
+
+            CGPIOBackendRegisters()
+            {
+
+            }
+
+            CGPIOBackendRegisters(CGPIOBackendRegisters const&)      = delete;
+            void operator=(CGPIOBackendRegisters const&)          = delete;
+
+        public:
+
+            bool open (const std::string& path, const bool register_file);
+
+            inline void close ()
+            {
+                m_registers.close();
+            }
+
+            void setPinMode (const uint pin_number, const uint pin_mode);
+
+            inline int readPin (const uint pin_number) const
+            {
+                return m_registers.readPin(pin_number);
+            }
+
+            /**
+             * @brief one GPLEV read per bank that has pins in pin_mask.
+             */
+            inline uint64_t readLevels (const uint64_t pin_mask) const
+            {
+                uint64_t levels = 0;
+                if (pin_mask & 0xFFFFFFFFull) levels |= m_registers.readLevels(0);
+                if (pin_mask >> GPIO_REG_BANK_PINS) levels |= static_cast<uint64_t>(m_registers.readLevels(1)) << GPIO_REG_BANK_PINS;
+                return levels & pin_mask;
+            }
+
+            inline void writePin (const uint pin_number, const uint pin_value)
+            {
+                m_registers.writePin(pin_number, pin_value);
+            }
+
+            inline void writeMasks (const uint64_t set_mask, const uint64_t clear_mask)
+            {
+                for (uint bank = 0; bank < 2; ++bank)
+                {
+                    const uint32_t set_bank = static_cast<uint32_t>(set_mask >> (bank * GPIO_REG_BANK_PINS));
+                    const uint32_t clear_bank = static_cast<uint32_t>(clear_mask >> (bank * GPIO_REG_BANK_PINS));
+                    if (set_bank) m_registers.setMask(bank, set_bank);
+                    if (clear_bank) m_registers.clearMask(bank, clear_bank);
+                }
+            }
+
+            inline void writePWM (const uint pin_number, const uint32_t pwm_value)
+            {
+                #ifndef TEST_MODE_NO_WIRINGPI_LINK
+                pwmWrite(pin_number, pwm_value);
+                #endif
+            }
+
+            inline void setPWMClock (const uint32_t mode, const uint32_t clock_divisor)
+            {
+                #ifndef TEST_MODE_NO_WIRINGPI_LINK
+                pwmSetMode(mode);
+                pwmSetClock(clock_divisor);
+                #endif
+            }
+
+            inline void setPWMRange (const uint32_t pwm_range)
+            {
+                #ifndef TEST_MODE_NO_WIRINGPI_LINK
+                pwmSetRange(pwm_range);
+                #endif
+            }
+
+        private:
+
+            CGPIORegisters m_registers;
+    };
+
+
+    /**
+     * @brief OUTPUT pins requested as lines of a GPIO character device (/dev/gpiochip0).
+     * Lines are requested again whenever the set of OUTPUT pins changes, current levels are kept.
+     * No hardware PWM - SOFT_PWM_OUTPUT pins work as they are OUTPUT lines.
+     */
+    class CGPIOBackendChardev
+    {
+        public:
+
+            static constexpr bool reads_inputs = false;
+
+            static const char* getName ()
+            {
+                return "chardev";
+            }
+
+            CGPIOBackendChardev()
+            {
+
+            }
+
+            CGPIOBackendChardev(CGPIOBackendChardev const&)      = delete;
+            void operator=(CGPIOBackendChardev const&)        = delete;
+
+            ~CGPIOBackendChardev ()
+            {
+                close();
+            }
+
+        public:
+
+            bool open (const std::string& chip_path);
+            void close ();
+
+            void setPinMode (const uint pin_number, const uint pin_mode);
+
+            /**
+             * @brief last level written to an OUTPUT line.
+             */
+            inline int readPin (const uint pin_number) const
+            {
+                return (m_levels.load(std::memory_order_relaxed) >> pin_number) & 1;
+            }
+
+            inline uint64_t readLevels (const uint64_t pin_mask) const
+            {
+                return m_levels.load(std::memory_order_relaxed) & pin_mask;
+            }
+
+            inline void writePin (const uint pin_number, const uint pin_value)
+            {
+                const uint64_t bit = 1ull << pin_number;
+                writeMasks(pin_value ? bit : 0, pin_value ? 0 : bit);
+            }
+
+            void writeMasks (const uint64_t set_mask, const uint64_t clear_mask);
+
+            inline void writePWM (const uint pin_number, const uint32_t pwm_value)
+            {
+
+            }
+
+            inline void setPWMClock (const uint32_t mode, const uint32_t clock_divisor)
+            {
+
+            }
+
+            inline void setPWMRange (const uint32_t pwm_range)
+            {
+
+            }
+
+        private:
+
+            bool requestLines (const uint64_t output_mask);
+
+        private:
+
+            std::string m_chip_path;
+            // lines are requested again while soft PWM thread may write.
+            std::mutex m_mutex;
+            int m_line_fd = -1;
+            uint64_t m_output_mask = 0;
+            std::atomic<uint64_t> m_levels {0};
+    };
+
+
+#ifndef TEST_MODE_NO_WIRINGPI_LINK
+    /**
+     * @brief all pins through wiringPi.
+     */
+    class CGPIOBackendWiringPi
+    {
+        public:
+
+            static constexpr bool reads_inputs = true;
+
+            static const char* getName ()
+            {
+                return "wiringpi";
+            }
+
+            CGPIOBackendWiringPi()
+            {
+
+            }
+
+            CGPIOBackendWiringPi(CGPIOBackendWiringPi const&)      = delete;
+            void operator=(CGPIOBackendWiringPi const&)         = delete;
+
+        public:
+
+            bool open ();
+
+            inline void close ()
+            {
+
+            }
+
+            void setPinMode (const uint pin_number, const uint pin_mode);
+
+            inline int readPin (const uint pin_number) const
+            {
+                return digitalRead (pin_number);
+            }
+
+            /**
+             * @brief wiringPi has no mask read - pins are read one after another.
+             */
+            inline uint64_t readLevels (uint64_t pin_mask) const
+            {
+                uint64_t levels = 0;
+                while (pin_mask)
+                {
+                    const uint pin_number = __builtin_ctzll(pin_mask);
+                    if (digitalRead (pin_number)) levels |= 1ull << pin_number;
+                    pin_mask &= pin_mask - 1;
+                }
+                return levels;
+            }
+
+            inline void writePin (const uint pin_number, const uint pin_value)
+            {
+                digitalWrite (pin_number, pin_value);
+            }
+
+            /**
+             * @brief wiringPi has no mask write - pins are changed one after another.
+             */
+            inline void writeMasks (uint64_t set_mask, uint64_t clear_mask)
+            {
+                while (set_mask)
+                {
+                    digitalWrite (__builtin_ctzll(set_mask), HIGH);
+                    set_mask &= set_mask - 1;
+                }
+                while (clear_mask)
+                {
+                    digitalWrite (__builtin_ctzll(clear_mask), LOW);
+                    clear_mask &= clear_mask - 1;
+                }
+            }
+
+            inline void writePWM (const uint pin_number, const uint32_t pwm_value)
+            {
+                pwmWrite(pin_number, pwm_value);
+            }
+
+            inline void setPWMClock (const uint32_t mode, const uint32_t clock_divisor)
+            {
+                pwmSetMode(mode);
+                pwmSetClock(clock_divisor);
+            }
+
+            inline void setPWMRange (const uint32_t pwm_range)
+            {
+                pwmSetRange(pwm_range);
+            }
+    };
+#endif
+
+
+    typedef std::variant<
+            CGPIOBackendSimulation,
+            CGPIOBackendRegisters,
+            CGPIOBackendChardev
+#ifndef TEST_MODE_NO_WIRINGPI_LINK
+            , CGPIOBackendWiringPi
+#endif
+        > GPIO_BACKEND;
+
+}
+}
+
+#endif
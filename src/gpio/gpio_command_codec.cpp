@@ -0,0 +1,211 @@
+#include <algorithm>
+
+#include "../de_common/de_databus/messages.hpp"
+
+#include "gpio_status_codec.hpp"
+#include "gpio_command_codec.hpp"
+
+
+using namespace de::gpio;
+
+
+#define GPIO_COMMAND_HEADER_SIZE    3
+
+
+bool CGPIOCommandCodec::decodeHeader (const uint8_t* buffer, const size_t length, uint& action, uint& count)
+{
+    if ((length < GPIO_COMMAND_HEADER_SIZE) || (buffer[0] != GPIO_COMMAND_BINARY_VERSION)) return false;
+
+    action = buffer[1];
+    count = buffer[2];
+
+    return true;
+}
+
+
+/**
+ * @brief decode GPIO_ACTION_PORT_WRITE records.
+ *
+ * @param commands filled with up to max_count records.
+ * @return false if payload is truncated or not a write command.
+ */
+bool CGPIOCommandCodec::decodeWrite (const uint8_t* buffer, const size_t length, GPIO_WRITE_COMMAND* commands, const size_t max_count, size_t& count)
+{
+    count = 0;
+
+    uint action;
+    uint record_count;
+    if (!decodeHeader(buffer, length, action, record_count)) return false;
+    if (action != GPIO_ACTION_PORT_WRITE) return false;
+
+    size_t offset = GPIO_COMMAND_HEADER_SIZE;
+    for (uint i = 0; i < record_count; ++i)
+    {
+        if ((offset >= length) || (count >= max_count)) return false;
+
+        const uint8_t pin = buffer[offset++];
+        GPIO_WRITE_COMMAND& command = commands[count];
+        command.pin_number = pin & GPIO_COMMAND_PIN_MASK;
+        command.has_pwm_width = (pin & GPIO_COMMAND_FLAG_WIDTH) != 0;
+        command.pwm_width = 0;
+
+        uint32_t value;
+        if (!CGPIOStatusCodec::getVarint(buffer, length, offset, value)) return false;
+        command.value = value;
+
+        if (command.has_pwm_width)
+        {
+            if (!CGPIOStatusCodec::getVarint(buffer, length, offset, value)) return false;
+            command.pwm_width = value;
+        }
+
+        ++count;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief decode GPIO_ACTION_PORT_CONFIG records.
+ *
+ * @return false if payload is truncated or not a config command.
+ */
+bool CGPIOCommandCodec::decodeConfig (const uint8_t* buffer, const size_t length, std::vector<GPIO>& gpios)
+{
+    gpios.clear();
+
+    uint action;
+    uint record_count;
+    if (!decodeHeader(buffer, length, action, record_count)) return false;
+    if (action != GPIO_ACTION_PORT_CONFIG) return false;
+
+    size_t offset = GPIO_COMMAND_HEADER_SIZE;
+    for (uint i = 0; i < record_count; ++i)
+    {
+        if (offset + 2 > length) return false;
+
+        GPIO gpio;
+        gpio.pin_number = buffer[offset++];
+        const uint8_t mode = buffer[offset++];
+        gpio.pin_mode = mode & GPIO_COMMAND_MODE_MASK;
+        gpio.pin_value = 0;
+        gpio.pin_pwm_width = 0;
+        gpio.gpio_type = ENUM_GPIO_TYPE::GENERIC;
+
+        if (mode & GPIO_COMMAND_FLAG_VALUE)
+        {
+            uint32_t value;
+            if (!CGPIOStatusCodec::getVarint(buffer, length, offset, value)) return false;
+            gpio.pin_value = value;
+        }
+
+        if (mode & GPIO_COMMAND_FLAG_NAME)
+        {
+            if (offset >= length) return false;
+            const size_t name_length = buffer[offset++];
+            if (offset + name_length > length) return false;
+            // names end up in JSON status - invalid UTF-8 would make serializing it throw.
+            if (!isUTF8(buffer + offset, name_length)) return false;
+            gpio.pin_name.assign(reinterpret_cast<const char*>(buffer + offset), name_length);
+            offset += name_length;
+        }
+
+        gpios.push_back(gpio);
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief true if chars are well formed UTF-8 - no overlong forms, surrogates or code points above U+10FFFF.
+ */
+bool CGPIOCommandCodec::isUTF8 (const uint8_t* chars, const size_t length)
+{
+    size_t i = 0;
+    while (i < length)
+    {
+        const uint8_t lead = chars[i];
+        if (lead < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        size_t count;
+        uint8_t min = 0x80;
+        uint8_t max = 0xBF;
+        if ((lead >= 0xC2) && (lead <= 0xDF)) count = 1;
+        else if ((lead >= 0xE0) && (lead <= 0xEF))
+        {
+            count = 2;
+            if (lead == 0xE0) min = 0xA0;   // overlong
+            if (lead == 0xED) max = 0x9F;   // surrogates
+        }
+        else if ((lead >= 0xF0) && (lead <= 0xF4))
+        {
+            count = 3;
+            if (lead == 0xF0) min = 0x90;   // overlong
+            if (lead == 0xF4) max = 0x8F;   // above U+10FFFF
+        }
+        else return false;
+
+        if (i + count >= length) return false;  // truncated sequence
+
+        for (size_t c = 1; c <= count; ++c)
+        {
+            const uint8_t next = chars[i + c];
+            if ((c == 1) ? ((next < min) || (next > max)) : ((next < 0x80) || (next > 0xBF))) return false;
+        }
+
+        i += count + 1;
+    }
+
+    return true;
+}
+
+
+void CGPIOCommandCodec::encodeWrite (const GPIO_WRITE_COMMAND* commands, const size_t count, std::vector<uint8_t>& buffer)
+{
+    buffer.clear();
+    buffer.push_back(GPIO_COMMAND_BINARY_VERSION);
+    buffer.push_back(GPIO_ACTION_PORT_WRITE);
+    buffer.push_back(static_cast<uint8_t>(std::min<size_t>(count, 255)));
+
+    for (size_t i = 0; (i < count) && (i < 255); ++i)
+    {
+        const GPIO_WRITE_COMMAND& command = commands[i];
+        buffer.push_back((command.pin_number & GPIO_COMMAND_PIN_MASK) | (command.has_pwm_width ? GPIO_COMMAND_FLAG_WIDTH : 0));
+        CGPIOStatusCodec::putVarint(buffer, command.value);
+        if (command.has_pwm_width) CGPIOStatusCodec::putVarint(buffer, command.pwm_width);
+    }
+}
+
+
+void CGPIOCommandCodec::encodeConfig (const GPIO* gpios, const size_t count, std::vector<uint8_t>& buffer)
+{
+    buffer.clear();
+    buffer.push_back(GPIO_COMMAND_BINARY_VERSION);
+    buffer.push_back(GPIO_ACTION_PORT_CONFIG);
+    buffer.push_back(static_cast<uint8_t>(std::min<size_t>(count, 255)));
+
+    for (size_t i = 0; (i < count) && (i < 255); ++i)
+    {
+        const GPIO& gpio = gpios[i];
+        buffer.push_back(static_cast<uint8_t>(gpio.pin_number));
+
+        uint8_t mode = (gpio.pin_mode & GPIO_COMMAND_MODE_MASK) | GPIO_COMMAND_FLAG_VALUE;
+        if (!gpio.pin_name.empty()) mode |= GPIO_COMMAND_FLAG_NAME;
+        buffer.push_back(mode);
+
+        CGPIOStatusCodec::putVarint(buffer, gpio.pin_value);
+
+        if (mode & GPIO_COMMAND_FLAG_NAME)
+        {
+            const size_t name_length = std::min<size_t>(gpio.pin_name.size(), 255);
+            buffer.push_back(static_cast<uint8_t>(name_length));
+            buffer.insert(buffer.end(), gpio.pin_name.begin(), gpio.pin_name.begin() + name_length);
+        }
+    }
+}
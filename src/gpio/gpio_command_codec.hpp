@@ -0,0 +1,76 @@
+#ifndef GPIO_COMMAND_CODEC_H_
+#define GPIO_COMMAND_CODEC_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "gpio_driver.hpp"
+
+
+#define GPIO_COMMAND_BINARY_VERSION     1
+
+// write record: pin byte flags
+#define GPIO_COMMAND_FLAG_WIDTH         0x80    // pwm width follows value
+#define GPIO_COMMAND_PIN_MASK           0x3f
+
+// config record: mode byte flags
+#define GPIO_COMMAND_FLAG_VALUE         0x40    // value follows
+#define GPIO_COMMAND_FLAG_NAME          0x80    // name follows
+#define GPIO_COMMAND_MODE_MASK          0x0f
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief a decoded GPIO_ACTION_PORT_WRITE entry.
+     */
+    typedef struct GPIO_WRITE_COMMAND{
+            uint pin_number;
+            uint value;
+            uint pwm_width;
+            bool has_pwm_width;
+        } GPIO_WRITE_COMMAND;
+
+
+    /**
+     * @brief Compact binary GPIO_ACTION commands.
+     *
+     * Binary payload of a TYPE_AndruavMessage_GPIO_ACTION message:
+     *
+     *      uint8   version
+     *      uint8   action          GPIO_ACTION_PORT_WRITE or GPIO_ACTION_PORT_CONFIG
+     *      uint8   count
+     *      GPIO_ACTION_PORT_WRITE records:
+     *          uint8   pin(bits 0-5) | GPIO_COMMAND_FLAG_WIDTH
+     *          varint  value
+     *          varint  pwm width       if GPIO_COMMAND_FLAG_WIDTH
+     *      GPIO_ACTION_PORT_CONFIG records:
+     *          uint8   pin
+     *          uint8   mode(bits 0-3) | GPIO_COMMAND_FLAG_VALUE | GPIO_COMMAND_FLAG_NAME
+     *          varint  value           if GPIO_COMMAND_FLAG_VALUE
+     *          uint8 length + chars    if GPIO_COMMAND_FLAG_NAME - UTF-8, else whole config is rejected
+     *
+     * Module key, when needed, is in the JSON header as 'i'.
+     * Decoding reads the raw buffer directly - no JSON is built.
+     */
+    class CGPIOCommandCodec
+    {
+        public:
+
+            static bool decodeHeader (const uint8_t* buffer, const size_t length, uint& action, uint& count);
+            static bool decodeWrite (const uint8_t* buffer, const size_t length, GPIO_WRITE_COMMAND* commands, const size_t max_count, size_t& count);
+            static bool decodeConfig (const uint8_t* buffer, const size_t length, std::vector<GPIO>& gpios);
+
+            static void encodeWrite (const GPIO_WRITE_COMMAND* commands, const size_t count, std::vector<uint8_t>& buffer);
+            static void encodeConfig (const GPIO* gpios, const size_t count, std::vector<uint8_t>& buffer);
+
+            static bool isUTF8 (const uint8_t* chars, const size_t length);
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,574 @@
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_registers.hpp"
+#include "gpio_dma.hpp"
+
+
+using namespace de::gpio;
+
+
+#define GPIO_DMA_CHAIN_SIZE         0x10000     // bytes per chain - control blocks then data
+#define GPIO_DMA_CHAIN_MAX_CBS      (GPIO_DMA_MAX_PULSES * 3)
+#define GPIO_DMA_CHAIN_DATA_OFFSET  (GPIO_DMA_CHAIN_MAX_CBS * sizeof(DMA_CONTROL_BLOCK))
+#define GPIO_DMA_CHAIN_MAX_DATA     ((GPIO_DMA_CHAIN_SIZE - GPIO_DMA_CHAIN_DATA_OFFSET) / sizeof(uint32_t))
+#define GPIO_DMA_MEMORY_SIZE        (GPIO_DMA_CHAIN_SIZE * 2)
+
+// register word offsets.
+#define GPIO_DMA_REG_CS             0
+#define GPIO_DMA_REG_CONBLK_AD      1
+#define GPIO_DMA_REG_DEBUG          8
+#define GPIO_DMA_CHANNEL_WORDS      (0x100 / 4)
+
+#define GPIO_PWM_REG_CTL            0
+#define GPIO_PWM_REG_DMAC           2
+#define GPIO_PWM_REG_RNG1           4
+#define GPIO_PWM_REG_FIF1           6
+
+#define GPIO_CLK_REG_PWMCTL         40
+#define GPIO_CLK_REG_PWMDIV         41
+#define GPIO_CLK_PASSWD             0x5A000000
+#define GPIO_CLK_SRC_PLLD           6
+
+// bus addresses of DMA write targets.
+#define GPIO_DMA_GPIO_BUS           (GPIO_DMA_PERI_BUS_BASE + GPIO_DMA_GPIO_OFFSET)
+#define GPIO_DMA_PWM_FIFO_BUS       (GPIO_DMA_PERI_BUS_BASE + GPIO_DMA_PWM_OFFSET + GPIO_PWM_REG_FIF1 * 4)
+
+// simulation memory is given bus addresses in the uncached alias like mailbox memory.
+#define GPIO_DMA_SIM_MEMORY_BUS     0xC0000000
+
+// VideoCore mailbox.
+#define GPIO_MBOX_IOCTL             _IOWR(100, 0, char *)
+#define GPIO_MBOX_MEM_FLAG_DIRECT   (1 << 2)
+
+
+static uint32_t getPeripheralBase ()
+{
+    uint32_t base = 0x3F000000;
+
+    FILE* fp = fopen("/proc/device-tree/soc/ranges", "rb");
+    if (fp == nullptr) return base;
+
+    uint8_t buf[12];
+    const size_t n = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+
+    if (n >= 8)
+    {
+        base = (buf[4] << 24) | (buf[5] << 16) | (buf[6] << 8) | buf[7];
+        if ((base == 0) && (n >= 12))
+        {   // BCM2711 uses 64-bit child addresses.
+            base = (buf[8] << 24) | (buf[9] << 16) | (buf[10] << 8) | buf[11];
+        }
+    }
+
+    return base;
+}
+
+
+static bool mailboxProperty (const int fd, uint32_t* buffer)
+{
+    return ioctl(fd, GPIO_MBOX_IOCTL, buffer) >= 0;
+}
+
+
+static inline bool isBCM2711 ()
+{
+    return getPeripheralBase() == 0xFE000000;
+}
+
+
+/**
+ * @brief channel used if none is configured - pigpio default of the SoC.
+ */
+uint CGPIODMA::getDefaultChannel ()
+{
+    return isBCM2711() ? GPIO_DMA_DEFAULT_CHANNEL_BCM2711 : GPIO_DMA_DEFAULT_CHANNEL_BCM283X;
+}
+
+
+/**
+ * @brief map DMA & PWM hardware and allocate control block memory.
+ *
+ * @param dma_channel 0-14, not a DMA4 channel of BCM2711. should not be used by the kernel - see getDefaultChannel().
+ * @param sample_us waveform time resolution.
+ */
+bool CGPIODMA::open (const uint dma_channel, const uint sample_us)
+{
+    close();
+
+    if ((dma_channel > GPIO_DMA_MAX_CHANNEL) || (sample_us == 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Invalid DMA channel " << dma_channel << " or sample time " << sample_us << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    if (isBCM2711() && (dma_channel >= GPIO_DMA_BCM2711_DMA4_CHANNEL))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: DMA channel " << dma_channel << " is a DMA4 channel on BCM2711 - use " << GPIO_DMA_DEFAULT_CHANNEL_BCM2711 << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    m_dma_channel = dma_channel;
+    m_sample_us = sample_us;
+    m_simulation = false;
+
+    if (!mapPeripherals() || !allocateMemory())
+    {
+        close();
+        return false;
+    }
+
+    setupPacing();
+
+    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "DMA waveforms on channel: " << _INFO_CONSOLE_BOLD_TEXT << m_dma_channel
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", sample(us): " << _INFO_CONSOLE_BOLD_TEXT << m_sample_us << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    return true;
+}
+
+
+/**
+ * @brief use plain memory instead of hardware. Waveforms run only through simulate().
+ */
+bool CGPIODMA::openSimulation (const uint sample_us)
+{
+    close();
+
+    if (sample_us == 0) return false;
+
+    m_memory = static_cast<uint8_t*>(aligned_alloc(4096, GPIO_DMA_MEMORY_SIZE));
+    if (m_memory == nullptr) return false;
+    memset(m_memory, 0, GPIO_DMA_MEMORY_SIZE);
+
+    m_memory_bus = GPIO_DMA_SIM_MEMORY_BUS;
+    m_memory_size = GPIO_DMA_MEMORY_SIZE;
+    m_sample_us = sample_us;
+    m_simulation = true;
+    m_sim_levels = 0;
+    m_sim_cb = 0;
+    m_sim_delay_us = 0;
+    m_sim_time_us = 0;
+
+    for (uint i = 0; i < 2; ++i)
+    {
+        m_chains[i].control_blocks = reinterpret_cast<DMA_CONTROL_BLOCK*>(m_memory + i * GPIO_DMA_CHAIN_SIZE);
+        m_chains[i].data = reinterpret_cast<uint32_t*>(m_memory + i * GPIO_DMA_CHAIN_SIZE + GPIO_DMA_CHAIN_DATA_OFFSET);
+        m_chains[i].cb_bus = m_memory_bus + i * GPIO_DMA_CHAIN_SIZE;
+        m_chains[i].data_bus = m_chains[i].cb_bus + GPIO_DMA_CHAIN_DATA_OFFSET;
+        m_chains[i].count = 0;
+    }
+
+    return true;
+}
+
+
+void CGPIODMA::close ()
+{
+    stop();
+
+    if (m_simulation)
+    {
+        free(m_memory);
+    }
+    else if (m_memory != nullptr)
+    {
+        munmap(m_memory, m_memory_size);
+    }
+    m_memory = nullptr;
+
+    if (m_mailbox_fd >= 0)
+    {
+        if (m_mailbox_handle != 0)
+        {
+            uint32_t unlock[] = {7 * 4, 0, 0x3000e, 4, 4, m_mailbox_handle, 0};
+            mailboxProperty(m_mailbox_fd, unlock);
+            uint32_t release[] = {7 * 4, 0, 0x3000f, 4, 4, m_mailbox_handle, 0};
+            mailboxProperty(m_mailbox_fd, release);
+            m_mailbox_handle = 0;
+        }
+        ::close(m_mailbox_fd);
+        m_mailbox_fd = -1;
+    }
+
+    if (m_dma_regs != nullptr) { munmap(const_cast<uint32_t*>(m_dma_regs), 4096); m_dma_regs = nullptr; }
+    if (m_pwm_regs != nullptr) { munmap(const_cast<uint32_t*>(m_pwm_regs), 4096); m_pwm_regs = nullptr; }
+    if (m_clk_regs != nullptr) { munmap(const_cast<uint32_t*>(m_clk_regs), 4096); m_clk_regs = nullptr; }
+
+    if (m_mem_fd >= 0)
+    {
+        ::close(m_mem_fd);
+        m_mem_fd = -1;
+    }
+
+    m_running_chain = -1;
+    m_simulation = false;
+}
+
+
+/**
+ * @brief play waveform repeatedly. replaces running waveform at the end of its cycle.
+ *
+ * @param release_mask pins written low once when the waveform starts.
+ * @return false if waveform is empty, has no delay or does not fit.
+ */
+bool CGPIODMA::play (const WAVEFORM_PULSE* pulses, const size_t count, const uint64_t release_mask)
+{
+    if (!isOpen() || (count == 0) || (count > GPIO_DMA_MAX_PULSES)) return false;
+
+    const int idle = (m_running_chain == 0) ? 1 : 0;
+    DMA_CHAIN& chain = m_chains[idle];
+
+    // a previous play may have linked to this chain while DMA was still in it.
+    if ((m_running_chain >= 0) && !waitChainIdle(chain)) return false;
+
+    chain.count = buildChain(pulses, count, release_mask,
+                             chain.control_blocks, chain.cb_bus, GPIO_DMA_CHAIN_MAX_CBS,
+                             chain.data, chain.data_bus, GPIO_DMA_CHAIN_MAX_DATA,
+                             GPIO_DMA_GPIO_BUS, GPIO_DMA_PWM_FIFO_BUS);
+    if (chain.count == 0) return false;
+
+    __sync_synchronize();
+
+    if (m_running_chain < 0)
+    {
+        startDMA(chain.cb_bus);
+    }
+    else
+    {
+        DMA_CHAIN& running = m_chains[m_running_chain];
+        running.control_blocks[running.count - 1].nextconbk = chain.cb_bus;
+        __sync_synchronize();
+    }
+
+    m_running_chain = idle;
+
+    return true;
+}
+
+
+/**
+ * @brief stop DMA. pins keep their current level.
+ */
+void CGPIODMA::stop ()
+{
+    if (m_dma_regs != nullptr)
+    {
+        volatile uint32_t* dma = m_dma_regs + m_dma_channel * GPIO_DMA_CHANNEL_WORDS;
+        dma[GPIO_DMA_REG_CS] = 1u << 31; // reset
+        usleep(10);
+    }
+
+    m_sim_cb = 0;
+    m_sim_delay_us = 0;
+    m_running_chain = -1;
+}
+
+
+/**
+ * @brief execute control blocks for duration_us of waveform time.
+ * only available after openSimulation().
+ *
+ * @param transitions receives pin levels each time they change.
+ */
+void CGPIODMA::simulate (const uint64_t duration_us, std::vector<WAVEFORM_TRANSITION>& transitions)
+{
+    if (!m_simulation) return ;
+
+    const uint64_t end_us = m_sim_time_us + duration_us;
+
+    while ((m_sim_cb != 0) && (m_sim_time_us < end_us))
+    {
+        const DMA_CONTROL_BLOCK* cb = reinterpret_cast<const DMA_CONTROL_BLOCK*>(toVirtual(m_sim_cb));
+        const uint64_t levels = m_sim_levels;
+
+        if ((cb->dest_ad == GPIO_DMA_GPIO_BUS + GPIO_REG_GPSET0 * 4) || (cb->dest_ad == GPIO_DMA_GPIO_BUS + GPIO_REG_GPCLR0 * 4))
+        {
+            const uint32_t* src = toVirtual(cb->source_ad);
+            const uint64_t mask = src[0] | (static_cast<uint64_t>(src[1]) << 32);
+            if (cb->dest_ad == GPIO_DMA_GPIO_BUS + GPIO_REG_GPSET0 * 4)
+            {
+                m_sim_levels |= mask;
+            }
+            else
+            {
+                m_sim_levels &= ~mask;
+            }
+        }
+        else if (cb->dest_ad == GPIO_DMA_PWM_FIFO_BUS)
+        {
+            // DMA stays in a delay block until its samples are written, only then it reads nextconbk.
+            const uint64_t delay_us = (cb->txfr_len / 4) * m_sample_us - m_sim_delay_us;
+            if (m_sim_time_us + delay_us > end_us)
+            {
+                m_sim_delay_us += end_us - m_sim_time_us;
+                m_sim_time_us = end_us;
+                break;
+            }
+
+            m_sim_time_us += delay_us;
+            m_sim_delay_us = 0;
+        }
+
+        if (m_sim_levels != levels)
+        {
+            if (!transitions.empty() && (transitions.back().time_us == m_sim_time_us))
+            {
+                transitions.back().levels = m_sim_levels;
+            }
+            else
+            {
+                transitions.push_back({m_sim_time_us, m_sim_levels});
+            }
+        }
+
+        m_sim_cb = cb->nextconbk;
+    }
+}
+
+
+size_t CGPIODMA::buildChain (const WAVEFORM_PULSE* pulses, const size_t count, const uint64_t release_mask,
+                             DMA_CONTROL_BLOCK* control_blocks, const uint32_t cb_bus, const size_t max_control_blocks,
+                             uint32_t* data, const uint32_t data_bus, const size_t max_data_words,
+                             const uint32_t gpio_bus, const uint32_t pwm_fifo_bus)
+{
+    size_t cb_count = 0;
+    size_t data_count = 0;
+    uint64_t total_samples = 0;
+
+    // source of pacing writes - value is not used.
+    if (max_data_words == 0) return 0;
+    data[data_count++] = 0;
+
+    const auto add_mask = [&](const uint64_t mask, const uint32_t reg)
+    {
+        if ((cb_count >= max_control_blocks) || (data_count + 2 > max_data_words)) return false;
+
+        data[data_count] = static_cast<uint32_t>(mask);
+        data[data_count + 1] = static_cast<uint32_t>(mask >> 32);
+
+        DMA_CONTROL_BLOCK& cb = control_blocks[cb_count++];
+        memset(&cb, 0, sizeof(cb));
+        cb.ti = GPIO_DMA_TI_NO_WIDE_BURSTS | GPIO_DMA_TI_WAIT_RESP | GPIO_DMA_TI_SRC_INC | GPIO_DMA_TI_DEST_INC;
+        cb.source_ad = data_bus + data_count * 4;
+        cb.dest_ad = gpio_bus + reg * 4;
+        cb.txfr_len = 8; // both banks
+
+        data_count += 2;
+        return true;
+    };
+
+    // released pins are cleared before the first cycle only.
+    if (release_mask && !add_mask(release_mask, GPIO_REG_GPCLR0)) return 0;
+    const size_t loop_start = cb_count;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const WAVEFORM_PULSE& pulse = pulses[i];
+
+        if (pulse.set_mask && !add_mask(pulse.set_mask, GPIO_REG_GPSET0)) return 0;
+        if (pulse.clear_mask && !add_mask(pulse.clear_mask, GPIO_REG_GPCLR0)) return 0;
+
+        // long delays take several control blocks.
+        for (uint32_t remaining = pulse.delay_samples; remaining > 0; )
+        {
+            if (cb_count >= max_control_blocks) return 0;
+
+            const uint32_t samples = std::min<uint32_t>(remaining, GPIO_DMA_MAX_DELAY_SAMPLES);
+
+            DMA_CONTROL_BLOCK& cb = control_blocks[cb_count++];
+            memset(&cb, 0, sizeof(cb));
+            cb.ti = GPIO_DMA_TI_NO_WIDE_BURSTS | GPIO_DMA_TI_WAIT_RESP | GPIO_DMA_TI_DEST_DREQ | GPIO_DMA_TI_PERMAP(GPIO_DMA_DREQ_PWM);
+            cb.source_ad = data_bus;
+            cb.dest_ad = pwm_fifo_bus;
+            cb.txfr_len = samples * 4;
+
+            remaining -= samples;
+            total_samples += samples;
+        }
+    }
+
+    // a cycle without delay would spin the DMA engine.
+    if ((cb_count == loop_start) || (total_samples == 0)) return 0;
+
+    for (size_t i = 0; i < cb_count; ++i)
+    {
+        const size_t next = (i + 1 < cb_count) ? (i + 1) : loop_start;
+        control_blocks[i].nextconbk = cb_bus + next * sizeof(DMA_CONTROL_BLOCK);
+    }
+
+    return cb_count;
+}
+
+
+bool CGPIODMA::mapPeripherals ()
+{
+    m_mem_fd = ::open("/dev/mem", O_RDWR | O_SYNC | O_CLOEXEC);
+    if (m_mem_fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open /dev/mem for DMA: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    const uint32_t base = getPeripheralBase();
+
+    const auto map_block = [&](const uint32_t offset) -> volatile uint32_t*
+    {
+        void* map = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, m_mem_fd, base + offset);
+        if (map == MAP_FAILED) return nullptr;
+        return static_cast<volatile uint32_t*>(map);
+    };
+
+    m_dma_regs = map_block(GPIO_DMA_DMA_OFFSET);
+    m_pwm_regs = map_block(GPIO_DMA_PWM_OFFSET);
+    m_clk_regs = map_block(GPIO_DMA_CLK_OFFSET);
+
+    if ((m_dma_regs == nullptr) || (m_pwm_regs == nullptr) || (m_clk_regs == nullptr))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to map DMA/PWM registers: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief uncached memory from VideoCore - DMA reads control blocks from it directly.
+ */
+bool CGPIODMA::allocateMemory ()
+{
+    m_mailbox_fd = ::open("/dev/vcio", O_RDWR | O_CLOEXEC);
+    if (m_mailbox_fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open /dev/vcio: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    uint32_t allocate[] = {9 * 4, 0, 0x3000c, 12, 12, GPIO_DMA_MEMORY_SIZE, 4096, GPIO_MBOX_MEM_FLAG_DIRECT, 0};
+    if (!mailboxProperty(m_mailbox_fd, allocate) || (allocate[5] == 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to allocate DMA memory." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+    m_mailbox_handle = allocate[5];
+
+    uint32_t lock[] = {7 * 4, 0, 0x3000d, 4, 4, m_mailbox_handle, 0};
+    if (!mailboxProperty(m_mailbox_fd, lock) || (lock[5] == 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to lock DMA memory." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+    m_memory_bus = lock[5];
+
+    void* map = mmap(nullptr, GPIO_DMA_MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_mem_fd, m_memory_bus & ~0xC0000000);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to map DMA memory: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    m_memory = static_cast<uint8_t*>(map);
+    m_memory_size = GPIO_DMA_MEMORY_SIZE;
+    memset(m_memory, 0, m_memory_size);
+
+    for (uint i = 0; i < 2; ++i)
+    {
+        m_chains[i].control_blocks = reinterpret_cast<DMA_CONTROL_BLOCK*>(m_memory + i * GPIO_DMA_CHAIN_SIZE);
+        m_chains[i].data = reinterpret_cast<uint32_t*>(m_memory + i * GPIO_DMA_CHAIN_SIZE + GPIO_DMA_CHAIN_DATA_OFFSET);
+        m_chains[i].cb_bus = m_memory_bus + i * GPIO_DMA_CHAIN_SIZE;
+        m_chains[i].data_bus = m_chains[i].cb_bus + GPIO_DMA_CHAIN_DATA_OFFSET;
+        m_chains[i].count = 0;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief PWM FIFO takes one word per sample - it paces the delay control blocks.
+ * PWM clock is set to 10 MHz from PLLD, range to 10 clocks per microsecond.
+ */
+void CGPIODMA::setupPacing ()
+{
+    // PLLD is 750 MHz on BCM2711, 500 MHz before.
+    const uint32_t divisor = isBCM2711() ? 75 : 50;
+
+    m_pwm_regs[GPIO_PWM_REG_CTL] = 0;
+    usleep(10);
+
+    m_clk_regs[GPIO_CLK_REG_PWMCTL] = GPIO_CLK_PASSWD | (1u << 5); // kill
+    while (m_clk_regs[GPIO_CLK_REG_PWMCTL] & (1u << 7)) // busy
+    {
+        usleep(10);
+    }
+
+    m_clk_regs[GPIO_CLK_REG_PWMDIV] = GPIO_CLK_PASSWD | (divisor << 12);
+    m_clk_regs[GPIO_CLK_REG_PWMCTL] = GPIO_CLK_PASSWD | GPIO_CLK_SRC_PLLD;
+    m_clk_regs[GPIO_CLK_REG_PWMCTL] = GPIO_CLK_PASSWD | GPIO_CLK_SRC_PLLD | (1u << 4); // enable
+    usleep(100);
+
+    m_pwm_regs[GPIO_PWM_REG_RNG1] = 10 * m_sample_us;
+    usleep(10);
+    m_pwm_regs[GPIO_PWM_REG_DMAC] = (1u << 31) | (15u << 8) | 15u; // enable DREQ, panic & dreq thresholds
+    usleep(10);
+    m_pwm_regs[GPIO_PWM_REG_CTL] = 1u << 6; // clear FIFO
+    usleep(10);
+    m_pwm_regs[GPIO_PWM_REG_CTL] = (1u << 5) | 1u; // use FIFO, enable channel 1
+}
+
+
+void CGPIODMA::startDMA (const uint32_t cb_bus)
+{
+    if (m_simulation)
+    {
+        m_sim_cb = cb_bus;
+        m_sim_delay_us = 0;
+        return ;
+    }
+
+    volatile uint32_t* dma = m_dma_regs + m_dma_channel * GPIO_DMA_CHANNEL_WORDS;
+
+    dma[GPIO_DMA_REG_CS] = 1u << 31; // reset
+    usleep(10);
+    dma[GPIO_DMA_REG_CS] = (1u << 2) | (1u << 1); // clear INT & END
+    dma[GPIO_DMA_REG_CONBLK_AD] = cb_bus;
+    dma[GPIO_DMA_REG_DEBUG] = 7; // clear errors
+    dma[GPIO_DMA_REG_CS] = (1u << 28) | (8u << 20) | (8u << 16) | 1u; // wait outstanding writes, priorities, active
+}
+
+
+uint32_t CGPIODMA::getCurrentControlBlock () const
+{
+    if (m_simulation) return m_sim_cb;
+
+    const volatile uint32_t* dma = m_dma_regs + m_dma_channel * GPIO_DMA_CHANNEL_WORDS;
+    return dma[GPIO_DMA_REG_CONBLK_AD];
+}
+
+
+/**
+ * @brief wait until DMA has left chain - up to one second.
+ * in simulation DMA moves only in simulate() so there is no wait.
+ */
+bool CGPIODMA::waitChainIdle (const DMA_CHAIN& chain) const
+{
+    for (uint i = 0; i < 1000; ++i)
+    {
+        const uint32_t cb = getCurrentControlBlock();
+        if ((cb < chain.cb_bus) || (cb >= chain.cb_bus + GPIO_DMA_CHAIN_SIZE)) return true;
+        if (m_simulation) break;
+        usleep(1000);
+    }
+
+    std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: DMA waveform is still running - new waveform dropped." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    return false;
+}
@@ -0,0 +1,211 @@
+#ifndef GPIO_DMA_H_
+#define GPIO_DMA_H_
+
+#include <cstdint>
+#include <vector>
+#include <sys/types.h>
+
+
+// peripheral offsets from peripheral base - BCM283x/BCM2711.
+#define GPIO_DMA_PERI_BUS_BASE      0x7E000000  // peripheral base as seen by DMA
+#define GPIO_DMA_GPIO_OFFSET        0x200000
+#define GPIO_DMA_DMA_OFFSET         0x007000
+#define GPIO_DMA_PWM_OFFSET         0x20C000
+#define GPIO_DMA_CLK_OFFSET         0x101000
+
+// DMA transfer information bits.
+#define GPIO_DMA_TI_WAIT_RESP       (1u << 3)
+#define GPIO_DMA_TI_DEST_INC        (1u << 4)
+#define GPIO_DMA_TI_DEST_DREQ       (1u << 6)
+#define GPIO_DMA_TI_SRC_INC         (1u << 8)
+#define GPIO_DMA_TI_PERMAP(x)       ((x) << 16)
+#define GPIO_DMA_TI_NO_WIDE_BURSTS  (1u << 26)
+#define GPIO_DMA_DREQ_PWM           5
+
+#define GPIO_DMA_MAX_PULSES         512     // pulses of one waveform
+#define GPIO_DMA_MAX_DELAY_SAMPLES  16383   // samples of one delay control block - DMA Lite txfr_len is 16 bits
+#define GPIO_DMA_DEFAULT_SAMPLE_US  5
+
+// channels - pigpio defaults. 7-14 are DMA Lite on BCM283x, 11-14 are DMA4 on BCM2711.
+#define GPIO_DMA_MAX_CHANNEL            14
+#define GPIO_DMA_DEFAULT_CHANNEL_BCM283X 14
+#define GPIO_DMA_DEFAULT_CHANNEL_BCM2711 7
+#define GPIO_DMA_BCM2711_DMA4_CHANNEL   11  // first DMA4 channel - other register layout, not supported
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief BCM DMA control block - layout is fixed by hardware, 32-byte aligned.
+     */
+    typedef struct DMA_CONTROL_BLOCK{
+            uint32_t ti;
+            uint32_t source_ad;
+            uint32_t dest_ad;
+            uint32_t txfr_len;
+            uint32_t stride;
+            uint32_t nextconbk;
+            uint32_t reserved[2];
+        } DMA_CONTROL_BLOCK;
+
+    static_assert(sizeof(DMA_CONTROL_BLOCK) == 32, "DMA_CONTROL_BLOCK must be 32 bytes");
+
+
+    /**
+     * @brief pins in set_mask go high and pins in clear_mask go low, then nothing changes for delay_samples.
+     */
+    typedef struct WAVEFORM_PULSE{
+            uint64_t set_mask;
+            uint64_t clear_mask;
+            uint32_t delay_samples;
+        } WAVEFORM_PULSE;
+
+
+    /**
+     * @brief level of all pins from time_us - simulation output.
+     */
+    typedef struct WAVEFORM_TRANSITION{
+            uint64_t time_us;
+            uint64_t levels;
+        } WAVEFORM_TRANSITION;
+
+
+    /**
+     * @brief DMA-timed waveforms, pigpio style.
+     *
+     * A waveform is built into a cyclic chain of control blocks. Pin changes are
+     * DMA writes of set/clear masks into GPSET/GPCLR. Delays are writes into the
+     * PWM FIFO paced by its DREQ, one word per sample, so timing needs no CPU.
+     *
+     * * open() maps DMA, PWM & clock registers from /dev/mem and allocates uncached
+     *   memory through the VideoCore mailbox.
+     * * openSimulation() uses plain memory and fake bus addresses. simulate() then walks
+     *   the control blocks like the DMA engine would, so chains can be checked on any Linux box.
+     *
+     * Delays longer than GPIO_DMA_MAX_DELAY_SAMPLES are split into several control blocks
+     * so any non DMA4 channel can be used.
+     *
+     * Memory holds two chains. play() builds into the idle one and links the running
+     * chain to it, so a new waveform starts when the current period ends - no glitch.
+     * Pins no longer in the waveform are released by a clear at the start of the new chain.
+     */
+    class CGPIODMA
+    {
+        public:
+
+            CGPIODMA()
+            {
+
+            }
+
+            CGPIODMA(CGPIODMA const&)             = delete;
+            void operator=(CGPIODMA const&)      = delete;
+
+            ~CGPIODMA ()
+            {
+                close();
+            }
+
+        public:
+
+            static uint getDefaultChannel ();
+
+            bool open (const uint dma_channel, const uint sample_us);
+            bool openSimulation (const uint sample_us);
+            void close ();
+
+            inline bool isOpen () const
+            {
+                return m_memory != nullptr;
+            }
+
+            inline bool isSimulation () const
+            {
+                return m_simulation;
+            }
+
+            inline uint getSampleUS () const
+            {
+                return m_sample_us;
+            }
+
+            bool play (const WAVEFORM_PULSE* pulses, const size_t count, const uint64_t release_mask);
+            void stop ();
+
+            void simulate (const uint64_t duration_us, std::vector<WAVEFORM_TRANSITION>& transitions);
+
+        public:
+
+            /**
+             * @brief build a cyclic control block chain for pulses.
+             *
+             * @param release_mask pins cleared once when chain starts - not part of the cycle.
+             * @param control_blocks receives control blocks - first one is the chain start.
+             * @param cb_bus bus address of control_blocks.
+             * @param data receives set/clear masks.
+             * @param data_bus bus address of data.
+             * @param gpio_bus bus address of GPIO register block.
+             * @param pwm_fifo_bus bus address of PWM FIF1.
+             * @return number of control blocks, 0 if pulses do not fit.
+             */
+            static size_t buildChain (const WAVEFORM_PULSE* pulses, const size_t count, const uint64_t release_mask,
+                                      DMA_CONTROL_BLOCK* control_blocks, const uint32_t cb_bus, const size_t max_control_blocks,
+                                      uint32_t* data, const uint32_t data_bus, const size_t max_data_words,
+                                      const uint32_t gpio_bus, const uint32_t pwm_fifo_bus);
+
+        private:
+
+            typedef struct DMA_CHAIN{
+                    DMA_CONTROL_BLOCK* control_blocks;
+                    uint32_t* data;
+                    uint32_t cb_bus;
+                    uint32_t data_bus;
+                    size_t count;
+                } DMA_CHAIN;
+
+            bool mapPeripherals ();
+            bool allocateMemory ();
+            void setupPacing ();
+            void startDMA (const uint32_t cb_bus);
+            uint32_t getCurrentControlBlock () const;
+            bool waitChainIdle (const DMA_CHAIN& chain) const;
+
+            inline uint32_t* toVirtual (const uint32_t bus) const
+            {
+                return reinterpret_cast<uint32_t*>(m_memory + (bus - m_memory_bus));
+            }
+
+        private:
+
+            uint8_t* m_memory = nullptr;
+            uint32_t m_memory_bus = 0;
+            size_t m_memory_size = 0;
+            DMA_CHAIN m_chains[2];
+            int m_running_chain = -1;
+
+            uint m_sample_us = GPIO_DMA_DEFAULT_SAMPLE_US;
+            uint m_dma_channel = GPIO_DMA_DEFAULT_CHANNEL_BCM283X;
+            bool m_simulation = false;
+
+            // hardware
+            int m_mem_fd = -1;
+            int m_mailbox_fd = -1;
+            uint32_t m_mailbox_handle = 0;
+            volatile uint32_t* m_dma_regs = nullptr;
+            volatile uint32_t* m_pwm_regs = nullptr;
+            volatile uint32_t* m_clk_regs = nullptr;
+
+            // simulation - GPIO levels and control block being executed.
+            uint64_t m_sim_levels = 0;
+            uint32_t m_sim_cb = 0;
+            uint64_t m_sim_delay_us = 0;    // time already spent in delay block m_sim_cb
+            uint64_t m_sim_time_us = 0;
+    };
+
+}
+}
+
+#endif
@@ -1,19 +1,133 @@
 #include <iostream>
-#ifdef TEST_MODE_NO_WIRINGPI_LINK
-void wiringPiSetupGpio(){}
-#else
-#include <wiringPi.h>
-#endif
+#include <cstring>
 #include "../de_common/helpers/colors.hpp"
 #include "../de_common/de_databus/configFile.hpp"
 
 #include "gpio_driver.hpp"
-#include "gpio_facade.hpp"
+#include "gpio_latency.hpp"
+#include "gpio_recorder.hpp"
+#include "gpio_notifier.hpp"
 
 
 
 using namespace de::gpio;
 
+
+/**
+ * @brief select how pins are accessed.
+ * 
+ * "gpio_backend": "wiringpi" (default), "gpiomem", "chardev" or "simulation" (default if wiringPi is not linked).
+ * "gpio_mem_path": "/dev/gpiomem" (default). Must be a GPIO device.
+ * "gpio_mem_file": regular file used as register file for testing instead of gpio_mem_path - created if missing.
+ * "gpio_chip": "/dev/gpiochip0" (default) character device used for edge events of INPUT pins.
+ * "input_sample_hz": sample all INPUT pins at this rate. default 0 - disabled.
+ * "input_sample_buffer": samples kept in ring. default 16384.
+ * 
+ */
+bool CGPIODriver::initBackendFromConfigFile()
+{
+    try
+    {
+        const Json_de& m_jsonConfig = de::CConfigFile::getInstance().GetConfigJSON();
+
+        if (m_jsonConfig.contains("gpio_chip"))
+        {
+            m_gpio_chip = m_jsonConfig["gpio_chip"].get<std::string>();
+        }
+
+        if (m_jsonConfig.contains("pwm_freq_tolerance"))
+        {
+            m_pwm_freq_tolerance = m_jsonConfig["pwm_freq_tolerance"].get<double>() / 100.0;
+        }
+
+        if (m_jsonConfig.contains("soft_pwm_freq"))
+        {
+            m_soft_pwm.setFrequency(m_jsonConfig["soft_pwm_freq"].get<double>());
+        }
+
+        if (m_jsonConfig.contains("soft_pwm_backend") && (m_jsonConfig["soft_pwm_backend"].get<std::string>() == "dma"))
+        {
+            const uint dma_channel = m_jsonConfig.contains("dma_channel") ? m_jsonConfig["dma_channel"].get<uint>() : CGPIODMA::getDefaultChannel();
+            const uint sample_us = m_jsonConfig.contains("dma_sample_us") ? m_jsonConfig["dma_sample_us"].get<uint>() : GPIO_DMA_DEFAULT_SAMPLE_US;
+            
+            // DMA pacing uses the PWM peripheral - hardware PWM pins cannot be used with it.
+            if (!m_soft_pwm.useDMA(dma_channel, sample_us))
+            {
+                std::cout << _LOG_CONSOLE_BOLD_TEXT << "WARNING: DMA is not available - soft PWM uses a thread." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            }
+        }
+
+        if (m_jsonConfig.contains("input_sample_hz"))
+        {
+            const size_t buffer_samples = m_jsonConfig.contains("input_sample_buffer") ? m_jsonConfig["input_sample_buffer"].get<size_t>() : GPIO_SAMPLER_DEFAULT_BUFFER;
+            m_sampler.configure(m_jsonConfig["input_sample_hz"].get<double>(), buffer_samples);
+        }
+
+        std::string backend = GPIO_BACKEND_DEFAULT;
+        if (m_jsonConfig.contains("gpio_backend"))
+        {
+            backend = m_jsonConfig["gpio_backend"].get<std::string>();
+        }
+
+        #ifdef TEST_MODE_NO_WIRINGPI_LINK
+        if (backend == "wiringpi")
+        {
+            std::cout << _LOG_CONSOLE_BOLD_TEXT << "WARNING: wiringPi is not linked - simulation backend is used." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            backend = "simulation";
+        }
+        #endif
+        
+        bool opened = false;
+        if (backend == "simulation")
+        {
+            m_backend.emplace<CGPIOBackendSimulation>();
+            opened = true;
+        }
+        else if (backend == "gpiomem")
+        {
+            std::string path = "/dev/gpiomem";
+            const bool register_file = m_jsonConfig.contains("gpio_mem_file");
+            if (register_file)
+            {
+                path = m_jsonConfig["gpio_mem_file"].get<std::string>();
+            }
+            else if (m_jsonConfig.contains("gpio_mem_path"))
+            {
+                path = m_jsonConfig["gpio_mem_path"].get<std::string>();
+            }
+
+            opened = m_backend.emplace<CGPIOBackendRegisters>().open(path, register_file);
+        }
+        else if (backend == "chardev")
+        {
+            opened = m_backend.emplace<CGPIOBackendChardev>().open(m_gpio_chip);
+        }
+        #ifndef TEST_MODE_NO_WIRINGPI_LINK
+        else if (backend == "wiringpi")
+        {
+            opened = m_backend.emplace<CGPIOBackendWiringPi>().open();
+        }
+        #endif
+        else
+        {
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unknown gpio_backend " << backend << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            return false;
+        }
+
+        if (opened)
+        {
+            std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "GPIO backend: " << _INFO_CONSOLE_BOLD_TEXT << getBackendName() << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        }
+
+        return opened;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Exception in initBackendFromConfigFile: " << e.what() << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+}
+
 bool CGPIODriver::initGPIOFromConfigFile()
 {
 
@@ -83,6 +197,26 @@ bool CGPIODriver::initGPIOFromConfigFile()
             {
                 gpio.pin_name = pin["name"].get<std::string>();
             }
+
+            if (pin.contains("debounce_us"))
+            {
+                gpio.input_filter.debounce_us = pin["debounce_us"].get<uint32_t>();
+            }
+
+            if (pin.contains("min_pulse_us"))
+            {
+                gpio.input_filter.min_pulse_us = pin["min_pulse_us"].get<uint32_t>();
+            }
+
+            if (pin.contains("majority"))
+            {
+                gpio.input_filter.majority = pin["majority"].get<uint32_t>();
+            }
+
+            if (pin.contains("majority_interval_us"))
+            {
+                gpio.input_filter.majority_interval_us = pin["majority_interval_us"].get<uint32_t>();
+            }
             
             configurePort(gpio);
             
@@ -99,15 +233,89 @@ bool CGPIODriver::initGPIOFromConfigFile()
     
 }
 
+/**
+ * @brief quadrature encoders. their pins are configured as ENCODER_INPUT.
+ * 
+ * "encoders": [{"name": "winch", "a": 17, "b": 27, "index": 22, "index_reset": false}]
+ *      "index" & "index_reset" are optional.
+ */
+bool CGPIODriver::initEncodersFromConfigFile()
+{
+    try
+    {
+        const Json_de& m_jsonConfig = de::CConfigFile::getInstance().GetConfigJSON();
+
+        if (!m_jsonConfig.contains("encoders")) return true;
+
+        for (const auto& item : m_jsonConfig["encoders"])
+        {
+            if (!item.contains("a") || !item.contains("b"))
+            {
+                std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Missing required fields 'a' or 'b' in encoder configuration." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+                continue;
+            }
+
+            GPIO_ENCODER encoder;
+            encoder.name = item.contains("name") ? item["name"].get<std::string>() : ("encoder" + std::to_string(m_encoders.getCount()));
+            encoder.pin_a = item["a"].get<uint>();
+            encoder.pin_b = item["b"].get<uint>();
+            if (item.contains("index")) encoder.pin_index = item["index"].get<uint>();
+            if (item.contains("index_reset")) encoder.index_reset = item["index_reset"].get<bool>();
+
+            if (m_encoders.addEncoder(encoder) < 0) continue;
+
+            const uint pins[3] = {encoder.pin_a, encoder.pin_b, encoder.pin_index};
+            const char* suffixes[3] = {"_a", "_b", "_index"};
+            for (uint channel = 0; channel < 3; ++channel)
+            {
+                if (pins[channel] == GPIO_ENCODER_NO_PIN) continue;
+
+                GPIO gpio;
+                gpio.pin_number = pins[channel];
+                gpio.pin_mode = ENCODER_INPUT;
+                gpio.pin_value = 0;
+                gpio.pin_pwm_width = 0;
+                gpio.gpio_type = GENERIC;
+                gpio.pin_name = encoder.name + suffixes[channel];
+                configurePort(gpio);
+            }
+        }
+
+        return true;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Exception in initEncodersFromConfigFile: " << e.what() << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+}
+
 void CGPIODriver::configurePort(const GPIO & gpio)
 {
     // Validate pin number
-    if (gpio.pin_number > 53) // Raspberry Pi GPIO pins are 0-53
+    if (gpio.pin_number >= MAX_GPIO_PINS) // Raspberry Pi GPIO pins are 0-53
     {
         std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Invalid pin number " << gpio.pin_number << _NORMAL_CONSOLE_TEXT_ << std::endl;
         return;
     }
 
+    // snapshots keep GPIO_STATE_NAME_MAX chars - a longer name would be published truncated.
+    if (gpio.pin_name.size() > GPIO_STATE_NAME_MAX)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Name of pin " << gpio.pin_number << " is longer than " << GPIO_STATE_NAME_MAX << " chars." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return;
+    }
+
+    // PWM clock & FIFO pace soft PWM DMA - hardware PWM would reprogram them.
+    if ((gpio.pin_mode == PWM_OUTPUT) && m_soft_pwm.isDMA())
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Pin " << gpio.pin_number << " cannot be PWM_OUTPUT while soft PWM uses DMA - use SOFT_PWM_OUTPUT." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return;
+    }
+
+    {
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+
     // remove node if exists from list.
     removeGPIOByNumber(gpio.pin_number);
 
@@ -115,19 +323,44 @@ void CGPIODriver::configurePort(const GPIO & gpio)
     setPinMode(gpio.pin_number, gpio.pin_mode);
     
     // add node to list.
-    m_gpio_array.push_back(gpio);
+    m_gpio_slots[gpio.pin_number] = gpio;
+    m_gpio_used.set(gpio.pin_number);
+    CGPIORecorder::getInstance().record(GPIO_RECORD_CONFIG, gpio.pin_number, gpio.pin_mode, gpio.pin_value);
+    markDirty((1ull << gpio.pin_number) | GPIO_DIRTY_LAYOUT);
+    if (!gpio.pin_name.empty())
+    {
+        m_gpio_name_index[gpio.pin_name] = gpio.pin_number;
+    }
 
     // Handle OUTPUT and PWM_OUTPUT modes
     if (gpio.pin_mode == OUTPUT)
     {
         writePin(gpio.pin_number, gpio.pin_value);
     }
-    else if (gpio.pin_mode == PWM_OUTPUT)
+    else if ((gpio.pin_mode == PWM_OUTPUT) || (gpio.pin_mode == SOFT_PWM_OUTPUT))
     {
         writePWM(gpio.pin_number, gpio.pin_value, gpio.pin_pwm_width);
     }
+    else if (gpio.pin_mode == PULSE_INPUT)
+    {
+        m_pulse.reset(gpio.pin_number);
+        m_pulse_mask.fetch_or(1ull << gpio.pin_number);
+    }
+    else if (gpio.pin_mode == ENCODER_INPUT)
+    {
+        m_encoder_mask.fetch_or(1ull << gpio.pin_number);
+    }
+    CGPIOLatency::getInstance().markWrite();
 
     
+    m_input_filters[gpio.pin_number].configure(gpio.input_filter, gpio.pin_value);
+    publishPins(1ull << gpio.pin_number);
+    }
+
+    // INPUT pins may have been added or removed.
+    // called without m_write_mutex as it joins the event thread.
+    updateInputEvents();
+
     // Output the values
     std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "Pin Number: " << _INFO_CONSOLE_BOLD_TEXT << gpio.pin_number 
                     << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Mode: " << _INFO_CONSOLE_BOLD_TEXT  << gpio.pin_mode 
@@ -139,23 +372,43 @@ void CGPIODriver::configurePort(const GPIO & gpio)
 
 bool CGPIODriver::init()
 {
-    m_gpio_array.clear();
-
-#ifndef TEST_MODE_NO_WIRINGPI_LINK
-    if (wiringPiSetupGpio () == -1)
     {
-        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to setup WiringPi GPIO." << _NORMAL_CONSOLE_TEXT_ << std::endl;
-        return false;
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+    m_gpio_used.reset();
+    m_gpio_name_index.clear();
+    m_pulse_mask = 0;
+    m_encoder_mask = 0;
+    m_encoders.clear();
+    markDirty(GPIO_DIRTY_LAYOUT);
+    publishPins(~0ull);
+    m_pwm_solutions.clear();
+    invalidatePWMCache();
     }
-#else
-    wiringPiSetupGpio ();
-#endif
 
-    return initGPIOFromConfigFile();
+    if (!initBackendFromConfigFile()) return false;
+
+    m_soft_pwm.setWriteHandler([this](const uint64_t set_mask, const uint64_t clear_mask){ writeHardwareMasks(set_mask, clear_mask); });
+    m_sampler.setReadHandler([this](uint64_t& levels){ return readInputLevels(levels); });
+
+    if (!initGPIOFromConfigFile()) return false;
+    if (!initEncodersFromConfigFile()) return false;
+
+    m_input_events_enabled = true;
+    updateInputEvents();
+
+    return true;
 }
 
 bool CGPIODriver::uninit()
 {
+    m_input_events_enabled = false;
+    m_sampler.stop();
+    m_input_events.stop();
+
+    m_soft_pwm.stop();
+
+    std::visit([](auto& backend){ backend.close(); }, m_backend);
+    
     return true;
 }
 
@@ -165,34 +418,75 @@ void CGPIODriver::setPinMode (uint pin_number, uint pin_mode)
     std::cout << _INFO_CONSOLE_TEXT << ":setPinMode:pin_number" << _LOG_CONSOLE_BOLD_TEXT << pin_number << _INFO_CONSOLE_TEXT << ":pin_mode:" << _LOG_CONSOLE_BOLD_TEXT << pin_mode << _NORMAL_CONSOLE_TEXT_ << std::endl;
     #endif
     
-    #ifndef TEST_MODE_NO_WIRINGPI_LINK
-    pinMode (pin_number, pin_mode);
-    if (pin_mode == OUTPUT)
-    {
-        pullUpDnControl(pin_number, PUD_DOWN);
-    }
-    else if (pin_mode == INPUT)
+    // soft PWM pins are plain outputs toggled by m_soft_pwm thread.
+    // wiringPi SOFT_PWM_OUTPUT would start its own PWM thread.
+    if (pin_mode == SOFT_PWM_OUTPUT) pin_mode = OUTPUT;
+    // pulses are measured from edge events of a plain input.
+    if ((pin_mode == PULSE_INPUT) || (pin_mode == ENCODER_INPUT)) pin_mode = INPUT;
+
+    if (pin_mode == PWM_OUTPUT)
     {
-        pullUpDnControl(pin_number, PUD_UP); // Enable pull-up resistor on button
+        // wiringPi pinMode resets PWM mode, clock and range to its defaults.
+        invalidatePWMCache();
     }
-    #endif
+
+    std::visit([&](auto& backend){ backend.setPinMode(pin_number, pin_mode); }, m_backend);
 }
 
 int CGPIODriver::readPin(uint pin_number)
 {
     const GPIO* gpio = getGPIOByNumber (pin_number);
     
-    if ((gpio == nullptr) || (gpio->pin_mode != INPUT))return -1;
-    if (gpio) 
-    {
-        #ifdef DEBUG
-        std::cout << _INFO_CONSOLE_TEXT << ":readPin:" << _LOG_CONSOLE_BOLD_TEXT << pin_number << _NORMAL_CONSOLE_TEXT_ << std::endl;
-        #endif
+    if ((gpio == nullptr) || !isInputMode(gpio->pin_mode)) return -1;
 
-        #ifndef TEST_MODE_NO_WIRINGPI_LINK
-        return digitalRead (pin_number);
-        #endif
-    }
+    #ifdef DEBUG
+    std::cout << _INFO_CONSOLE_TEXT << ":readPin:" << _LOG_CONSOLE_BOLD_TEXT << pin_number << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    #endif
+
+    return readInputLevel(pin_number, gpio->pin_value);
+}
+
+
+/**
+ * @brief level of an INPUT pin from backend, or from edge event lines if backend cannot read inputs.
+ * 
+ * @param level returned if line cannot be read.
+ */
+uint CGPIODriver::readInputLevel (const uint pin_number, const uint level)
+{
+    return std::visit([&](auto& backend) -> uint {
+        if constexpr (std::decay_t<decltype(backend)>::reads_inputs)
+        {
+            return backend.readPin(pin_number);
+        }
+        else
+        {
+            uint64_t levels;
+            if (!m_input_events.readLevels(levels)) return level;
+            return (levels >> pin_number) & 1;
+        }
+    }, m_backend);
+}
+
+
+/**
+ * @brief levels of all INPUT pins in one read - used by input sampler.
+ * 
+ * @param levels bit n is level of GPIO n.
+ */
+bool CGPIODriver::readInputLevels (uint64_t& levels)
+{
+    return std::visit([&](auto& backend) -> bool {
+        if constexpr (std::decay_t<decltype(backend)>::reads_inputs)
+        {
+            levels = backend.readLevels(m_sampler.getPinMask());
+            return true;
+        }
+        else
+        {
+            return m_input_events.readLevels(levels);
+        }
+    }, m_backend);
 }
 
 void CGPIODriver::writePin(uint pin_number, uint pin_value)
@@ -205,16 +499,191 @@ void CGPIODriver::writePin(uint pin_number, uint pin_value)
         #ifdef DEBUG
         std::cout << _INFO_CONSOLE_TEXT << ":writePin:" << _LOG_CONSOLE_BOLD_TEXT << pin_number << _INFO_CONSOLE_TEXT << ":pin_value:" << _LOG_CONSOLE_BOLD_TEXT << pin_value << _NORMAL_CONSOLE_TEXT_ << std::endl;
         #endif
-        #ifndef TEST_MODE_NO_WIRINGPI_LINK
-        digitalWrite (pin_number, pin_value);
-        #endif
+        std::visit([&](auto& backend){ backend.writePin(pin_number, pin_value); }, m_backend);
+        CGPIOLatency::getInstance().markWrite();
     }
 }
 
 
+/**
+ * @brief change several OUTPUT pins together.
+ * bit n of each mask is GPIO n. Pins that are not configured as OUTPUT are ignored.
+ * With gpiomem backend each bank is changed by one set write followed by one clear write.
+ * 
+ * @param set_mask pins to set high.
+ * @param clear_mask pins to set low.
+ */
+void CGPIODriver::writePinMasks (const uint64_t set_mask, const uint64_t clear_mask)
+{
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+
+    uint64_t set_bits = 0;
+    uint64_t clear_bits = 0;
+    uint64_t changed_bits = 0;
+
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        const uint64_t bit = 1ull << i;
+        if (!((set_mask | clear_mask) & bit)) continue;
+
+        GPIO* gpio = _getGPIOByNumber(i);
+        if ((gpio == nullptr) || (gpio->pin_mode != OUTPUT)) continue;
+
+        const uint pin_value = (set_mask & bit) ? 1 : 0;
+        if (gpio->pin_value != pin_value) changed_bits |= bit;
+        gpio->pin_value = pin_value;
+
+        if (pin_value)
+        {
+            set_bits |= bit;
+        }
+        else
+        {
+            clear_bits |= bit;
+        }
+    }
+
+    if (changed_bits)
+    {
+        markDirty(changed_bits);
+        publishPins(changed_bits);
+
+        CGPIORecorder& recorder = CGPIORecorder::getInstance();
+        for (uint64_t bits = changed_bits; bits; bits &= bits - 1)
+        {
+            const uint pin_number = __builtin_ctzll(bits);
+            recorder.record(GPIO_RECORD_PIN, pin_number, (set_bits >> pin_number) & 1);
+        }
+    }
+
+    #ifdef DEBUG
+    std::cout << _INFO_CONSOLE_TEXT << ":writePinMasks:set:" << _LOG_CONSOLE_BOLD_TEXT << std::hex << set_bits << _INFO_CONSOLE_TEXT << ":clear:" << _LOG_CONSOLE_BOLD_TEXT << clear_bits << std::dec << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    #endif
+
+    writeHardwareMasks(set_bits, clear_bits);
+}
+
+
+/**
+ * @brief write pins to hardware only - pin registry is not changed.
+ * used by soft PWM where levels change too fast to be reported.
+ */
+void CGPIODriver::writeHardwareMasks (const uint64_t set_mask, const uint64_t clear_mask)
+{
+    std::visit([&](auto& backend){ backend.writeMasks(set_mask, clear_mask); }, m_backend);
+    CGPIOLatency::getInstance().markWrite();
+}
+
+
 const std::vector<GPIO> CGPIODriver::getGPIOStatus() const
 {
-    return m_gpio_array;
+    return getGPIOStatus(~0ull);
+}
+
+/**
+ * @brief status of configured pins in pin_mask only.
+ */
+const std::vector<GPIO> CGPIODriver::getGPIOStatus(const uint64_t pin_mask) const
+{
+    GPIO_SNAPSHOT snapshot;
+    getGPIOSnapshot(snapshot, pin_mask);
+
+    std::vector<GPIO> gpios;
+    gpios.reserve(__builtin_popcountll(snapshot.used_mask));
+
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if (!(snapshot.used_mask & (1ull << i))) continue;
+        
+        gpios.emplace_back();
+        toGPIO(snapshot.gpios[i], gpios.back());
+    }
+
+    return gpios;
+}
+
+
+/**
+ * @brief consistent copy of pins in pin_mask without locking.
+ * retries while a writer is publishing - writers never wait for readers.
+ * 
+ * @param snapshot only entries of pins in snapshot.used_mask are valid.
+ * @param pin_mask pins to copy.
+ */
+void CGPIODriver::getGPIOSnapshot (GPIO_SNAPSHOT& snapshot, const uint64_t pin_mask) const
+{
+    while (true)
+    {
+        const uint32_t seq = m_snapshot_seq.load(std::memory_order_acquire);
+        if (seq & 1) continue;   // writer in progress
+
+        snapshot.used_mask = m_snapshot_used.load(std::memory_order_acquire) & pin_mask;
+
+        for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+        {
+            if (!(snapshot.used_mask & (1ull << i))) continue;
+
+            uint64_t words[GPIO_STATE_WORDS];
+            for (size_t w = 0; w < GPIO_STATE_WORDS; ++w)
+            {
+                words[w] = m_snapshot_words[i][w].load(std::memory_order_acquire);
+            }
+            memcpy(&snapshot.gpios[i], words, sizeof(GPIO_STATE));
+        }
+
+        // acquire loads above keep this check after them - a word stored by a newer writer implies its odd seq.
+        if (m_snapshot_seq.load(std::memory_order_relaxed) == seq) return ;
+    }
+}
+
+
+void CGPIODriver::toGPIO (const GPIO_STATE& state, GPIO& gpio)
+{
+    gpio.pin_number = state.pin_number;
+    gpio.pin_mode = state.pin_mode;
+    gpio.pin_value = state.pin_value;
+    gpio.pin_pwm_width = state.pin_pwm_width;
+    gpio.gpio_type = static_cast<ENUM_GPIO_TYPE>(state.gpio_type);
+    gpio.pin_name.assign(state.pin_name, state.name_length);
+}
+
+
+/**
+ * @brief copy pins in pin_mask to the seqlock snapshot.
+ * must be called with m_write_mutex held.
+ */
+void CGPIODriver::publishPins (const uint64_t pin_mask)
+{
+    const uint32_t seq = m_snapshot_seq.load(std::memory_order_relaxed);
+    m_snapshot_seq.store(seq + 1, std::memory_order_relaxed);
+
+    uint64_t used = 0;
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if (!m_gpio_used.test(i)) continue;
+        used |= 1ull << i;
+        if (!(pin_mask & (1ull << i))) continue;
+
+        const GPIO& gpio = m_gpio_slots[i];
+        GPIO_STATE state = {};
+        state.pin_value = gpio.pin_value;
+        state.pin_pwm_width = gpio.pin_pwm_width;
+        state.pin_number = static_cast<uint8_t>(gpio.pin_number);
+        state.pin_mode = static_cast<uint8_t>(gpio.pin_mode);
+        state.gpio_type = static_cast<uint8_t>(gpio.gpio_type);
+        state.name_length = static_cast<uint8_t>(std::min<size_t>(gpio.pin_name.size(), GPIO_STATE_NAME_MAX));
+        memcpy(state.pin_name, gpio.pin_name.data(), state.name_length);
+
+        uint64_t words[GPIO_STATE_WORDS];
+        memcpy(words, &state, sizeof(GPIO_STATE));
+        for (size_t w = 0; w < GPIO_STATE_WORDS; ++w)
+        {
+            m_snapshot_words[i][w].store(words[w], std::memory_order_release);
+        }
+    }
+    m_snapshot_used.store(used, std::memory_order_release);
+
+    m_snapshot_seq.store(seq + 2, std::memory_order_release);
 }
 
 // Function to get GPIO record by pin_name
@@ -233,43 +702,45 @@ const GPIO* CGPIODriver::getGPIOByNumber(uint pin_number) const
 
 void CGPIODriver::changeGPIOByNumber (uint pin_number, uint pin_value, uint pin_pwm_width) 
 {
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+
     GPIO* gpio = _getGPIOByNumber (pin_number);
     if (gpio)
     {
-        gpio->pin_value = pin_value;
-        gpio->pin_pwm_width = pin_pwm_width;
+        if ((gpio->pin_value != pin_value) || (gpio->pin_pwm_width != pin_pwm_width))
+        {
+            gpio->pin_value = pin_value;
+            gpio->pin_pwm_width = pin_pwm_width;
+            if (gpio->pin_mode == OUTPUT)
+            {
+                CGPIORecorder::getInstance().record(GPIO_RECORD_PIN, pin_number, pin_value);
+            }
+            else
+            {
+                CGPIORecorder::getInstance().record(GPIO_RECORD_PWM, pin_number, pin_pwm_width, pin_value);
+            }
+            markDirty(1ull << pin_number);
+            publishPins(1ull << pin_number);
+        }
     }
 }
 
 GPIO* CGPIODriver::_getGPIOByName (const std::string& pin_name) const
 {
-    #ifdef DEBUG
-    std::cout << _INFO_CONSOLE_TEXT << ":getGPIOByName:" << _LOG_CONSOLE_BOLD_TEXT << pin_name << _NORMAL_CONSOLE_TEXT_ << std::endl;
-    #endif
-
     if (pin_name.empty()) return nullptr;
 
-    for (const auto& gpio : m_gpio_array) {
-        if (gpio.pin_name == pin_name) {
-            return const_cast<GPIO*>(&gpio); // Return the matched GPIO record
-        }
-    }
-    return nullptr; // Return nullptr if not found
+    const auto it = m_gpio_name_index.find(pin_name);
+    if (it == m_gpio_name_index.end()) return nullptr; // Return nullptr if not found
+
+    return _getGPIOByNumber (it->second);
 }
 
 
 GPIO* CGPIODriver::_getGPIOByNumber (uint pin_number) const
 {
-    #ifdef DEBUG
-    std::cout << _INFO_CONSOLE_TEXT << ":getGPIOByNumber:pin_number:" << _LOG_CONSOLE_BOLD_TEXT << pin_number << _NORMAL_CONSOLE_TEXT_ << std::endl;
-    #endif
+    if ((pin_number >= MAX_GPIO_PINS) || !m_gpio_used.test(pin_number)) return nullptr; // Return nullptr if not found
 
-    for (const auto& gpio : m_gpio_array) {
-        if (gpio.pin_number == pin_number) {
-            return const_cast<GPIO*>(&gpio); // Return the matched GPIO record
-        }
-    }
-    return nullptr; // Return nullptr if not found
+    return const_cast<GPIO*>(&m_gpio_slots[pin_number]);
 }
 
 void CGPIODriver::removeGPIOByNumber (uint pin_number)
@@ -278,18 +749,41 @@ void CGPIODriver::removeGPIOByNumber (uint pin_number)
     std::cout << _INFO_CONSOLE_TEXT << ":removeGPIOByNumber:pin_number:" << _LOG_CONSOLE_BOLD_TEXT << pin_number << _NORMAL_CONSOLE_TEXT_ << std::endl;
     #endif
 
-    for (auto it = m_gpio_array.begin(); it != m_gpio_array.end(); ++it) {
-        if (it->pin_number == pin_number) {
-            m_gpio_array.erase(it); // Remove the matched GPIO record
-            return ;
+    if ((pin_number >= MAX_GPIO_PINS) || !m_gpio_used.test(pin_number)) return ;
+
+    const GPIO& gpio = m_gpio_slots[pin_number];
+    if (!gpio.pin_name.empty())
+    {
+        const auto it = m_gpio_name_index.find(gpio.pin_name);
+        if ((it != m_gpio_name_index.end()) && (it->second == pin_number))
+        {
+            m_gpio_name_index.erase(it);
         }
     }
-    return ;
+
+    if (gpio.pin_mode == SOFT_PWM_OUTPUT)
+    {
+        m_soft_pwm.removeChannel(pin_number);
+        m_soft_pwm_rejected.reset(pin_number);
+    }
+    m_pulse_mask.fetch_and(~(1ull << pin_number));
+    m_encoder_mask.fetch_and(~(1ull << pin_number));
+
+    m_gpio_used.reset(pin_number);
+    markDirty(GPIO_DIRTY_LAYOUT);
+    publishPins(1ull << pin_number);
 }
 
 void CGPIODriver::writePWM(const uint pin_number, double freq, uint pin_pwm_width)
 {
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+
     const GPIO* gpio = getGPIOByNumber(pin_number);
+    if (gpio && (gpio->pin_mode == SOFT_PWM_OUTPUT)) {
+        writeSoftPWM(pin_number, freq, pin_pwm_width);
+        return;
+    }
+
     if (!gpio || gpio->pin_mode != PWM_OUTPUT) {
         std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Invalid pin " << pin_number << " or not configured for PWM output." << _NORMAL_CONSOLE_TEXT_ << std::endl;
         return;
@@ -300,10 +794,9 @@ void CGPIODriver::writePWM(const uint pin_number, double freq, uint pin_pwm_widt
         // Note: Changed check to <= 0.0 as frequency can be fractional
         // Consider adding a practical lower bound check if needed
          if (freq == 0.0) {
-             #ifndef TEST_MODE_NO_WIRINGPI_LINK
              // Turn PWM off completely if frequency is zero
-             pwmWrite(pin_number, 0);
-             #endif
+             std::visit([&](auto& backend){ backend.writePWM(pin_number, 0); }, m_backend);
+             CGPIOLatency::getInstance().markWrite();
              changeGPIOByNumber(pin_number, 0.0, 0); // Update state
              std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "PWM turned OFF on Pin Number: " << _INFO_CONSOLE_BOLD_TEXT << pin_number << std::endl;
              return;
@@ -317,6 +810,238 @@ void CGPIODriver::writePWM(const uint pin_number, double freq, uint pin_pwm_widt
     if (pin_pwm_width > MAX_PWM) pin_pwm_width = MAX_PWM;
     // Input is uint, so no need to check < 0 unless type changes
 
+    // --- Calculate Clock Divisor and Range - shared by all hardware PWM pins ---
+    PWM_SOLUTION solution;
+    if (!selectPWMSolution(pin_number, freq, solution))
+    {
+        m_pwm_stats.conflicts++;
+        return;
+    }
+    const uint32_t pwm_range = solution.range;
+    const uint32_t clock_divisor = solution.clock_divisor;
+    freq = solution.freq;
+
+    // --- Calculate final PWM value based on scaled input ---
+    // Scale the input width (0-1024) to the calculated pwm_range
+    // Use floating point for intermediate calculation for accuracy
+    double scaled_value_f = static_cast<double>(pin_pwm_width) * pwm_range / MAX_PWM;
+    uint32_t pwm_value = static_cast<uint32_t>(std::round(scaled_value_f));
+
+    // Clamp final value just in case of rounding errors near the boundary
+    if (pwm_value > pwm_range) pwm_value = pwm_range;
+    // Value is unsigned, minimum is 0
+
+
+    #ifdef DEBUG
+        // More detailed debug output
+        std::cout << _INFO_CONSOLE_TEXT << ":writePWM:pin:" << _LOG_CONSOLE_BOLD_TEXT << pin_number
+            << _INFO_CONSOLE_TEXT << ":req_freq:" << _LOG_CONSOLE_BOLD_TEXT << freq // Show potentially adjusted freq
+            << _INFO_CONSOLE_TEXT << ":input_width:" << _LOG_CONSOLE_BOLD_TEXT << pin_pwm_width
+            << _INFO_CONSOLE_TEXT << ":calc_divisor:" << _LOG_CONSOLE_BOLD_TEXT << clock_divisor
+            << _INFO_CONSOLE_TEXT << ":calc_range:" << _LOG_CONSOLE_BOLD_TEXT << pwm_range
+            << _INFO_CONSOLE_TEXT << ":pwm_value:" << _LOG_CONSOLE_BOLD_TEXT << pwm_value
+            << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    #endif
+
+    // --- Apply Settings - clock & range are only reprogrammed when changed ---
+    const bool range_changed = !m_pwm_channel[0].valid || (m_pwm_channel[0].range != pwm_range);
+    applyPWMClock(pin_number, PWM_MODE_MS, clock_divisor, pwm_range);   // Mark:Space mode is common
+    if (range_changed) rescalePWMPins(pin_number, pwm_range);
+    std::visit([&](auto& backend){ backend.writePWM(pin_number, pwm_value); }, m_backend); // Set the scaled duty cycle
+    CGPIOLatency::getInstance().markWrite();
+
+    // Update internal state tracking
+    changeGPIOByNumber (pin_number, freq, pin_pwm_width); // Store original requested values or actuals? Decide based on class needs. Storing requested here.
+
+    // Success Output - showing actual calculated parameters might be more informative
+    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "PWM set on Pin: " << _INFO_CONSOLE_BOLD_TEXT << pin_number
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Target Freq: " << _INFO_CONSOLE_BOLD_TEXT << freq << " Hz" // Show potentially adjusted freq
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Actual Range: " << _INFO_CONSOLE_BOLD_TEXT << pwm_range
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Input Width: " << _INFO_CONSOLE_BOLD_TEXT << pin_pwm_width
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Output Value: " << _INFO_CONSOLE_BOLD_TEXT << pwm_value
+              << std::endl;
+
+    // Add a specific warning if the target frequency of 0.025 Hz was requested but not achieved
+    if (freq < 1.0 && pwm_range == MAX_HW_PWM_RANGE && clock_divisor == MAX_PWM_CLOCK_DIVISOR) { // Heuristic for hitting the low limit
+        double min_achievable = static_cast<double>(baseClock) / (MAX_PWM_CLOCK_DIVISOR * MAX_HW_PWM_RANGE);
+         if (freq > min_achievable * 1.01) { // Check if we are close to the theoretical limit
+             std::cout << _ERROR_CONSOLE_TEXT_ << "Note: Minimum achievable hardware PWM frequency is approx. "
+                       << min_achievable << " Hz. Requested frequency may not be accurately generated." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+         }
+    }
+}
+
+
+/**
+ * @brief duty of a SOFT_PWM_OUTPUT pin.
+ * all soft PWM pins share m_soft_pwm frequency - a write at another frequency is rejected, 0 turns the pin off.
+ */
+void CGPIODriver::writeSoftPWM (const uint pin_number, const double freq, uint pin_pwm_width)
+{
+    if (pin_pwm_width > MAX_PWM) pin_pwm_width = MAX_PWM;
+    if (freq == 0.0) pin_pwm_width = 0;
+
+    if ((freq != 0.0) && (std::fabs(freq - m_soft_pwm.getFrequency()) > m_soft_pwm.getFrequency() * m_pwm_freq_tolerance))
+    {
+        // reported once per pin until it is configured again - clients often repeat the same write.
+        if (!m_soft_pwm_rejected.test(pin_number))
+        {
+            m_soft_pwm_rejected.set(pin_number);
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: soft PWM pin " << pin_number << " runs at " << m_soft_pwm.getFrequency() << " Hz - write at " << freq << " Hz rejected, set soft_pwm_freq instead." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        }
+        return ;
+    }
+
+    m_soft_pwm.setWidth(pin_number, pin_pwm_width, MAX_PWM);
+    CGPIOLatency::getInstance().markWrite();
+
+    changeGPIOByNumber(pin_number, (freq == 0.0) ? 0 : m_soft_pwm.getFrequency(), pin_pwm_width);
+}
+            
+
+        
+            
+
+
+/**
+ * @brief hardware PWM channel of a pin.
+ * 
+ * @return 0 or 1, -1 if pin has no hardware PWM.
+ */
+int CGPIODriver::getPWMChannel (const uint pin_number)
+{
+    switch (pin_number)
+    {
+        case 12: case 18: case 40: case 52:
+            return 0;
+        case 13: case 19: case 41: case 45: case 53:
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+
+/**
+ * @brief choose clock divisor & range for pin_number at freq that also serves all other active PWM pins.
+ * 
+ * BCM PWM clock is shared by both channels and wiringPi sets range of both channels together,
+ * so all hardware PWM pins run at one frequency. Other pins accept it if it is within
+ * m_pwm_freq_tolerance of their own frequency.
+ * The solution in use is preferred so hardware is reprogrammed only when it cannot serve all pins.
+ * 
+ * @return false if no solution serves all pins - nothing is changed.
+ */
+bool CGPIODriver::selectPWMSolution (const uint pin_number, const double freq, PWM_SOLUTION& solution)
+{
+    std::vector<double> freqs;
+    std::vector<uint> pins;
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if ((i == pin_number) || !m_gpio_used.test(i)) continue;
+        const GPIO& gpio = m_gpio_slots[i];
+        if ((gpio.pin_mode != PWM_OUTPUT) || (gpio.pin_value == 0) || (getPWMChannel(i) < 0)) continue;
+        
+        freqs.push_back(gpio.pin_value);
+        pins.push_back(i);
+    }
+
+    if (freqs.empty())
+    {   // pin is alone - exact solution.
+        solution = getPWMSolution(freq);
+        return true;
+    }
+
+    freqs.push_back(freq);
+
+    const auto serves_all = [&](const PWM_SOLUTION& candidate)
+    {
+        const double actual = static_cast<double>(baseClock) / (static_cast<double>(candidate.clock_divisor) * candidate.range);
+        for (const double f : freqs)
+        {
+            if (std::fabs(actual - f) > f * m_pwm_freq_tolerance) return false;
+        }
+        return true;
+    };
+
+    if (m_pwm_clock.valid && m_pwm_channel[0].valid)
+    {
+        const PWM_SOLUTION current = {m_pwm_clock.clock_divisor, m_pwm_channel[0].range, freq};
+        if (serves_all(current))
+        {
+            solution = current;
+            return true;
+        }
+    }
+
+    const double min_freq = *std::min_element(freqs.begin(), freqs.end());
+    const double max_freq = *std::max_element(freqs.begin(), freqs.end());
+    
+    // own frequency first, then middle of the requested band.
+    const double candidates[] = {freq, std::sqrt(min_freq * max_freq)};
+    for (const double candidate_freq : candidates)
+    {
+        const PWM_SOLUTION candidate = getPWMSolution(candidate_freq);
+        if (serves_all(candidate))
+        {
+            solution = candidate;
+            solution.freq = freq;
+            return true;
+        }
+    }
+
+    std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: PWM pin " << pin_number << " at " << freq << " Hz conflicts with pins";
+    for (size_t i = 0; i < pins.size(); ++i)
+    {
+        std::cerr << " " << pins[i] << " (" << freqs[i] << " Hz)";
+    }
+    std::cerr << " - hardware PWM pins share one clock." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    return false;
+}
+
+
+/**
+ * @brief rewrite duty of other active PWM pins after range changed - duty is relative to range.
+ */
+void CGPIODriver::rescalePWMPins (const uint pin_number, const uint32_t pwm_range)
+{
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if ((i == pin_number) || !m_gpio_used.test(i)) continue;
+        const GPIO& gpio = m_gpio_slots[i];
+        if ((gpio.pin_mode != PWM_OUTPUT) || (gpio.pin_value == 0) || (getPWMChannel(i) < 0)) continue;
+
+        const uint32_t pwm_value = std::min<uint32_t>(static_cast<uint32_t>(std::round(static_cast<double>(gpio.pin_pwm_width) * pwm_range / MAX_PWM)), pwm_range);
+        std::visit([&](auto& backend){ backend.writePWM(i, pwm_value); }, m_backend);
+    }
+}
+
+
+/**
+ * @brief returns clock divisor & range for a frequency.
+ * results are memoized as UI sends the same frequency with every duty update.
+ */
+const PWM_SOLUTION& CGPIODriver::getPWMSolution (const double freq)
+{
+    const auto it = m_pwm_solutions.find(freq);
+    if (it != m_pwm_solutions.end())
+    {
+        m_pwm_stats.solution_hits++;
+        return it->second;
+    }
+
+    m_pwm_stats.solution_misses++;
+
+    // keep the table small - frequencies are normally few.
+    if (m_pwm_solutions.size() >= MAX_PWM_SOLUTIONS) m_pwm_solutions.clear();
+
+    return m_pwm_solutions.emplace(freq, computePWMSolution(freq)).first->second;
+}
+
+
+PWM_SOLUTION CGPIODriver::computePWMSolution (double freq) const
+{
     uint32_t pwm_range = MAX_PWM; // Start with preferred range/resolution
     uint32_t clock_divisor = 0;
     double target_divisor;
@@ -385,57 +1110,219 @@ void CGPIODriver::writePWM(const uint pin_number, double freq, uint pin_pwm_widt
         }
     }
 
-    // --- Calculate final PWM value based on scaled input ---
-    // Scale the input width (0-1024) to the calculated pwm_range
-    // Use floating point for intermediate calculation for accuracy
-    double scaled_value_f = static_cast<double>(pin_pwm_width) * pwm_range / MAX_PWM;
-    uint32_t pwm_value = static_cast<uint32_t>(std::round(scaled_value_f));
+    return {clock_divisor, pwm_range, freq};
+}
 
-    // Clamp final value just in case of rounding errors near the boundary
-    if (pwm_value > pwm_range) pwm_value = pwm_range;
-    // Value is unsigned, minimum is 0
 
+/**
+ * @brief program PWM mode, clock divisor and range only if they differ from last applied values.
+ * Reprogramming the clock is slow and glitches the output.
+ */
+void CGPIODriver::applyPWMClock (const uint pin_number, const uint32_t mode, const uint32_t clock_divisor, const uint32_t pwm_range)
+{
+    if (!m_pwm_clock.valid || (m_pwm_clock.mode != mode) || (m_pwm_clock.clock_divisor != clock_divisor))
+    {
+        std::visit([&](auto& backend){ backend.setPWMClock(mode, clock_divisor); }, m_backend);
+        m_pwm_clock.valid = true;
+        m_pwm_clock.mode = mode;
+        m_pwm_clock.clock_divisor = clock_divisor;
+        m_pwm_stats.clock_reprograms++;
+    }
+    else
+    {
+        m_pwm_stats.clock_skipped++;
+    }
+
+    const int channel = getPWMChannel(pin_number);
+    if ((channel < 0) || !m_pwm_channel[channel].valid || (m_pwm_channel[channel].range != pwm_range))
+    {
+        std::visit([&](auto& backend){ backend.setPWMRange(pwm_range); }, m_backend);
+        // wiringPi pwmSetRange writes the range of both channels.
+        for (auto& pwm_channel : m_pwm_channel)
+        {
+            pwm_channel.valid = true;
+            pwm_channel.range = pwm_range;
+        }
+        m_pwm_stats.range_reprograms++;
+    }
+    else
+    {
+        m_pwm_stats.range_skipped++;
+    }
+}
+
+
+void CGPIODriver::invalidatePWMCache ()
+{
+    m_pwm_clock.valid = false;
+    for (auto& pwm_channel : m_pwm_channel)
+    {
+        pwm_channel.valid = false;
+    }
+}
+
+
+/**
+ * @brief restart edge event engine if set of INPUT pins changed.
+ */
+void CGPIODriver::updateInputEvents ()
+{
+    if (!m_input_events_enabled) return ;
+
+    uint64_t input_mask = 0;
+    {
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if (!m_gpio_used.test(i)) continue;
+        if (isInputMode(m_gpio_slots[i].pin_mode)) input_mask |= (1ull << i);
+    }
+    }
+
+    // a failed line request keeps its mask - edges of those pins then only come from injectEvent.
+    if (m_input_events.isRunning() && (m_input_events.getRequestedMask() == input_mask)) return ;
+
+    // sampler may read event lines on chardev backend.
+    m_sampler.stop();
+    m_input_events.stop();
+
+    m_input_events.start(m_gpio_chip, input_mask, [&](const GPIO_EVENT& event){ onInputEvent(event); }, [&](const uint64_t now_ns){ onInputTimer(now_ns); });
+    
+    // initial levels so status is correct before first edge.
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if (!(input_mask & (1ull << i))) continue;
+        
+        const uint level = readInputLevel(i, m_gpio_slots[i].pin_value);
+        if (m_gpio_slots[i].pin_value != level)
+        {
+            m_gpio_slots[i].pin_value = level;
+            markDirty(1ull << i);
+        }
+        m_input_filters[i].configure(m_gpio_slots[i].input_filter, m_gpio_slots[i].pin_value);
+        m_encoders.setLevel(i, m_gpio_slots[i].pin_value);
+    }
+    publishPins(input_mask);
+
+    m_sampler.start(input_mask);
+}
+
+
+/**
+ * @brief called on event thread for each edge of an INPUT pin.
+ */
+void CGPIODriver::onInputEvent (const GPIO_EVENT& event)
+{
+    bool report = false;
+
+    CGPIORecorder::getInstance().record(GPIO_RECORD_EDGE, event.pin_number, event.level);
+
+    // PULSE_INPUT edges are only counted - no lock, no filter, no status per edge.
+    if ((event.pin_number < MAX_GPIO_PINS) && (m_pulse_mask.load(std::memory_order_relaxed) & (1ull << event.pin_number)))
+    {
+        m_pulse.onEdge(event.pin_number, event.level, event.timestamp_ns);
+        return ;
+    }
+
+    if ((event.pin_number < MAX_GPIO_PINS) && (m_encoder_mask.load(std::memory_order_relaxed) & (1ull << event.pin_number)))
+    {
+        m_encoders.onEdge(event.pin_number, event.level);
+        return ;
+    }
+
+    {
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+
+    GPIO* gpio = _getGPIOByNumber(event.pin_number);
+    if ((gpio == nullptr) || (gpio->pin_mode != INPUT)) return ;
 
     #ifdef DEBUG
-        // More detailed debug output
-        std::cout << _INFO_CONSOLE_TEXT << ":writePWM:pin:" << _LOG_CONSOLE_BOLD_TEXT << pin_number
-            << _INFO_CONSOLE_TEXT << ":req_freq:" << _LOG_CONSOLE_BOLD_TEXT << freq // Show potentially adjusted freq
-            << _INFO_CONSOLE_TEXT << ":input_width:" << _LOG_CONSOLE_BOLD_TEXT << pin_pwm_width
-            << _INFO_CONSOLE_TEXT << ":calc_divisor:" << _LOG_CONSOLE_BOLD_TEXT << clock_divisor
-            << _INFO_CONSOLE_TEXT << ":calc_range:" << _LOG_CONSOLE_BOLD_TEXT << pwm_range
-            << _INFO_CONSOLE_TEXT << ":pwm_value:" << _LOG_CONSOLE_BOLD_TEXT << pwm_value
-            << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    std::cout << _INFO_CONSOLE_TEXT << ":onInputEvent:" << _LOG_CONSOLE_BOLD_TEXT << event.pin_number << _INFO_CONSOLE_TEXT << ":level:" << _LOG_CONSOLE_BOLD_TEXT << event.level << _INFO_CONSOLE_TEXT << ":ts:" << _LOG_CONSOLE_BOLD_TEXT << event.timestamp_ns << _NORMAL_CONSOLE_TEXT_ << std::endl;
     #endif
 
-    #ifndef TEST_MODE_NO_WIRINGPI_LINK
-    // --- Apply Settings using WiringPi ---
-    pwmSetMode(PWM_MODE_MS);      // Mark:Space mode is common
-    pwmSetClock(clock_divisor);   // Set the calculated clock divisor
-    pwmSetRange(pwm_range);       // Set the calculated range (resolution)
-    pwmWrite(pin_number, pwm_value); // Set the scaled duty cycle
-    #endif
+    // simulated line follows injected edges so reads agree with them.
+    CGPIOBackendSimulation* simulation = std::get_if<CGPIOBackendSimulation>(&m_backend);
+    if (simulation != nullptr) simulation->setInputLevel(event.pin_number, event.level);
 
-    // Update internal state tracking
-    changeGPIOByNumber (pin_number, freq, pin_pwm_width); // Store original requested values or actuals? Decide based on class needs. Storing requested here.
+    CGPIOInputFilter& filter = m_input_filters[event.pin_number];
 
-    // Success Output - showing actual calculated parameters might be more informative
-    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "PWM set on Pin: " << _INFO_CONSOLE_BOLD_TEXT << pin_number
-              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Target Freq: " << _INFO_CONSOLE_BOLD_TEXT << freq << " Hz" // Show potentially adjusted freq
-              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Actual Range: " << _INFO_CONSOLE_BOLD_TEXT << pwm_range
-              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Input Width: " << _INFO_CONSOLE_BOLD_TEXT << pin_pwm_width
-              << _SUCCESS_CONSOLE_BOLD_TEXT_ << ", Output Value: " << _INFO_CONSOLE_BOLD_TEXT << pwm_value
-              << std::endl;
+    const bool accepted = filter.onEdge(event.level, event.timestamp_ns);
+    
+    if (filter.isEnabled()) updateInputTimer();
 
-    // Add a specific warning if the target frequency of 0.025 Hz was requested but not achieved
-    if (freq < 1.0 && pwm_range == MAX_HW_PWM_RANGE && clock_divisor == MAX_PWM_CLOCK_DIVISOR) { // Heuristic for hitting the low limit
-        double min_achievable = static_cast<double>(baseClock) / (MAX_PWM_CLOCK_DIVISOR * MAX_HW_PWM_RANGE);
-         if (freq > min_achievable * 1.01) { // Check if we are close to the theoretical limit
-             std::cout << _ERROR_CONSOLE_TEXT_ << "Note: Minimum achievable hardware PWM frequency is approx. "
-                       << min_achievable << " Hz. Requested frequency may not be accurately generated." << _NORMAL_CONSOLE_TEXT_ << std::endl;
-         }
+    if (accepted) report = setInputLevel(gpio, filter.getLevel());
     }
+
+    // notified without m_write_mutex - status is sent inline until notifier is started.
+    if (report) CGPIONotifier::getInstance().markChanged(1ull << event.pin_number);
 }
-            
 
-        
-            
\ No newline at end of file
+
+/**
+ * @brief called on event thread when a filter deadline is reached.
+ */
+void CGPIODriver::onInputTimer (const uint64_t now_ns)
+{
+    uint64_t changed_mask = 0;
+
+    {
+    const std::lock_guard<std::recursive_mutex> lock(m_write_mutex);
+    
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        CGPIOInputFilter& filter = m_input_filters[i];
+        const uint64_t deadline = filter.getDeadline();
+        if ((deadline == 0) || (deadline > now_ns)) continue;
+
+        GPIO* gpio = _getGPIOByNumber(i);
+        if ((gpio == nullptr) || (gpio->pin_mode != INPUT)) continue;
+
+        // majority samples are taken here - spaced from the edge, not back to back when it is handled.
+        if (filter.isSampleDue(now_ns) && filter.onSample(readInputLevel(i, filter.getLevel())) && setInputLevel(gpio, filter.getLevel()))
+        {
+            changed_mask |= 1ull << i;
+        }
+
+        if (filter.onTimer(now_ns) && setInputLevel(gpio, filter.getLevel())) changed_mask |= 1ull << i;
+    }
+
+    updateInputTimer();
+    }
+
+    CGPIONotifier::getInstance().markChanged(changed_mask);
+}
+
+
+/**
+ * @brief arm event timer at the nearest filter deadline.
+ */
+void CGPIODriver::updateInputTimer ()
+{
+    uint64_t next_deadline = 0;
+    for (const CGPIOInputFilter& filter : m_input_filters)
+    {
+        const uint64_t deadline = filter.getDeadline();
+        if ((deadline != 0) && ((next_deadline == 0) || (deadline < next_deadline))) next_deadline = deadline;
+    }
+
+    m_input_events.setTimer(next_deadline);
+}
+
+
+/**
+ * @brief set level of an INPUT pin. must be called with m_write_mutex held.
+ * 
+ * @return true if level changed.
+ */
+bool CGPIODriver::setInputLevel (GPIO* gpio, const uint level)
+{
+    if (gpio->pin_value == level) return false;
+
+    gpio->pin_value = level;
+    markDirty(1ull << gpio->pin_number);
+    CGPIORecorder::getInstance().record(GPIO_RECORD_PIN, gpio->pin_number, level, 0, GPIO_RECORD_SOURCE_INPUT);
+    publishPins(1ull << gpio->pin_number);
+
+    return true;
+}
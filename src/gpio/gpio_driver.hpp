@@ -3,10 +3,26 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
+#include <bitset>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 #include "../de_common/helpers/json_nlohmann.hpp"
+#include "gpio_backend.hpp"
+#include "gpio_events.hpp"
+#include "gpio_input_filter.hpp"
+#include "gpio_soft_pwm.hpp"
+#include "gpio_sampler.hpp"
+#include "gpio_pulse.hpp"
+#include "gpio_encoder.hpp"
 using Json_de = nlohmann::json;
 #define MAX_PWM 1024 // The user's desired input scale and preferred PWM range
+#define MAX_GPIO_PINS 54 // Raspberry Pi GPIO pins are 0-53
+#define MAX_PWM_SOLUTIONS 32 // memoized frequency -> (divisor, range) entries
+#define GPIO_DIRTY_LAYOUT (1ull << 63) // dirty mask flag: pins were added, removed or reconfigured
+#define GPIO_STATE_NAME_MAX 44 // pin name chars kept in a GPIO_STATE snapshot
 
 
 namespace de
@@ -21,12 +37,6 @@ typedef enum {
 } ENUM_GPIO_TYPE;
 
 
-#ifdef TEST_MODE_NO_WIRINGPI_LINK
-#define INPUT 0
-#define OUTPUT 1
-#define PWM_OUTPUT 2
-#endif
-
 /**
     * 
     * *    INPUT			        0
@@ -39,6 +49,8 @@ typedef enum {
     * *    SOFT_TONE_OUTPUT	        5
     * *    PWM_TONE_OUTPUT		    6
     * *    PM_OFF		            7   // to input / release line
+    * *    PULSE_INPUT              10  // INPUT with pulse count, frequency & duty
+    * *    ENCODER_INPUT            11  // INPUT that is a channel of a quadrature encoder
     *
 * **/
 typedef struct GPIO{
@@ -48,9 +60,76 @@ typedef struct GPIO{
         uint pin_pwm_width;
         ENUM_GPIO_TYPE gpio_type;
         std::string pin_name;
+        GPIO_INPUT_FILTER input_filter;     // INPUT pins only
     } GPIO;
 
 
+/**
+ * @brief fixed size copy of a GPIO - used in lock-free snapshots.
+ * size is a multiple of 8 so it can be published as atomic 64-bit words.
+ */
+typedef struct GPIO_STATE{
+        uint32_t pin_value;
+        uint32_t pin_pwm_width;
+        uint8_t pin_number;
+        uint8_t pin_mode;
+        uint8_t gpio_type;
+        uint8_t name_length;
+        char pin_name[GPIO_STATE_NAME_MAX];
+    } GPIO_STATE;
+
+static_assert(sizeof(GPIO_STATE) % sizeof(uint64_t) == 0, "GPIO_STATE must be a multiple of 64 bits");
+#define GPIO_STATE_WORDS (sizeof(GPIO_STATE) / sizeof(uint64_t))
+
+
+/**
+ * @brief consistent copy of all pins.
+ * used_mask bit n is set if gpios[n] is a configured pin.
+ */
+typedef struct GPIO_SNAPSHOT{
+        uint64_t used_mask;
+        GPIO_STATE gpios[MAX_GPIO_PINS];
+    } GPIO_SNAPSHOT;
+
+
+/**
+ * @brief clock divisor & range that generate a frequency.
+ * freq is the frequency actually generated.
+ */
+typedef struct PWM_SOLUTION{
+        uint32_t clock_divisor;
+        uint32_t range;
+        double freq;
+    } PWM_SOLUTION;
+
+
+/**
+ * @brief last values written to PWM hardware.
+ */
+typedef struct PWM_CLOCK_STATE{
+        bool valid = false;
+        uint32_t mode = 0;
+        uint32_t clock_divisor = 0;
+    } PWM_CLOCK_STATE;
+
+typedef struct PWM_CHANNEL_STATE{
+        bool valid = false;
+        uint32_t range = 0;
+    } PWM_CHANNEL_STATE;
+
+
+typedef struct PWM_STATS{
+        uint64_t clock_reprograms = 0;
+        uint64_t clock_skipped = 0;
+        uint64_t range_reprograms = 0;
+        uint64_t range_skipped = 0;
+        uint64_t solution_hits = 0;
+        uint64_t solution_misses = 0;
+        uint64_t conflicts = 0;             // writes rejected as frequency cannot share clock with other pins
+    } PWM_STATS;
+
+
+
 class CGPIODriver
     {
         public:
@@ -93,27 +172,196 @@ class CGPIODriver
             void setPinMode (uint pin_number, uint pin_mode);
             int readPin (uint pin_number);
             void writePin (uint pin_number, uint pin_value);
+            void writePinMasks (const uint64_t set_mask, const uint64_t clear_mask);
             void writePWM(const uint pin_number, double freq, uint pin_pwm_width);
+            void writeHardwareMasks (const uint64_t set_mask, const uint64_t clear_mask);
 
             const std::vector<GPIO> getGPIOStatus () const; 
+            const std::vector<GPIO> getGPIOStatus (const uint64_t pin_mask) const; 
+
+            void getGPIOSnapshot (GPIO_SNAPSHOT& snapshot, const uint64_t pin_mask = ~0ull) const;
+            static void toGPIO (const GPIO_STATE& state, GPIO& gpio);
+
+            /**
+             * @brief pins changed since last call - bit n is GPIO n.
+             * GPIO_DIRTY_LAYOUT is set when a full status is needed.
+             */
+            inline uint64_t takeDirtyMask ()
+            {
+                return m_dirty_mask.exchange(0, std::memory_order_acq_rel);
+            }
 
             const GPIO* getGPIOByNumber (uint pin_number) const;
             const GPIO* getGPIOByName (const std::string& pin_name) const;
 
             void changeGPIOByNumber (uint pin_number, uint pin_value, uint pin_pwm_width);
+
+            /**
+             * @brief edge event engine of INPUT pins.
+             * injectEvent can be used to simulate edges without a chip.
+             */
+            inline CGPIOEvents& getInputEvents ()
+            {
+                return m_input_events;
+            }
+
+            /**
+             * @brief periodic sampling of INPUT pins - enabled by "input_sample_hz".
+             */
+            inline CGPIOSampler& getSampler ()
+            {
+                return m_sampler;
+            }
+
+            /**
+             * @brief pulse measurements of PULSE_INPUT pins.
+             */
+            inline CGPIOPulse& getPulse ()
+            {
+                return m_pulse;
+            }
+
+            inline uint64_t getPulseMask () const
+            {
+                return m_pulse_mask.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief quadrature encoders from "encoders" config field.
+             */
+            inline CGPIOEncoder& getEncoders ()
+            {
+                return m_encoders;
+            }
+
+            /**
+             * @brief modes whose pins are read from edge events.
+             */
+            static inline bool isInputMode (const uint pin_mode)
+            {
+                return (pin_mode == INPUT) || (pin_mode == PULSE_INPUT) || (pin_mode == ENCODER_INPUT);
+            }
+
+            /**
+             * @brief counters of the filter of a pin - updated under m_write_mutex, hold it for a consistent copy.
+             */
+            inline const GPIO_INPUT_FILTER_STATS& getInputFilterStats (const uint pin_number) const
+            {
+                return m_input_filters[pin_number % MAX_GPIO_PINS].getStats();
+            }
+
+            inline const PWM_STATS& getPWMStats () const
+            {
+                return m_pwm_stats;
+            }
+
+            inline SOFT_PWM_STATS getSoftPWMStats () const
+            {
+                return m_soft_pwm.getStats();
+            }
+
+            inline const char* getBackendName () const
+            {
+                return std::visit([](const auto& backend){ return backend.getName(); }, m_backend);
+            }
+
+            /**
+             * @brief pin levels & PWM registers when running without hardware, nullptr otherwise.
+             */
+            inline const CGPIOBackendSimulation* getSimulation () const
+            {
+                return std::get_if<CGPIOBackendSimulation>(&m_backend);
+            }
             
             
         private:
 
             void removeGPIOByNumber (uint pin_number);
+            bool initBackendFromConfigFile();
             bool initGPIOFromConfigFile();
+            bool initEncodersFromConfigFile();
 
             GPIO* _getGPIOByNumber (uint pin_number) const;
             GPIO* _getGPIOByName (const std::string& pin_name) const;
 
+            static int getPWMChannel (const uint pin_number);
+            bool selectPWMSolution (const uint pin_number, const double freq, PWM_SOLUTION& solution);
+            void rescalePWMPins (const uint pin_number, const uint32_t pwm_range);
+            const PWM_SOLUTION& getPWMSolution (const double freq);
+            PWM_SOLUTION computePWMSolution (double freq) const;
+            void applyPWMClock (const uint pin_number, const uint32_t mode, const uint32_t clock_divisor, const uint32_t pwm_range);
+            void invalidatePWMCache ();
+            void writeSoftPWM (const uint pin_number, const double freq, uint pin_pwm_width);
+
+            inline void markDirty (const uint64_t mask)
+            {
+                m_dirty_mask.fetch_or(mask, std::memory_order_release);
+            }
+
+            void publishPins (const uint64_t pin_mask);
+
+            void updateInputEvents ();
+            void onInputEvent (const GPIO_EVENT& event);
+            void onInputTimer (const uint64_t now_ns);
+            void updateInputTimer ();
+            uint readInputLevel (const uint pin_number, const uint level);
+            bool readInputLevels (uint64_t& levels);
+            bool setInputLevel (GPIO* gpio, const uint level);
+
         private:
 
-            std::vector<GPIO> m_gpio_array;
+            // pin registry indexed by BCM number. Slots never move so returned pointers stay valid.
+            std::array<GPIO, MAX_GPIO_PINS> m_gpio_slots;
+            std::bitset<MAX_GPIO_PINS> m_gpio_used;
+            // pin_name -> BCM number
+            std::unordered_map<std::string, uint> m_gpio_name_index;
+
+            // pin registry is changed by receive and input event threads.
+            // readers use getGPIOSnapshot and never take this lock.
+            std::recursive_mutex m_write_mutex;
+
+            // seqlock protected copy of m_gpio_slots - even sequence means stable.
+            std::atomic<uint32_t> m_snapshot_seq {0};
+            std::atomic<uint64_t> m_snapshot_used {0};
+            std::array<std::array<std::atomic<uint64_t>, GPIO_STATE_WORDS>, MAX_GPIO_PINS> m_snapshot_words;
+
+            // pins changed since last status publish.
+            std::atomic<uint64_t> m_dirty_mask {0};
+
+            // PWM hardware state cache - BCM PWM clock is shared by both channels.
+            PWM_CLOCK_STATE m_pwm_clock;
+            PWM_CHANNEL_STATE m_pwm_channel[2];
+            std::unordered_map<double, PWM_SOLUTION> m_pwm_solutions;
+            PWM_STATS m_pwm_stats;
+            // relative frequency error accepted so pins can share the PWM clock - "pwm_freq_tolerance" in percent.
+            double m_pwm_freq_tolerance = 0.01;
+
+            // edge events of INPUT pins - started after pins are configured from config file.
+            CGPIOEvents m_input_events;
+            std::string m_gpio_chip = "/dev/gpiochip0";
+            bool m_input_events_enabled = false;
+            // debounce & glitch filters of INPUT pins - used under m_write_mutex by the event thread
+            // (edges & timer) and by configuring threads (configurePort, updateInputEvents).
+            std::array<CGPIOInputFilter, MAX_GPIO_PINS> m_input_filters;
+
+            // SOFT_PWM_OUTPUT pins.
+            CGPIOSoftPWM m_soft_pwm;
+            // pins whose write at a foreign frequency was already reported.
+            std::bitset<MAX_GPIO_PINS> m_soft_pwm_rejected;
+
+            // PULSE_INPUT pins - edges of these pins bypass filters and m_write_mutex.
+            CGPIOPulse m_pulse;
+            std::atomic<uint64_t> m_pulse_mask {0};
+
+            // ENCODER_INPUT pins - edges of these pins bypass filters and m_write_mutex.
+            CGPIOEncoder m_encoders;
+            std::atomic<uint64_t> m_encoder_mask {0};
+
+            // periodic samples of INPUT pins - restarted with edge events when INPUT pins change.
+            CGPIOSampler m_sampler;
+
+            // hardware access policy selected by "gpio_backend".
+            GPIO_BACKEND m_backend;
 
             // Base clock frequency for Raspberry Pi PWM (adjust if different)
             const uint32_t baseClock = 19200000;
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <time.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_encoder.hpp"
+
+
+using namespace de::gpio;
+
+
+// step of a transition indexed by old_ab << 2 | new_ab. A leading B counts up: 00 -> 10 -> 11 -> 01 -> 00.
+// an unchanged state or both channels changed means edges were lost.
+const int8_t CGPIOEncoder::s_transitions[16] = {
+     2, -1,  1,  2,
+     1,  2,  2, -1,
+    -1,  2,  2,  1,
+     2,  1, -1,  2
+};
+
+
+static inline uint64_t monotonic_ns ()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
+
+
+/**
+ * @brief add encoder. must be called before its pins get edge events.
+ * @return encoder index or -1.
+ */
+int CGPIOEncoder::addEncoder (const GPIO_ENCODER& encoder)
+{
+    const uint pins[3] = {encoder.pin_a, encoder.pin_b, encoder.pin_index};
+
+    if (m_count >= GPIO_ENCODER_MAX)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: at most " << GPIO_ENCODER_MAX << " encoders are supported." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return -1;
+    }
+
+    for (uint channel = 0; channel < 3; ++channel)
+    {
+        const uint pin = pins[channel];
+        if ((channel == GPIO_ENCODER_CHANNEL_INDEX) && (pin == GPIO_ENCODER_NO_PIN)) continue;
+
+        if ((pin >= GPIO_ENCODER_PINS) || (m_pin_encoder[pin] != GPIO_ENCODER_NO_PIN)
+            || ((channel > 0) && (pin == pins[0])) || ((channel > 1) && (pin == pins[1])))
+        {
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: encoder " << encoder.name << " pin " << pin << " is invalid or already used." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            return -1;
+        }
+    }
+
+    const uint encoder_index = m_count;
+    m_encoders[encoder_index] = encoder;
+    for (uint channel = 0; channel < 3; ++channel)
+    {
+        if (pins[channel] == GPIO_ENCODER_NO_PIN) continue;
+        m_pin_encoder[pins[channel]] = encoder_index;
+        m_pin_channel[pins[channel]] = channel;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_readers[encoder_index] = ENCODER_READER();
+        const uint64_t now_ns = monotonic_ns();
+        for (ENCODER_WINDOW& window : m_readers[encoder_index].windows) window.last_read_ns = now_ns;
+    }
+
+    ++m_count;
+
+    return encoder_index;
+}
+
+
+/**
+ * @brief remove all encoders. must be called while their pins have no edge events.
+ */
+void CGPIOEncoder::clear ()
+{
+    m_pin_encoder.fill(GPIO_ENCODER_NO_PIN);
+    for (ENCODER_STATE& state : m_states)
+    {
+        state.position = 0;
+        state.errors = 0;
+        state.index_count = 0;
+        state.index_position = 0;
+        state.travel = 0;
+        state.ab = 0;
+    }
+    m_count = 0;
+}
+
+
+/**
+ * @brief initial level of a channel - read when edge events of the pin start.
+ */
+void CGPIOEncoder::setLevel (const uint pin_number, const uint level)
+{
+    if ((pin_number >= GPIO_ENCODER_PINS) || (m_pin_encoder[pin_number] == GPIO_ENCODER_NO_PIN)) return ;
+
+    const uint8_t channel = m_pin_channel[pin_number];
+    if (channel == GPIO_ENCODER_CHANNEL_INDEX) return ;
+
+    ENCODER_STATE& state = m_states[m_pin_encoder[pin_number]];
+    const uint8_t bit = (channel == GPIO_ENCODER_CHANNEL_A) ? 2 : 1;
+    state.ab = level ? (state.ab | bit) : (state.ab & ~bit);
+}
+
+
+/**
+ * @brief position, velocity since previous call of the same reader & error counters of an encoder.
+ * @param reader GPIO_ENCODER_READER_REPORT or GPIO_ENCODER_READER_REQUEST.
+ */
+bool CGPIOEncoder::getStatus (const uint encoder, ENCODER_STATUS& status, const uint reader)
+{
+    if ((encoder >= m_count) || (reader >= GPIO_ENCODER_READERS)) return false;
+
+    ENCODER_COUNTERS counters;
+    readState(encoder, counters);
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    ENCODER_READER& encoder_reader = m_readers[encoder];
+    // index pulse zeroed the position after zero() - the offset no longer applies.
+    if (m_encoders[encoder].index_reset && (counters.index_count != encoder_reader.offset_index_count))
+    {
+        encoder_reader.offset = 0;
+        encoder_reader.offset_index_count = counters.index_count;
+    }
+
+    ENCODER_WINDOW& window = encoder_reader.windows[reader];
+    const uint64_t now_ns = monotonic_ns();
+    const double elapsed_sec = (now_ns - window.last_read_ns) / 1e9;
+
+    status.encoder = encoder;
+    status.name = m_encoders[encoder].name;
+    status.position = counters.position - encoder_reader.offset;
+    status.velocity = (elapsed_sec <= 0.0) ? 0.0 : (counters.travel - window.last_travel) / elapsed_sec;
+    status.errors = counters.errors;
+    status.index_count = counters.index_count;
+    status.index_position = counters.index_position - encoder_reader.offset;
+
+    window.last_travel = counters.travel;
+    window.last_read_ns = now_ns;
+
+    return true;
+}
+
+
+void CGPIOEncoder::getStatus (std::vector<ENCODER_STATUS>& status, const uint reader)
+{
+    status.resize(m_count);
+    for (uint i = 0; i < m_count; ++i)
+    {
+        getStatus(i, status[i], reader);
+    }
+}
+
+
+/**
+ * @brief current position becomes 0.
+ */
+bool CGPIOEncoder::zero (const uint encoder)
+{
+    if (encoder >= m_count) return false;
+
+    ENCODER_COUNTERS counters;
+    readState(encoder, counters);
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_readers[encoder].offset = counters.position;
+    m_readers[encoder].offset_index_count = counters.index_count;
+
+    return true;
+}
+
+
+int CGPIOEncoder::findEncoder (const std::string& name) const
+{
+    for (uint i = 0; i < m_count; ++i)
+    {
+        if (m_encoders[i].name == name) return i;
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief consistent copy of counters - retried while event thread updates them.
+ */
+void CGPIOEncoder::readState (const uint encoder, ENCODER_COUNTERS& counters) const
+{
+    const ENCODER_STATE& state = m_states[encoder];
+
+    while (true)
+    {
+        const uint32_t seq = state.seq.load(std::memory_order_acquire);
+        if (seq & 1) continue;
+
+        counters.position = state.position.load(std::memory_order_acquire);
+        counters.errors = state.errors.load(std::memory_order_acquire);
+        counters.index_count = state.index_count.load(std::memory_order_acquire);
+        counters.index_position = state.index_position.load(std::memory_order_acquire);
+        counters.travel = state.travel.load(std::memory_order_acquire);
+
+        if (state.seq.load(std::memory_order_relaxed) == seq) return ;
+    }
+}
@@ -0,0 +1,216 @@
+#ifndef GPIO_ENCODER_H_
+#define GPIO_ENCODER_H_
+
+#include <cstdint>
+#include <string>
+#include <array>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <sys/types.h>
+
+
+#ifndef ENCODER_INPUT
+#define ENCODER_INPUT 11 // pin mode: INPUT that is a channel of a quadrature encoder
+#endif
+
+#define GPIO_ENCODER_MAX 8
+#define GPIO_ENCODER_PINS 54
+#define GPIO_ENCODER_NO_PIN 0xFF
+
+// channel of a pin in its encoder
+#define GPIO_ENCODER_CHANNEL_A      0
+#define GPIO_ENCODER_CHANNEL_B      1
+#define GPIO_ENCODER_CHANNEL_INDEX  2
+
+// readers of encoder status - each has its own velocity window.
+#define GPIO_ENCODER_READER_REPORT  0   // periodic "encoder_report"
+#define GPIO_ENCODER_READER_REQUEST 1   // status requested by a command
+#define GPIO_ENCODER_READERS        2
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief encoder as defined in "encoders" config field.
+     */
+    typedef struct GPIO_ENCODER{
+            std::string name;
+            uint pin_a;
+            uint pin_b;
+            uint pin_index = GPIO_ENCODER_NO_PIN;
+            bool index_reset = false;       // position is zeroed on each index pulse
+        } GPIO_ENCODER;
+
+
+    typedef struct ENCODER_STATUS{
+            uint encoder;
+            std::string name;
+            int64_t position;               // counts - four per encoder line
+            double velocity;                // counts per second since previous status of the same reader
+            uint64_t errors;                // illegal transitions - edges were lost
+            uint64_t index_count;
+            int64_t index_position;         // position at last index pulse
+        } ENCODER_STATUS;
+
+
+    /**
+     * @brief Quadrature decoding of ENCODER_INPUT pins.
+     *
+     * Edges come from the edge event thread. Each edge updates the A/B state of its encoder and
+     * the transition is looked up in a 16 entry table - no branches on direction.
+     * An edge that leaves the state unchanged means an edge of the other channel was lost,
+     * it is counted as an error.
+     *
+     * Counters are written by the event thread only and copied by readers through a sequence number.
+     * Zeroing is an offset kept by readers so the event thread stays the single writer. Velocity uses
+     * travel, which index resets do not clear, so it stays continuous across index pulses.
+     */
+    class CGPIOEncoder
+    {
+        public:
+
+            CGPIOEncoder()
+            {
+                m_pin_encoder.fill(GPIO_ENCODER_NO_PIN);
+            }
+
+            CGPIOEncoder(CGPIOEncoder const&)          = delete;
+            void operator=(CGPIOEncoder const&)       = delete;
+
+        public:
+
+            int addEncoder (const GPIO_ENCODER& encoder);
+            void clear ();
+
+            inline size_t getCount () const
+            {
+                return m_count;
+            }
+
+            void setLevel (const uint pin_number, const uint level);
+
+            /**
+             * @brief edge of an ENCODER_INPUT pin - event thread only.
+             */
+            inline void onEdge (const uint pin_number, const uint level)
+            {
+                if (pin_number >= GPIO_ENCODER_PINS) return ;
+
+                const uint8_t encoder_index = m_pin_encoder[pin_number];
+                if (encoder_index == GPIO_ENCODER_NO_PIN) return ;
+
+                ENCODER_STATE& state = m_states[encoder_index];
+                const uint8_t channel = m_pin_channel[pin_number];
+
+                const uint32_t seq = state.seq.load(std::memory_order_relaxed);
+                state.seq.store(seq + 1, std::memory_order_relaxed);
+
+                if (channel == GPIO_ENCODER_CHANNEL_INDEX)
+                {
+                    if (level)
+                    {
+                        const int64_t position = state.position.load(std::memory_order_relaxed);
+                        state.index_position.store(position, std::memory_order_release);
+                        state.index_count.store(state.index_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                        if (m_encoders[encoder_index].index_reset) state.position.store(0, std::memory_order_release);
+                    }
+                }
+                else
+                {
+                    // state is A << 1 | B
+                    const uint8_t bit = (channel == GPIO_ENCODER_CHANNEL_A) ? 2 : 1;
+                    const uint8_t old_ab = state.ab;
+                    const uint8_t new_ab = level ? (old_ab | bit) : (old_ab & ~bit);
+                    const int8_t step = s_transitions[(old_ab << 2) | new_ab];
+
+                    if (step == GPIO_ENCODER_ILLEGAL)
+                    {
+                        state.errors.store(state.errors.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                    }
+                    else
+                    {
+                        state.position.store(state.position.load(std::memory_order_relaxed) + step, std::memory_order_release);
+                        state.travel.store(state.travel.load(std::memory_order_relaxed) + step, std::memory_order_release);
+                    }
+                    state.ab = new_ab;
+                }
+
+                state.seq.store(seq + 2, std::memory_order_release);
+            }
+
+            bool getStatus (const uint encoder, ENCODER_STATUS& status, const uint reader);
+            void getStatus (std::vector<ENCODER_STATUS>& status, const uint reader);
+            bool zero (const uint encoder);
+            int findEncoder (const std::string& name) const;
+
+        private:
+
+            static constexpr int8_t GPIO_ENCODER_ILLEGAL = 2;
+            static const int8_t s_transitions[16];
+
+            /**
+             * @brief counters of one encoder - odd seq means event thread is updating them.
+             */
+            typedef struct ENCODER_STATE{
+                    std::atomic<uint32_t> seq {0};
+                    std::atomic<int64_t> position {0};
+                    std::atomic<uint64_t> errors {0};
+                    std::atomic<uint64_t> index_count {0};
+                    std::atomic<int64_t> index_position {0};
+                    std::atomic<int64_t> travel {0};        // position without index resets
+                    uint8_t ab = 0;                 // event thread only
+                } ENCODER_STATE;
+
+            /**
+             * @brief copy of ENCODER_STATE counters.
+             */
+            typedef struct ENCODER_COUNTERS{
+                    int64_t position;
+                    uint64_t errors;
+                    uint64_t index_count;
+                    int64_t index_position;
+                    int64_t travel;
+                } ENCODER_COUNTERS;
+
+            /**
+             * @brief travel & time of previous status of one reader.
+             */
+            typedef struct ENCODER_WINDOW{
+                    int64_t last_travel = 0;
+                    uint64_t last_read_ns = 0;
+                } ENCODER_WINDOW;
+
+            /**
+             * @brief reader side - zero offset and velocity window of each reader.
+             * offset_index_count is index_count when offset was taken - an index reset after it clears the offset.
+             */
+            typedef struct ENCODER_READER{
+                    int64_t offset = 0;
+                    uint64_t offset_index_count = 0;
+                    std::array<ENCODER_WINDOW, GPIO_ENCODER_READERS> windows;
+                } ENCODER_READER;
+
+            void readState (const uint encoder, ENCODER_COUNTERS& counters) const;
+
+        private:
+
+            std::array<GPIO_ENCODER, GPIO_ENCODER_MAX> m_encoders;
+            size_t m_count = 0;
+            std::array<ENCODER_STATE, GPIO_ENCODER_MAX> m_states;
+
+            // pin -> encoder & channel. written while pins have no edge events.
+            std::array<uint8_t, GPIO_ENCODER_PINS> m_pin_encoder;
+            std::array<uint8_t, GPIO_ENCODER_PINS> m_pin_channel = {};
+
+            std::mutex m_mutex;
+            std::array<ENCODER_READER, GPIO_ENCODER_MAX> m_readers;
+    };
+
+}
+}
+
+#endif
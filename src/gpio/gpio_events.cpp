@@ -0,0 +1,286 @@
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <linux/gpio.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_events.hpp"
+
+
+using namespace de::gpio;
+
+
+/**
+ * @brief start edge detection on pins and the event thread.
+ * If the chip cannot be opened the thread still runs so injected events are delivered.
+ *
+ * @param chip_path /dev/gpiochip0
+ * @param pin_mask bit n is GPIO n.
+ * @param handler called on event thread for each edge.
+ * @param timer_handler called on event thread when time set by setTimer is reached.
+ * @return false if the epoll/eventfd could not be created.
+ */
+bool CGPIOEvents::start(const std::string& chip_path, const uint64_t pin_mask, EVENT_HANDLER handler, TIMER_HANDLER timer_handler)
+{
+    stop();
+
+    m_handler = handler;
+    m_timer_handler = timer_handler;
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    m_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if ((m_epoll_fd < 0) || (m_event_fd < 0) || (m_timer_fd < 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to create GPIO event poll: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        stop();
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_event_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_event_fd, &ev);
+    ev.data.fd = m_timer_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_timer_fd, &ev);
+
+    if ((pin_mask != 0) && requestLines(chip_path, pin_mask))
+    {
+        ev.events = EPOLLIN;
+        ev.data.fd = m_line_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_line_fd, &ev);
+    }
+
+    m_requested_mask = pin_mask;
+    m_exit_thread = false;
+    m_thread = std::thread{[&](){ loopEvents(); }};
+
+    return true;
+}
+
+
+void CGPIOEvents::stop()
+{
+    if (m_thread.joinable())
+    {
+        m_exit_thread = true;
+        const uint64_t one = 1;
+        if (write(m_event_fd, &one, sizeof(one)) < 0) { /* thread exits on next event anyway */ }
+        m_thread.join();
+    }
+
+    if (m_line_fd >= 0) { close(m_line_fd); m_line_fd = -1; }
+    if (m_timer_fd >= 0) { close(m_timer_fd); m_timer_fd = -1; }
+    if (m_event_fd >= 0) { close(m_event_fd); m_event_fd = -1; }
+    if (m_epoll_fd >= 0) { close(m_epoll_fd); m_epoll_fd = -1; }
+
+    m_pin_mask = 0;
+    m_requested_mask = 0;
+    m_last_seqno = 0;
+}
+
+
+/**
+ * @brief arm timer at an absolute CLOCK_MONOTONIC time. 0 disarms.
+ */
+void CGPIOEvents::setTimer(const uint64_t deadline_ns)
+{
+    if (m_timer_fd < 0) return ;
+
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = deadline_ns / 1000000000ull;
+    spec.it_value.tv_nsec = deadline_ns % 1000000000ull;
+    
+    timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+
+/**
+ * @brief deliver an event as if it came from the chip.
+ * timestamp is taken from caller so latency can be measured.
+ */
+bool CGPIOEvents::injectEvent(const GPIO_EVENT& event)
+{
+    if (!isRunning()) return false;
+
+    {
+        const std::lock_guard<std::mutex> lock(m_injected_mutex);
+        m_injected.push_back(event);
+    }
+
+    const uint64_t one = 1;
+    return write(m_event_fd, &one, sizeof(one)) == sizeof(one);
+}
+
+
+/**
+ * @brief current levels of requested lines.
+ *
+ * @param levels bit n is level of GPIO n.
+ */
+bool CGPIOEvents::readLevels(uint64_t& levels) const
+{
+    levels = 0;
+    if (m_line_fd < 0) return false;
+
+    struct gpio_v2_line_values values = {};
+    values.mask = (1ull << __builtin_popcountll(m_pin_mask)) - 1;
+    if (__builtin_popcountll(m_pin_mask) == 64) values.mask = ~0ull;
+
+    if (ioctl(m_line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) return false;
+
+    // bits in values are in order of requested lines.
+    uint idx = 0;
+    for (uint pin = 0; pin < 64; ++pin)
+    {
+        if (!(m_pin_mask & (1ull << pin))) continue;
+        if (values.bits & (1ull << idx)) levels |= (1ull << pin);
+        ++idx;
+    }
+
+    return true;
+}
+
+
+bool CGPIOEvents::requestLines(const std::string& chip_path, const uint64_t pin_mask)
+{
+    const int chip_fd = open(chip_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (chip_fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open GPIO chip " << chip_path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    struct gpio_v2_line_request request = {};
+    for (uint pin = 0; pin < 64; ++pin)
+    {
+        if (!(pin_mask & (1ull << pin))) continue;
+        if (request.num_lines >= GPIO_V2_LINES_MAX) break;
+        request.offsets[request.num_lines++] = pin;
+    }
+
+    strncpy(request.consumer, "de_rpi_gpio", GPIO_MAX_NAME_SIZE - 1);
+    // pulse inputs may run at tens of kHz.
+    request.event_buffer_size = GPIO_EVENTS_KERNEL_BUFFER;
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT
+                         | GPIO_V2_LINE_FLAG_EDGE_RISING
+                         | GPIO_V2_LINE_FLAG_EDGE_FALLING
+                         | GPIO_V2_LINE_FLAG_BIAS_PULL_UP;   // same pull as setPinMode for INPUT
+
+    const int res = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &request);
+    close(chip_fd);
+
+    if (res < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to request GPIO lines for edge events: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    m_line_fd = request.fd;
+    m_pin_mask = pin_mask;
+
+    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "GPIO edge events enabled on " << _INFO_CONSOLE_BOLD_TEXT << request.num_lines
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << " input pins" << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    return true;
+}
+
+
+void CGPIOEvents::loopEvents()
+{
+    struct epoll_event events[3];
+
+    while (!m_exit_thread)
+    {
+        const int count = epoll_wait(m_epoll_fd, events, 3, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR) continue;
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: GPIO event poll failed: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            return ;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.fd == m_line_fd)
+            {
+                readLineEvents();
+            }
+            else if (events[i].data.fd == m_timer_fd)
+            {
+                readTimer();
+            }
+            else
+            {
+                readInjectedEvents();
+            }
+        }
+    }
+}
+
+
+void CGPIOEvents::readLineEvents()
+{
+    struct gpio_v2_line_event line_events[GPIO_EVENTS_MAX_BATCH];
+
+    const ssize_t len = read(m_line_fd, line_events, sizeof(line_events));
+    if (len <= 0) return ;
+
+    const size_t count = static_cast<size_t>(len) / sizeof(struct gpio_v2_line_event);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const struct gpio_v2_line_event& line_event = line_events[i];
+
+        if ((m_last_seqno != 0) && (line_event.seqno > m_last_seqno + 1))
+        {
+            m_stats.lost += line_event.seqno - m_last_seqno - 1;
+        }
+        m_last_seqno = line_event.seqno;
+        m_stats.events++;
+
+        const GPIO_EVENT event = {
+            line_event.offset,
+            (line_event.id == GPIO_V2_LINE_EVENT_RISING_EDGE) ? 1u : 0u,
+            line_event.timestamp_ns
+        };
+
+        if (m_handler) m_handler(event);
+    }
+}
+
+
+void CGPIOEvents::readInjectedEvents()
+{
+    uint64_t counter;
+    if (read(m_event_fd, &counter, sizeof(counter)) < 0) { /* EAGAIN - nothing pending */ }
+
+    std::vector<GPIO_EVENT> injected;
+    {
+        const std::lock_guard<std::mutex> lock(m_injected_mutex);
+        injected.swap(m_injected);
+    }
+
+    for (const GPIO_EVENT& event : injected)
+    {
+        m_stats.injected++;
+        if (m_handler) m_handler(event);
+    }
+}
+
+
+void CGPIOEvents::readTimer()
+{
+    uint64_t expirations;
+    if (read(m_timer_fd, &expirations, sizeof(expirations)) < 0) return ;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (m_timer_handler) m_timer_handler(static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec);
+}
@@ -0,0 +1,144 @@
+#ifndef GPIO_EVENTS_H_
+#define GPIO_EVENTS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <sys/types.h>
+
+
+#define GPIO_EVENTS_MAX_BATCH       64   // events read from kernel per read()
+#define GPIO_EVENTS_KERNEL_BUFFER   1024 // events kernel keeps while event thread is late - kernel maximum
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief an edge on an input pin.
+     *
+     */
+    typedef struct GPIO_EVENT{
+            uint pin_number;
+            uint level;             // level after the edge: 1 rising, 0 falling
+            uint64_t timestamp_ns;  // kernel CLOCK_MONOTONIC timestamp of the edge
+        } GPIO_EVENT;
+
+
+    typedef struct GPIO_EVENTS_STATS{
+            uint64_t events = 0;        // edges received from kernel
+            uint64_t injected = 0;      // edges received from injectEvent
+            uint64_t lost = 0;          // edges dropped by kernel FIFO overflow (sequence gaps)
+        } GPIO_EVENTS_STATS;
+
+
+    /**
+     * @brief Edge event engine based on GPIO character device uAPI v2.
+     *
+     * * Input lines are requested with rising & falling edge detection.
+     * * A dedicated thread waits on the line request fd with epoll - no polling.
+     * * An eventfd registered in the same epoll is used to stop the thread and to
+     *   inject events, so the engine can be exercised without a real chip.
+     * * A timerfd lets handlers ask for a call back at an absolute CLOCK_MONOTONIC time.
+     *
+     */
+    class CGPIOEvents
+    {
+        public:
+
+            typedef std::function<void(const GPIO_EVENT&)> EVENT_HANDLER;
+            typedef std::function<void(const uint64_t now_ns)> TIMER_HANDLER;
+
+        public:
+
+            CGPIOEvents()
+            {
+
+            }
+
+            CGPIOEvents(CGPIOEvents const&)              = delete;
+            void operator=(CGPIOEvents const&)          = delete;
+
+            ~CGPIOEvents ()
+            {
+                stop();
+            }
+
+        public:
+
+            bool start (const std::string& chip_path, const uint64_t pin_mask, EVENT_HANDLER handler, TIMER_HANDLER timer_handler);
+            void stop ();
+
+            void setTimer (const uint64_t deadline_ns);
+
+            bool injectEvent (const GPIO_EVENT& event);
+            bool readLevels (uint64_t& levels) const;
+
+            inline bool isRunning () const
+            {
+                return m_thread.joinable();
+            }
+
+            /**
+             * @brief pins that have edge detection active on the chip.
+             */
+            inline uint64_t getPinMask () const
+            {
+                return m_pin_mask;
+            }
+
+            /**
+             * @brief pins passed to start - also kept when their lines could not be requested,
+             * so callers do not retry a failing request on every configuration.
+             */
+            inline uint64_t getRequestedMask () const
+            {
+                return m_requested_mask;
+            }
+
+            inline const GPIO_EVENTS_STATS& getStats () const
+            {
+                return m_stats;
+            }
+
+        private:
+
+            bool requestLines (const std::string& chip_path, const uint64_t pin_mask);
+            void loopEvents ();
+            void readLineEvents ();
+            void readInjectedEvents ();
+            void readTimer ();
+
+        private:
+
+            int m_epoll_fd = -1;
+            int m_event_fd = -1;
+            int m_line_fd = -1;
+            int m_timer_fd = -1;
+
+            uint64_t m_pin_mask = 0;
+            uint64_t m_requested_mask = 0;
+            uint64_t m_last_seqno = 0;
+
+            std::thread m_thread;
+            std::atomic<bool> m_exit_thread {true};
+
+            EVENT_HANDLER m_handler;
+            TIMER_HANDLER m_timer_handler;
+
+            std::mutex m_injected_mutex;
+            std::vector<GPIO_EVENT> m_injected;
+
+            GPIO_EVENTS_STATS m_stats;
+    };
+
+}
+}
+
+#endif
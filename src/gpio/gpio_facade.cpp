@@ -1,121 +1,493 @@
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 #include "../de_common/helpers/colors.hpp"
 #include "../de_common/helpers/helpers.hpp"
 #include "../defines.hpp"
-#ifdef TEST_MODE_NO_WIRINGPI_LINK
-
-#else
-#include <wiringPi.h>
-#endif
-
 #include "../de_common/helpers/helpers.hpp"
+#include "gpio_protocol.hpp"
 #include "gpio_facade.hpp"
 #include "gpio_driver.hpp"
 #include "gpio_main.hpp"
+#include "gpio_latency.hpp"
+#include "gpio_actuator.hpp"
 using namespace de::gpio;
 
 de::gpio::CGPIOMain& m_cGPIOMain = de::gpio::CGPIOMain::getInstance();
 
 
 void CGPIO_Facade::API_sendGPIOStatus(const std::string&target_party_id, const bool internal) const
+{
+    API_sendGPIOStatus(target_party_id, ~0ull, internal);
+}
+
+
+/**
+ * @brief send status of configured pins in pin_mask.
+ * pins are read from a driver snapshot so writers are never blocked.
+ */
+void CGPIO_Facade::API_sendGPIOStatus(const std::string&target_party_id, const uint64_t pin_mask, const bool internal) const
 {
     CGPIODriver& cGPIODriver  = CGPIODriver::getInstance();
     
-    const std::vector<GPIO> gpios = cGPIODriver.getGPIOStatus();
-    
-    // Create a JSON array
-    Json_de json_array = Json_de::array();
+    const std::lock_guard<std::mutex> lock(m_status_mutex);
+
+    cGPIODriver.getGPIOSnapshot(m_snapshot, pin_mask);
+
+    size_t count = 0;
+    for (uint i = 0; i < MAX_GPIO_PINS; ++i)
+    {
+        if (!(m_snapshot.used_mask & (1ull << i))) continue;
+        CGPIODriver::toGPIO(m_snapshot.gpios[i], m_snapshot_gpios[count++]);
+    }
+
+    sendStatusLocked(target_party_id, m_snapshot_gpios.data(), count, internal);
+}
 
 
-    for (size_t i = 0; i < gpios.size(); ++i) {
-        const GPIO& gpio = gpios[i];
+void CGPIO_Facade::API_sendSingleGPIOStatus(const std::string&target_party_id, const GPIO& gpio, const bool internal) const
+{
+    sendStatus(target_party_id, &gpio, 1, internal);
+}
+
 
-        Json_de json_gpio = {
+/**
+ * @brief command latency percentiles since last report.
+ * sent only if commands were received in that interval.
+ */
+void CGPIO_Facade::API_sendLatencyReport(const std::string&target_party_id, const bool internal) const
+{
+    const Json_de report = CGPIOLatency::getInstance().getReport();
+    if (report.empty()) return ;
+
+    const Json_de message_cmd = 
+        {
+            {"a", GPIO_ACTION_LATENCY_INFO},
             {"i", m_cGPIOMain.getModuleKey()},
-            {"p", gpio.pin_number},
-            {"b", gpio.pin_number},
-            {"m", gpio.pin_mode},
-            {"t", gpio.gpio_type},
-            {"d", gpio.pin_pwm_width},
-            {"v", gpio.pin_value}
+            {"l", report}
         };
-        
-        
-        if (!gpio.pin_name.empty())
+
+    #ifdef DEBUG
+        std::cout << "API_sendLatencyReport:" << message_cmd.dump() << std::endl;
+    #endif
+
+    m_module.sendJMSG (target_party_id, message_cmd, TYPE_AndruavMessage_GPIO_STATUS, internal);
+}
+
+
+/**
+ * @brief per pin summary of input samples since last call - raw samples stay on device.
+ * "d" duty 0..1, "r" level changes per second, "c" msec since last change or -1.
+ */
+void CGPIO_Facade::API_sendInputSampling(const std::string&target_party_id, const bool internal) const
+{
+    CGPIOSampler& sampler = CGPIODriver::getInstance().getSampler();
+    if (!sampler.isRunning()) return ;
+
+    std::vector<SAMPLER_PIN_SUMMARY> summary;
+    const size_t samples = sampler.takeSummary(summary);
+    const SAMPLER_STATS stats = sampler.getStats();
+
+    Json_de pins = Json_de::array();
+    for (const SAMPLER_PIN_SUMMARY& pin : summary)
+    {
+        pins.push_back({
+            {"p", pin.pin_number},
+            {"v", pin.level},
+            {"d", std::round(pin.duty * 1000.0) / 1000.0},
+            {"r", std::round(pin.toggle_rate * 100.0) / 100.0},
+            {"c", (pin.since_change_ns < 0) ? -1 : pin.since_change_ns / 1000000}
+        });
+    }
+
+    const Json_de message_cmd = 
         {
-            json_gpio["n"] =  gpio.pin_name;
-        }
-        
-        if (gpio.pin_mode == PWM_OUTPUT)
+            {"a", GPIO_ACTION_SAMPLING_INFO},
+            {"i", m_cGPIOMain.getModuleKey()},
+            {"h", sampler.getRate()},
+            {"n", samples},
+            {"m", stats.missed_samples},
+            {"s", pins}
+        };
+
+    #ifdef DEBUG
+        std::cout << "API_sendInputSampling:" << message_cmd.dump() << std::endl;
+    #endif
+
+    m_module.sendJMSG (target_party_id, message_cmd, TYPE_AndruavMessage_GPIO_STATUS, internal);
+}
+
+
+/**
+ * @brief pulse count, frequency & duty of PULSE_INPUT pins since last call.
+ * "c" total pulses, "n" pulses in interval, "f" Hz, "d" duty 0..1, "w" mean pulse width in usec.
+ */
+void CGPIO_Facade::API_sendPulseStatus(const std::string&target_party_id, const bool internal) const
+{
+    CGPIODriver& cGPIODriver = CGPIODriver::getInstance();
+    const uint64_t pulse_mask = cGPIODriver.getPulseMask();
+    if (pulse_mask == 0) return ;
+
+    std::vector<PULSE_MEASUREMENT> measurements;
+    cGPIODriver.getPulse().takeMeasurements(pulse_mask, measurements);
+
+    Json_de pins = Json_de::array();
+    for (const PULSE_MEASUREMENT& measurement : measurements)
+    {
+        pins.push_back({
+            {"p", measurement.pin_number},
+            {"c", measurement.count},
+            {"n", measurement.pulses},
+            {"f", std::round(measurement.frequency * 100.0) / 100.0},
+            {"d", std::round(measurement.duty * 1000.0) / 1000.0},
+            {"w", std::round(measurement.width_us * 10.0) / 10.0}
+        });
+    }
+
+    const Json_de message_cmd = 
+        {
+            {"a", GPIO_ACTION_PULSE_INFO},
+            {"i", m_cGPIOMain.getModuleKey()},
+            {"s", pins}
+        };
+
+    #ifdef DEBUG
+        std::cout << "API_sendPulseStatus:" << message_cmd.dump() << std::endl;
+    #endif
+
+    m_module.sendJMSG (target_party_id, message_cmd, TYPE_AndruavMessage_GPIO_STATUS, internal);
+}
+
+
+/**
+ * @brief position & velocity of an encoder, or of all encoders if encoder is -1.
+ * "x" position in counts, "v" counts per second since previous status to the same reader, "r" illegal transitions,
+ * "z" index pulses, "q" position at last index pulse.
+ */
+void CGPIO_Facade::API_sendEncoderStatus(const std::string&target_party_id, const int encoder, const uint reader, const bool internal) const
+{
+    CGPIOEncoder& encoders = CGPIODriver::getInstance().getEncoders();
+    if (encoders.getCount() == 0) return ;
+
+    std::vector<ENCODER_STATUS> status;
+    if (encoder < 0)
+    {
+        encoders.getStatus(status, reader);
+    }
+    else
+    {
+        status.resize(1);
+        if (!encoders.getStatus(encoder, status[0], reader)) return ;
+    }
+
+    Json_de json_array = Json_de::array();
+    for (const ENCODER_STATUS& item : status)
+    {
+        json_array.push_back({
+            {"e", item.encoder},
+            {"n", item.name},
+            {"x", item.position},
+            {"v", std::round(item.velocity * 10.0) / 10.0},
+            {"r", item.errors},
+            {"z", item.index_count},
+            {"q", item.index_position}
+        });
+    }
+
+    const Json_de message_cmd = 
         {
-            json_gpio["d"] =  gpio.pin_pwm_width;
+            {"a", GPIO_ACTION_ENCODER},
+            {"i", m_cGPIOMain.getModuleKey()},
+            {"s", json_array}
+        };
+
+    #ifdef DEBUG
+        std::cout << "API_sendEncoderStatus:" << message_cmd.dump() << std::endl;
+    #endif
+
+    m_module.sendJMSG (target_party_id, message_cmd, TYPE_AndruavMessage_GPIO_STATUS, internal);
+}
+
+
+/**
+ * @brief select GPIO_STATUS format for status sent to a peer.
+ * 
+ * @param party_id 
+ * @param format GPIO_STATUS_FORMAT_JSON or GPIO_STATUS_FORMAT_BINARY
+ */
+void CGPIO_Facade::setPeerStatusFormat(const std::string& party_id, const int format)
+{
+    if (party_id.empty()) return ;
+
+    const std::lock_guard<std::mutex> lock(m_status_mutex);
+
+    if (format == GPIO_STATUS_FORMAT_BINARY)
+    {
+        if (!m_binary_peers.insert(party_id).second) return ;
+        m_binary_peer_order.push_back(party_id);
+
+        // a dropped peer gets JSON again until it asks for binary status once more.
+        if (m_binary_peer_order.size() > MAX_BINARY_STATUS_PEERS)
+        {
+            m_binary_peers.erase(m_binary_peer_order.front());
+            m_binary_peer_order.pop_front();
         }
-        
-        json_array.push_back(json_gpio);
     }
-    
-    Json_de jMsg = 
+    else if (m_binary_peers.erase(party_id) != 0)
+    {
+        m_binary_peer_order.erase(std::find(m_binary_peer_order.begin(), m_binary_peer_order.end(), party_id));
+    }
+}
+
+
+/**
+ * @brief select GPIO_STATUS format of external status sent to all peers.
+ * JSON by default as older peers do not understand binary status.
+ */
+void CGPIO_Facade::setBroadcastStatusFormat(const int format)
+{
+    const std::lock_guard<std::mutex> lock(m_status_mutex);
+
+    m_broadcast_status_format = format;
+}
+
+
+bool CGPIO_Facade::isBinaryStatus(const std::string&target_party_id, const bool internal) const
+{
+    if (internal) return false;
+
+    if (target_party_id.empty()) return m_broadcast_status_format == GPIO_STATUS_FORMAT_BINARY;
+
+    return m_binary_peers.find(target_party_id) != m_binary_peers.end();
+}
+
+
+void CGPIO_Facade::sendBinaryStatus(const std::string&target_party_id, const GPIO* gpios, const size_t count, const bool internal) const
+{
+    CGPIOStatusCodec::encode(gpios, count, m_status_binary);
+
+    const Json_de message_cmd = 
         {
             {"a", GPIO_ACTION_INFO},
-            {"s", json_array}
+            {"i", m_cGPIOMain.getModuleKey()},
+            {"f", GPIO_STATUS_FORMAT_BINARY}
         };
 
+    #ifdef DEBUG
+        std::cout << "API_sendGPIOStatus:binary:" << m_status_binary.size() << " bytes" << std::endl;
+    #endif
+
+    m_module.sendBMSG (target_party_id, reinterpret_cast<const char *>(m_status_binary.data()), m_status_binary.size(), TYPE_AndruavMessage_GPIO_STATUS, internal, message_cmd);
+}
+
+
+void CGPIO_Facade::sendStatus(const std::string&target_party_id, const GPIO* gpios, const size_t count, const bool internal) const
+{
+    const std::lock_guard<std::mutex> lock(m_status_mutex);
+
+    sendStatusLocked(target_party_id, gpios, count, internal);
+}
+
+
+void CGPIO_Facade::sendStatusLocked(const std::string&target_party_id, const GPIO* gpios, const size_t count, const bool internal) const
+{
+    if (isBinaryStatus(target_party_id, internal))
+    {
+        sendBinaryStatus(target_party_id, gpios, count, internal);
+        return ;
+    }
+
+    const Json_de& jMsg = getStatusMessage(gpios, count);
+
     #ifdef DEBUG
         std::cout << "API_sendGPIOStatus:" << jMsg.dump() << std::endl;
     #endif
     
     m_module.sendJMSG (target_party_id, jMsg, TYPE_AndruavMessage_GPIO_STATUS,  internal);
-    
 }
 
 
+/**
+ * @brief returns cached status message of pins.
+ * only elements of pins that changed since message was last used are replaced.
+ */
+const Json_de& CGPIO_Facade::getStatusMessage(const GPIO* gpios, const size_t count) const
+{
+    uint64_t pin_mask = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        updateStatusCache(gpios[i]);
+        pin_mask |= 1ull << gpios[i].pin_number;
+    }
 
-void CGPIO_Facade::API_sendSingleGPIOStatus(const std::string&target_party_id, const GPIO& gpio, const bool internal) const
+    auto it = m_status_messages.find(pin_mask);
+    if (it == m_status_messages.end())
+    {
+        if (m_status_messages.size() >= MAX_STATUS_MESSAGE_CACHE) m_status_messages.clear();
+
+        STATUS_MESSAGE status_message;
+
+        // Create a JSON array - one element per pin.
+        Json_de json_array = Json_de::array();
+        uint64_t added_mask = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint pin_number = gpios[i].pin_number;
+            if (added_mask & (1ull << pin_number)) continue;
+
+            added_mask |= 1ull << pin_number;
+            status_message.index[pin_number] = static_cast<uint8_t>(json_array.size());
+            json_array.push_back(m_status_pins[pin_number]);
+        }
+
+        status_message.message = 
+            {
+                {"a", GPIO_ACTION_INFO},
+                {"s", json_array}
+            };
+        status_message.version = m_status_version;
+
+        return m_status_messages.emplace(pin_mask, std::move(status_message)).first->second.message;
+    }
+
+    STATUS_MESSAGE& status_message = it->second;
+    if (status_message.version != m_status_version)
+    {
+        Json_de& json_array = status_message.message["s"];
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint pin_number = gpios[i].pin_number;
+            if (m_status_pin_version[pin_number] > status_message.version)
+            {
+                json_array[status_message.index[pin_number]] = m_status_pins[pin_number];
+            }
+        }
+        status_message.version = m_status_version;
+    }
+
+    return status_message.message;
+}
+
+
+/**
+ * @brief regenerate fields of pin status JSON that differ from last generated values.
+ */
+void CGPIO_Facade::updateStatusCache(const GPIO& gpio) const
 {
-    CGPIODriver& cGPIODriver  = CGPIODriver::getInstance();
-    
-    const std::vector<GPIO> gpios = cGPIODriver.getGPIOStatus();
-    
-    // Create a JSON array
-    Json_de json_array = Json_de::array();
+    const uint pin_number = gpio.pin_number;
+    if (pin_number >= MAX_GPIO_PINS) return ;
 
-    Json_de json_gpio = {
-        {"i", m_cGPIOMain.getModuleKey()},
-        {"b", gpio.pin_number},
-        {"m", gpio.pin_mode},
-        {"t", gpio.gpio_type},
-        {"d", gpio.pin_pwm_width},
-        {"v", gpio.pin_value}
-    };
-        
-    #ifdef DEBUG
-        std::cout << "API_sendSingleGPIOStatus:" << json_gpio.dump() << std::endl;
-    #endif
+    Json_de& json_gpio = m_status_pins[pin_number];
+    GPIO& cached = m_status_gpios[pin_number];
+
+    if (!m_status_valid.test(pin_number))
+    {
+        json_gpio = {
+            {"i", m_cGPIOMain.getModuleKey()},
+            {"p", gpio.pin_number},
+            {"b", gpio.pin_number},
+            {"m", gpio.pin_mode},
+            {"t", gpio.gpio_type},
+            {"d", gpio.pin_pwm_width},
+            {"v", gpio.pin_value}
+        };
         
-    if (!gpio.pin_name.empty())
+        if (!gpio.pin_name.empty())
+        {
+            json_gpio["n"] =  gpio.pin_name;
+        }
+
+        cached = gpio;
+        m_status_valid.set(pin_number);
+        m_status_pin_version[pin_number] = ++m_status_version;
+        return ;
+    }
+
+    bool changed = false;
+
+    if (cached.pin_mode != gpio.pin_mode)
     {
-        json_gpio["n"] =  gpio.pin_name;
+        json_gpio["m"] = gpio.pin_mode;
+        cached.pin_mode = gpio.pin_mode;
+        changed = true;
     }
 
-    if (gpio.pin_mode == PWM_OUTPUT)
+    if (cached.gpio_type != gpio.gpio_type)
     {
-        json_gpio["d"] =  gpio.pin_pwm_width;
+        json_gpio["t"] = gpio.gpio_type;
+        cached.gpio_type = gpio.gpio_type;
+        changed = true;
     }
-        
-    json_array.push_back(json_gpio);
-    
-    Json_de jMsg = 
+
+    if (cached.pin_pwm_width != gpio.pin_pwm_width)
+    {
+        json_gpio["d"] = gpio.pin_pwm_width;
+        cached.pin_pwm_width = gpio.pin_pwm_width;
+        changed = true;
+    }
+
+    if (cached.pin_value != gpio.pin_value)
+    {
+        json_gpio["v"] = gpio.pin_value;
+        cached.pin_value = gpio.pin_value;
+        changed = true;
+    }
+
+    if (cached.pin_name != gpio.pin_name)
+    {
+        if (gpio.pin_name.empty())
         {
-            {"a", GPIO_ACTION_INFO},
-            {"s", json_array}
+            json_gpio.erase("n");
+        }
+        else
+        {
+            json_gpio["n"] = gpio.pin_name;
+        }
+        cached.pin_name = gpio.pin_name;
+        changed = true;
+    }
+
+    if (changed)
+    {
+        m_status_pin_version[pin_number] = ++m_status_version;
+    }
+}
+
+
+/**
+ * @brief actuator queue counters per lane. "q" commands waiting, "m" max waiting,
+ * "p" pushed, "x" executed, "c" writes merged into a later write, "r" dropped - lane full.
+ */
+void CGPIO_Facade::API_sendActuatorStats(const std::string&target_party_id, const bool internal) const
+{
+    CGPIOActuator& actuator = CGPIOActuator::getInstance();
+    if (!actuator.isRunning()) return ;
+
+    Json_de lanes = Json_de::array();
+    for (uint lane = 0; lane < GPIO_ACTUATOR_LANES; ++lane)
+    {
+        const GPIO_ACTUATOR_STATS stats = actuator.getStats(lane);
+        lanes.push_back({
+            {"l", CGPIOActuator::getLaneName(lane)},
+            {"q", stats.depth},
+            {"m", stats.max_depth},
+            {"p", stats.pushed},
+            {"x", stats.executed},
+            {"c", stats.coalesced},
+            {"r", stats.rejected}
+        });
+    }
+
+    const Json_de message_cmd = 
+        {
+            {"a", GPIO_ACTION_ACTUATOR_INFO},
+            {"i", m_cGPIOMain.getModuleKey()},
+            {"s", lanes}
         };
 
     #ifdef DEBUG
-        std::cout << "XXXXXXXXXXXXXXXXXXXXX" << jMsg.dump() << std::endl;
+        std::cout << "API_sendActuatorStats:" << message_cmd.dump() << std::endl;
     #endif
-    
-    m_module.sendJMSG (target_party_id, jMsg, TYPE_AndruavMessage_GPIO_STATUS,  internal);
-    
-}
-
 
+    m_module.sendJMSG (target_party_id, message_cmd, TYPE_AndruavMessage_GPIO_STATUS, internal);
+}
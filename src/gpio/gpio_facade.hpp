@@ -1,8 +1,17 @@
 #ifndef GPIO_FACADE_H_
 #define GPIO_FACADE_H_
 
+#include <mutex>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "../de_common/de_databus/de_facade_base.hpp"
 #include "gpio_driver.hpp"
+#include "gpio_status_codec.hpp"
+
+#define MAX_STATUS_MESSAGE_CACHE 16 // cached status messages - one per set of pins
+#define MAX_BINARY_STATUS_PEERS 32  // peers remembered as binary status readers - oldest is dropped
 
 namespace de
 {
@@ -45,11 +54,64 @@ namespace gpio
 
         public:
             void API_sendGPIOStatus(const std::string&target_party_id, const bool internal) const;
+            void API_sendGPIOStatus(const std::string&target_party_id, const uint64_t pin_mask, const bool internal) const;
             void API_sendSingleGPIOStatus(const std::string&target_party_id, const GPIO& gpio, const bool internal) const;
+            void API_sendLatencyReport(const std::string&target_party_id, const bool internal) const;
+            void API_sendInputSampling(const std::string&target_party_id, const bool internal) const;
+            void API_sendPulseStatus(const std::string&target_party_id, const bool internal) const;
+            void API_sendEncoderStatus(const std::string&target_party_id, const int encoder, const uint reader, const bool internal) const;
+            void API_sendActuatorStats(const std::string&target_party_id, const bool internal) const;
             
+        public:
+
+            void setPeerStatusFormat(const std::string& party_id, const int format);
+            void setBroadcastStatusFormat(const int format);
+
             
         protected:
 
+            void sendStatus(const std::string&target_party_id, const GPIO* gpios, const size_t count, const bool internal) const;
+            void sendStatusLocked(const std::string&target_party_id, const GPIO* gpios, const size_t count, const bool internal) const;
+            void sendBinaryStatus(const std::string&target_party_id, const GPIO* gpios, const size_t count, const bool internal) const;
+            bool isBinaryStatus(const std::string&target_party_id, const bool internal) const;
+            void updateStatusCache(const GPIO& gpio) const;
+            const Json_de& getStatusMessage(const GPIO* gpios, const size_t count) const;
+
+        private:
+
+            /**
+             * @brief status message of a set of pins.
+             * version is m_status_version when message was last refreshed.
+             * index is the element of each pin - callers may list the same pins in another order.
+             */
+            typedef struct STATUS_MESSAGE{
+                    Json_de message;
+                    uint64_t version;
+                    std::array<uint8_t, MAX_GPIO_PINS> index;
+                } STATUS_MESSAGE;
+
+            // status JSON of each pin - only changed fields are regenerated.
+            mutable std::array<Json_de, MAX_GPIO_PINS> m_status_pins;
+            // GPIO values m_status_pins was generated from.
+            mutable std::array<GPIO, MAX_GPIO_PINS> m_status_gpios;
+            mutable std::bitset<MAX_GPIO_PINS> m_status_valid;
+            // version at which each pin JSON last changed.
+            mutable std::array<uint64_t, MAX_GPIO_PINS> m_status_pin_version = {};
+            mutable uint64_t m_status_version = 0;
+            // status messages keyed by pin mask - elements of changed pins are replaced in place.
+            mutable std::unordered_map<uint64_t, STATUS_MESSAGE> m_status_messages;
+            // peers that asked for binary GPIO_STATUS - others get JSON.
+            // peers are not told when one leaves, so at most MAX_BINARY_STATUS_PEERS are kept, oldest first in m_binary_peer_order.
+            std::unordered_set<std::string> m_binary_peers;
+            std::deque<std::string> m_binary_peer_order;
+            // format of external status sent to all peers.
+            int m_broadcast_status_format = GPIO_STATUS_FORMAT_JSON;
+            mutable std::vector<uint8_t> m_status_binary;
+            // pin snapshot read from driver without locking it - reused to avoid heap copies.
+            mutable GPIO_SNAPSHOT m_snapshot;
+            mutable std::array<GPIO, MAX_GPIO_PINS> m_snapshot_gpios;
+            // facade is called from scheduler, receive and input event threads.
+            mutable std::mutex m_status_mutex;
             
     };
 }
@@ -0,0 +1,158 @@
+#include "gpio_input_filter.hpp"
+
+
+using namespace de::gpio;
+
+
+void CGPIOInputFilter::configure (const GPIO_INPUT_FILTER& filter, const uint level)
+{
+    m_filter = filter;
+    m_stats = GPIO_INPUT_FILTER_STATS();
+    m_level = level;
+    m_raw_level = level;
+    m_lockout_until_ns = 0;
+    m_pending = false;
+    m_vote = false;
+}
+
+
+/**
+ * @brief an edge from kernel.
+ *
+ * @return true if level changed and should be reported now.
+ */
+bool CGPIOInputFilter::onEdge (const uint level, const uint64_t timestamp_ns)
+{
+    m_raw_level = level;
+
+    if ((m_filter.debounce_us != 0) && (timestamp_ns < m_lockout_until_ns))
+    {
+        // bounce - level is re-checked by onTimer when window ends.
+        m_stats.filtered_debounce++;
+        return false;
+    }
+
+    if (m_filter.min_pulse_us != 0)
+    {
+        if (m_pending)
+        {
+            // level returned before min_pulse_us - drop the pulse.
+            m_pending = false;
+            m_stats.filtered_glitch += 2;
+            return false;
+        }
+
+        if (level == m_level) return false;
+
+        m_pending = true;
+        m_pending_level = level;
+        m_pending_until_ns = timestamp_ns + static_cast<uint64_t>(m_filter.min_pulse_us) * 1000;
+        return false;
+    }
+
+    if (usesMajority())
+    {
+        if (m_vote)
+        {
+            // line changed again while voting - last edge is voted on.
+            m_stats.filtered_majority++;
+            m_vote = false;
+        }
+
+        if (level == m_level) return false;
+
+        m_vote = true;
+        m_vote_level = level;
+        m_vote_samples = 0;
+        m_vote_high = 0;
+        m_vote_edge_ns = timestamp_ns;
+        m_vote_next_ns = timestamp_ns + static_cast<uint64_t>(m_filter.majority_interval_us) * 1000;
+        return false;
+    }
+
+    return accept(level, timestamp_ns);
+}
+
+
+/**
+ * @brief line level read when isSampleDue().
+ *
+ * @return true if the voted edge is accepted and should be reported now.
+ */
+bool CGPIOInputFilter::onSample (const uint level)
+{
+    if (!m_vote) return false;
+
+    m_vote_samples++;
+    m_vote_high += level ? 1 : 0;
+
+    if (m_vote_samples < m_filter.majority)
+    {
+        m_vote_next_ns += static_cast<uint64_t>(m_filter.majority_interval_us) * 1000;
+        return false;
+    }
+
+    m_vote = false;
+
+    const uint majority_level = (m_vote_high * 2 > m_vote_samples) ? 1 : 0;
+    if (majority_level != m_vote_level)
+    {
+        m_stats.filtered_majority++;
+        return false;
+    }
+
+    return accept(m_vote_level, m_vote_edge_ns);
+}
+
+
+/**
+ * @brief called when getDeadline() is reached.
+ *
+ * @return true if level changed and should be reported now.
+ */
+bool CGPIOInputFilter::onTimer (const uint64_t now_ns)
+{
+    if (m_pending && (now_ns >= m_pending_until_ns))
+    {
+        m_pending = false;
+        return accept(m_pending_level, m_pending_until_ns);
+    }
+
+    if ((m_lockout_until_ns != 0) && (now_ns >= m_lockout_until_ns))
+    {
+        m_lockout_until_ns = 0;
+        if (m_raw_level != m_level)
+        {
+            // line settled at a different level than reported.
+            return accept(m_raw_level, now_ns);
+        }
+    }
+
+    return false;
+}
+
+
+uint64_t CGPIOInputFilter::getDeadline () const
+{
+    if (m_pending) return m_pending_until_ns;
+
+    if (m_vote && ((m_lockout_until_ns == 0) || (m_vote_next_ns < m_lockout_until_ns))) return m_vote_next_ns;
+
+    return m_lockout_until_ns;
+}
+
+
+bool CGPIOInputFilter::accept (const uint level, const uint64_t timestamp_ns)
+{
+    if (level == m_level) return false;
+
+    m_level = level;
+    m_stats.accepted++;
+
+    if (m_filter.debounce_us != 0)
+    {
+        m_lockout_until_ns = timestamp_ns + static_cast<uint64_t>(m_filter.debounce_us) * 1000;
+    }
+
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef GPIO_INPUT_FILTER_H_
+#define GPIO_INPUT_FILTER_H_
+
+#include <cstdint>
+#include <sys/types.h>
+
+
+#define GPIO_INPUT_FILTER_MAJORITY_INTERVAL_US 100 // default time between majority samples
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief filter settings of an INPUT pin - "pins" section of config file.
+     *
+     * * debounce_us:   first edge is reported at once, later edges are ignored for debounce_us.
+     *                  level is re-checked when the window ends so final state is always reported.
+     * * min_pulse_us:  an edge is reported only if the level stays for min_pulse_us.
+     *                  shorter pulses are dropped as glitches.
+     * * majority:      line is sampled N times, majority_interval_us apart, from the time of an edge.
+     *                  edge is reported if most samples agree with it, else dropped.
+     *                  not used with min_pulse_us which already requires a stable level.
+     *
+     * 0 disables a filter.
+     */
+    typedef struct GPIO_INPUT_FILTER{
+            uint32_t debounce_us = 0;
+            uint32_t min_pulse_us = 0;
+            uint32_t majority = 0;
+            uint32_t majority_interval_us = GPIO_INPUT_FILTER_MAJORITY_INTERVAL_US;
+        } GPIO_INPUT_FILTER;
+
+
+    typedef struct GPIO_INPUT_FILTER_STATS{
+            uint64_t accepted = 0;
+            uint64_t filtered_debounce = 0;
+            uint64_t filtered_glitch = 0;
+            uint64_t filtered_majority = 0;
+        } GPIO_INPUT_FILTER_STATS;
+
+
+    /**
+     * @brief debounce, glitch & majority filter state of one INPUT pin.
+     * runs on edge event thread only. Samples are taken by the owner when isSampleDue().
+     */
+    class CGPIOInputFilter
+    {
+        public:
+
+            void configure (const GPIO_INPUT_FILTER& filter, const uint level);
+
+            bool onEdge (const uint level, const uint64_t timestamp_ns);
+            bool onTimer (const uint64_t now_ns);
+            bool onSample (const uint level);
+
+            inline bool isEnabled () const
+            {
+                return (m_filter.debounce_us != 0) || (m_filter.min_pulse_us != 0) || usesMajority();
+            }
+
+            /**
+             * @brief line should be read now and passed to onSample.
+             */
+            inline bool isSampleDue (const uint64_t now_ns) const
+            {
+                return m_vote && (now_ns >= m_vote_next_ns);
+            }
+
+            /**
+             * @brief time onTimer should be called. 0 if not needed.
+             */
+            uint64_t getDeadline () const;
+
+            inline uint getLevel () const
+            {
+                return m_level;
+            }
+
+            inline const GPIO_INPUT_FILTER& getFilter () const
+            {
+                return m_filter;
+            }
+
+            inline const GPIO_INPUT_FILTER_STATS& getStats () const
+            {
+                return m_stats;
+            }
+
+        private:
+
+            bool accept (const uint level, const uint64_t timestamp_ns);
+
+            inline bool usesMajority () const
+            {
+                return (m_filter.majority > 1) && (m_filter.min_pulse_us == 0);
+            }
+
+        private:
+
+            GPIO_INPUT_FILTER m_filter;
+            GPIO_INPUT_FILTER_STATS m_stats;
+
+            uint m_level = 0;               // last reported level
+            uint m_raw_level = 0;           // level of last edge
+            uint64_t m_lockout_until_ns = 0;
+
+            bool m_pending = false;
+            uint m_pending_level = 0;
+            uint64_t m_pending_until_ns = 0;
+
+            // majority vote on the level of last edge.
+            bool m_vote = false;
+            uint m_vote_level = 0;
+            uint m_vote_samples = 0;
+            uint m_vote_high = 0;
+            uint64_t m_vote_edge_ns = 0;
+            uint64_t m_vote_next_ns = 0;
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include <iostream>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_latency.hpp"
+
+
+using namespace de::gpio;
+
+
+static const char* action_names[GPIO_LATENCY_ACTIONS] = {
+    "port_config",
+    "port_write",
+    "port_write_pwm",
+    "port_write_batch",
+    "pattern",
+    "binary_write",
+    "binary_config",
+    "status"
+};
+
+static const char* stage_names[GPIO_LATENCY_STAGES] = {
+    "parse",
+    "dispatch",
+    "write",
+    "total"
+};
+
+
+void CGPIOLatencyHistogram::snapshot (GPIO_LATENCY_COUNTS& counts) const
+{
+    for (uint i = 0; i < GPIO_LATENCY_BUCKETS; ++i)
+    {
+        counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+
+/**
+ * @brief bucket of a value.
+ * values below GPIO_LATENCY_SUB_BUCKETS have a bucket each. Above that each power of two
+ * is split into GPIO_LATENCY_SUB_BUCKETS equal buckets.
+ */
+uint CGPIOLatencyHistogram::bucketIndex (uint64_t value_ns)
+{
+    if (value_ns < GPIO_LATENCY_SUB_BUCKETS) return static_cast<uint>(value_ns);
+
+    const uint64_t max_value = (1ull << GPIO_LATENCY_MAX_BITS) - 1;
+    if (value_ns > max_value) value_ns = max_value;
+
+    const uint magnitude = 63 - __builtin_clzll(value_ns);
+    const uint shift = magnitude - GPIO_LATENCY_SUB_BUCKET_BITS;
+    const uint sub_bucket = static_cast<uint>(value_ns >> shift) & (GPIO_LATENCY_SUB_BUCKETS - 1);
+
+    return GPIO_LATENCY_SUB_BUCKETS + shift * GPIO_LATENCY_SUB_BUCKETS + sub_bucket;
+}
+
+
+/**
+ * @brief highest value counted in a bucket.
+ */
+uint64_t CGPIOLatencyHistogram::bucketValue (const uint index)
+{
+    if (index < GPIO_LATENCY_SUB_BUCKETS) return index;
+
+    const uint shift = (index - GPIO_LATENCY_SUB_BUCKETS) / GPIO_LATENCY_SUB_BUCKETS;
+    const uint64_t sub_bucket = (index - GPIO_LATENCY_SUB_BUCKETS) % GPIO_LATENCY_SUB_BUCKETS;
+
+    return ((GPIO_LATENCY_SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
+
+
+GPIO_LATENCY_SUMMARY CGPIOLatencyHistogram::summarize (const GPIO_LATENCY_COUNTS& counts)
+{
+    GPIO_LATENCY_SUMMARY summary;
+
+    for (const uint64_t count : counts) summary.count += count;
+    if (summary.count == 0) return summary;
+
+    // rank of each percentile - 1 based.
+    const uint64_t p50 = (summary.count * 500 + 999) / 1000;
+    const uint64_t p90 = (summary.count * 900 + 999) / 1000;
+    const uint64_t p99 = (summary.count * 990 + 999) / 1000;
+    const uint64_t p999 = (summary.count * 999 + 999) / 1000;
+
+    uint64_t seen = 0;
+    for (uint i = 0; i < GPIO_LATENCY_BUCKETS; ++i)
+    {
+        if (counts[i] == 0) continue;
+
+        const uint64_t previous = seen;
+        seen += counts[i];
+        const uint64_t value = bucketValue(i);
+
+        if ((previous < p50) && (seen >= p50)) summary.p50_ns = value;
+        if ((previous < p90) && (seen >= p90)) summary.p90_ns = value;
+        if ((previous < p99) && (seen >= p99)) summary.p99_ns = value;
+        if ((previous < p999) && (seen >= p999)) summary.p999_ns = value;
+        summary.max_ns = value;
+    }
+
+    return summary;
+}
+
+
+/**
+ * @brief add stage latencies of current command to its action histograms.
+ * total ends at hardware write, or here for commands that write nothing.
+ */
+void CGPIOLatency::end ()
+{
+    if (!m_trace.active) return ;
+    m_trace.active = false;
+
+    const int action = m_trace.action;
+    if ((action < 0) || (action >= GPIO_LATENCY_ACTIONS)) return ;
+
+    const uint64_t end_ns = (m_trace.write_ns != 0) ? m_trace.write_ns : now();
+
+    histogram(action, GPIO_LATENCY_STAGE_PARSE).record(m_trace.parse_ns - m_trace.receive_ns);
+
+    if (m_trace.dispatch_ns != 0)
+    {
+        histogram(action, GPIO_LATENCY_STAGE_DISPATCH).record(m_trace.dispatch_ns - m_trace.parse_ns);
+
+        if (m_trace.write_ns != 0)
+        {
+            histogram(action, GPIO_LATENCY_STAGE_WRITE).record(m_trace.write_ns - m_trace.dispatch_ns);
+        }
+    }
+
+    histogram(action, GPIO_LATENCY_STAGE_TOTAL).record(end_ns - m_trace.receive_ns);
+}
+
+
+/**
+ * @brief print percentiles of all commands since start.
+ */
+void CGPIOLatency::dump () const
+{
+    std::cout << _INFO_CONSOLE_BOLD_TEXT << "Command latency (us) - action stage: count p50 p90 p99 p99.9 max" << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    GPIO_LATENCY_COUNTS counts;
+    for (int action = 0; action < GPIO_LATENCY_ACTIONS; ++action)
+    {
+        for (int stage = 0; stage < GPIO_LATENCY_STAGES; ++stage)
+        {
+            m_histograms[action * GPIO_LATENCY_STAGES + stage].snapshot(counts);
+            const GPIO_LATENCY_SUMMARY summary = CGPIOLatencyHistogram::summarize(counts);
+            if (summary.count == 0) continue;
+
+            std::cout << _INFO_CONSOLE_TEXT << "  " << action_names[action] << " " << stage_names[stage] << ": "
+                      << _LOG_CONSOLE_BOLD_TEXT << summary.count
+                      << " " << summary.p50_ns / 1000.0
+                      << " " << summary.p90_ns / 1000.0
+                      << " " << summary.p99_ns / 1000.0
+                      << " " << summary.p999_ns / 1000.0
+                      << " " << summary.max_ns / 1000.0
+                      << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        }
+    }
+}
+
+
+/**
+ * @brief percentiles of commands since last report.
+ *
+ * @return [{'a': action, 's': stage, 'n': count, 'p50', 'p90', 'p99', 'p999', 'max': nsec}, ...]
+ *         only stages that had commands.
+ */
+Json_de CGPIOLatency::getReport ()
+{
+    const std::lock_guard<std::mutex> lock(m_report_mutex);
+
+    Json_de report = Json_de::array();
+
+    GPIO_LATENCY_COUNTS counts;
+    for (int action = 0; action < GPIO_LATENCY_ACTIONS; ++action)
+    {
+        for (int stage = 0; stage < GPIO_LATENCY_STAGES; ++stage)
+        {
+            const uint index = action * GPIO_LATENCY_STAGES + stage;
+            m_histograms[index].snapshot(counts);
+
+            GPIO_LATENCY_COUNTS& reported = m_reported[index];
+            for (uint i = 0; i < GPIO_LATENCY_BUCKETS; ++i)
+            {
+                const uint64_t total = counts[i];
+                counts[i] -= reported[i];
+                reported[i] = total;
+            }
+
+            const GPIO_LATENCY_SUMMARY summary = CGPIOLatencyHistogram::summarize(counts);
+            if (summary.count == 0) continue;
+
+            report.push_back({
+                {"a", action_names[action]},
+                {"s", stage_names[stage]},
+                {"n", summary.count},
+                {"p50", summary.p50_ns},
+                {"p90", summary.p90_ns},
+                {"p99", summary.p99_ns},
+                {"p999", summary.p999_ns},
+                {"max", summary.max_ns}
+            });
+        }
+    }
+
+    return report;
+}
+
+
+const char* CGPIOLatency::getActionName (const int action)
+{
+    if ((action < 0) || (action >= GPIO_LATENCY_ACTIONS)) return "";
+
+    return action_names[action];
+}
+
+
+const char* CGPIOLatency::getStageName (const int stage)
+{
+    if ((stage < 0) || (stage >= GPIO_LATENCY_STAGES)) return "";
+
+    return stage_names[stage];
+}
@@ -0,0 +1,266 @@
+#ifndef GPIO_LATENCY_H_
+#define GPIO_LATENCY_H_
+
+#include <cstdint>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <time.h>
+#include <sys/types.h>
+
+#include "../de_common/helpers/json_nlohmann.hpp"
+using Json_de = nlohmann::json;
+
+
+// log-linear buckets: 16 per power of two - about 6% precision.
+#define GPIO_LATENCY_SUB_BUCKET_BITS 4
+#define GPIO_LATENCY_SUB_BUCKETS (1u << GPIO_LATENCY_SUB_BUCKET_BITS)
+#define GPIO_LATENCY_MAX_BITS 33 // ~8.6 sec - longer latencies are counted in last bucket
+#define GPIO_LATENCY_BUCKETS (GPIO_LATENCY_SUB_BUCKETS * (GPIO_LATENCY_MAX_BITS - GPIO_LATENCY_SUB_BUCKET_BITS + 1))
+
+// traced actions
+#define GPIO_LATENCY_NONE               -1
+#define GPIO_LATENCY_PORT_CONFIG        0
+#define GPIO_LATENCY_PORT_WRITE         1
+#define GPIO_LATENCY_PORT_WRITE_PWM     2
+#define GPIO_LATENCY_PORT_WRITE_BATCH   3
+#define GPIO_LATENCY_PATTERN            4
+#define GPIO_LATENCY_BINARY_WRITE       5
+#define GPIO_LATENCY_BINARY_CONFIG      6
+#define GPIO_LATENCY_STATUS             7
+#define GPIO_LATENCY_ACTIONS            8
+
+// traced stages
+#define GPIO_LATENCY_STAGE_PARSE        0   // onReceive -> command parsed
+#define GPIO_LATENCY_STAGE_DISPATCH     1   // parsed -> driver called - includes actuator queue wait
+#define GPIO_LATENCY_STAGE_WRITE        2   // driver called -> hardware written
+#define GPIO_LATENCY_STAGE_TOTAL        3   // onReceive -> hardware written
+#define GPIO_LATENCY_STAGES             4
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief timestamps of the command being handled by this thread.
+     */
+    typedef struct GPIO_LATENCY_TRACE{
+            bool active = false;
+            int action = GPIO_LATENCY_NONE;
+            uint64_t receive_ns = 0;
+            uint64_t parse_ns = 0;
+            uint64_t dispatch_ns = 0;
+            uint64_t write_ns = 0;
+        } GPIO_LATENCY_TRACE;
+
+
+    /**
+     * @brief percentiles of a histogram. values are bucket upper bounds.
+     */
+    typedef struct GPIO_LATENCY_SUMMARY{
+            uint64_t count = 0;
+            uint64_t p50_ns = 0;
+            uint64_t p90_ns = 0;
+            uint64_t p99_ns = 0;
+            uint64_t p999_ns = 0;
+            uint64_t max_ns = 0;
+        } GPIO_LATENCY_SUMMARY;
+
+
+    typedef std::array<uint64_t, GPIO_LATENCY_BUCKETS> GPIO_LATENCY_COUNTS;
+
+
+    /**
+     * @brief HDR style histogram of nanosecond latencies.
+     * record() is lock free and may run while another thread takes a snapshot.
+     */
+    class CGPIOLatencyHistogram
+    {
+        public:
+
+            CGPIOLatencyHistogram()
+            {
+                for (auto& count : m_counts) count.store(0, std::memory_order_relaxed);
+            }
+
+            CGPIOLatencyHistogram(CGPIOLatencyHistogram const&)      = delete;
+            void operator=(CGPIOLatencyHistogram const&)           = delete;
+
+        public:
+
+            inline void record (const uint64_t value_ns)
+            {
+                m_counts[bucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void snapshot (GPIO_LATENCY_COUNTS& counts) const;
+
+            static GPIO_LATENCY_SUMMARY summarize (const GPIO_LATENCY_COUNTS& counts);
+            static uint bucketIndex (uint64_t value_ns);
+            static uint64_t bucketValue (const uint index);
+
+        private:
+
+            std::array<std::atomic<uint64_t>, GPIO_LATENCY_BUCKETS> m_counts;
+    };
+
+
+    /**
+     * @brief Command-to-pin latency tracing.
+     *
+     * The receive thread stamps each command at onReceive and when parsed. The trace is handed
+     * with the command to the actuator thread, which stamps when the driver is called and when
+     * the hardware is written. end() adds stage latencies to per-action histograms.
+     *
+     * Timestamps live in a thread local trace that is only active between begin() and end()
+     * of an enabled tracer, so writes from other threads (sequencer, soft PWM) are not traced
+     * and a disabled tracer costs one relaxed load per command.
+     */
+    class CGPIOLatency
+    {
+        public:
+
+            static CGPIOLatency& getInstance()
+            {
+                static CGPIOLatency instance;
+
+                return instance;
+            }
+
+            CGPIOLatency(CGPIOLatency const&)             = delete;
+            void operator=(CGPIOLatency const&)          = delete;
+
+        private:
+
+            CGPIOLatency()
+            {
+
+            }
+
+        public:
+
+            ~CGPIOLatency ()
+            {
+
+            }
+
+        public:
+
+            inline void setEnabled (const bool enabled)
+            {
+                m_enabled.store(enabled, std::memory_order_relaxed);
+            }
+
+            inline bool isEnabled () const
+            {
+                return m_enabled.load(std::memory_order_relaxed);
+            }
+
+            inline void begin ()
+            {
+                if (!m_enabled.load(std::memory_order_relaxed)) return ;
+
+                m_trace.active = true;
+                m_trace.action = GPIO_LATENCY_NONE;
+                m_trace.receive_ns = now();
+                m_trace.parse_ns = 0;
+                m_trace.dispatch_ns = 0;
+                m_trace.write_ns = 0;
+            }
+
+            inline void markParsed (const int action)
+            {
+                if (!m_trace.active) return ;
+
+                m_trace.action = action;
+                m_trace.parse_ns = now();
+            }
+
+            inline void markDispatch ()
+            {
+                if (!m_trace.active || (m_trace.dispatch_ns != 0)) return ;
+
+                m_trace.dispatch_ns = now();
+            }
+
+            /**
+             * @brief hardware written. last write of a command counts.
+             */
+            inline void markWrite ()
+            {
+                if (!m_trace.active) return ;
+
+                m_trace.write_ns = now();
+            }
+
+            /**
+             * @brief trace of this thread's command - it continues on the thread that executes the command.
+             * end() of this thread records nothing afterwards.
+             */
+            inline GPIO_LATENCY_TRACE detach ()
+            {
+                const GPIO_LATENCY_TRACE trace = m_trace;
+                m_trace.active = false;
+
+                return trace;
+            }
+
+            inline void attach (const GPIO_LATENCY_TRACE& trace)
+            {
+                m_trace = trace;
+            }
+
+            void end ();
+
+            /**
+             * @brief async signal safe - dump is printed by takeDumpRequest() caller.
+             */
+            inline void requestDump ()
+            {
+                m_dump_requested.store(true, std::memory_order_relaxed);
+            }
+
+            inline bool takeDumpRequest ()
+            {
+                return m_dump_requested.exchange(false, std::memory_order_relaxed);
+            }
+
+            void dump () const;
+            Json_de getReport ();
+
+            static const char* getActionName (const int action);
+            static const char* getStageName (const int stage);
+
+        private:
+
+            static inline uint64_t now ()
+            {
+                struct timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+            }
+
+            inline CGPIOLatencyHistogram& histogram (const int action, const int stage)
+            {
+                return m_histograms[action * GPIO_LATENCY_STAGES + stage];
+            }
+
+        private:
+
+            static inline thread_local GPIO_LATENCY_TRACE m_trace;
+
+            std::atomic<bool> m_enabled {false};
+            std::atomic<bool> m_dump_requested {false};
+
+            std::array<CGPIOLatencyHistogram, GPIO_LATENCY_ACTIONS * GPIO_LATENCY_STAGES> m_histograms;
+            // counts at last getReport() - reports cover one interval.
+            std::array<GPIO_LATENCY_COUNTS, GPIO_LATENCY_ACTIONS * GPIO_LATENCY_STAGES> m_reported = {};
+            std::mutex m_report_mutex;
+    };
+
+}
+}
+
+#endif
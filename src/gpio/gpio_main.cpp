@@ -8,60 +8,221 @@
 #include "gpio_main.hpp"
 #include "gpio_facade.hpp"
 #include "gpio_driver.hpp"
+#include "gpio_sequencer.hpp"
+#include "gpio_latency.hpp"
+#include "gpio_recorder.hpp"
+#include "gpio_notifier.hpp"
 
 
-void de::gpio::CGPIOMain::loopScheduler()
+/**
+ * @brief send status of changed pins only, or all pins when keyframe interval elapsed
+ * or pins were added/removed.
+ * 
+ * @param internal 
+ */
+void de::gpio::CGPIOMain::publishStatus(const bool internal)
 {
+    const uint64_t dirty_mask = m_gpio_driver.takeDirtyMask();
+    m_internal_dirty_mask |= dirty_mask;
+    m_external_dirty_mask |= dirty_mask;
+
+    uint64_t& pending_mask = internal ? m_internal_dirty_mask : m_external_dirty_mask;
+    uint64_t& last_keyframe_usec = internal ? m_last_internal_keyframe_usec : m_last_external_keyframe_usec;
+    const uint64_t keyframe_usec = internal ? m_internal_keyframe_usec : m_external_keyframe_usec;
+
+    const uint64_t now = get_time_usec();
     
-    while (!m_exit_thread)
+    if ((pending_mask & GPIO_DIRTY_LAYOUT) || (now - last_keyframe_usec >= keyframe_usec))
+    {
+        CGPIO_Facade::getInstance().API_sendGPIOStatus("", internal);
+        last_keyframe_usec = now;
+        pending_mask = 0;
+        return ;
+    }
+
+    if (pending_mask == 0) return ;
+
+    CGPIO_Facade::getInstance().API_sendGPIOStatus("", pending_mask, internal);
+    pending_mask = 0;
+}
+
+
+/**
+ * @brief keyframe intervals of status publishing.
+ * 
+ * "status_keyframe_sec": full status to internal modules. default 10
+ * "status_external_keyframe_sec": full status to GCS. default 30
+ * "status_format": "json" (default) or "binary" status to GCS.
+ * "scheduler_stats_sec": print scheduler jitter & missed deadlines. default 0 - disabled.
+ * "latency_trace": trace command-to-pin latency. default false.
+ * "latency_report_sec": latency report to GCS. default 60, 0 - local dump only.
+ * "encoder_report_sec": position & velocity of encoders to GCS. default 1, 0 - on request only.
+ * "pulse_report_sec": pulse measurements of PULSE_INPUT pins to GCS. default 1, 0 disables.
+ * "input_sample_report_sec": input sampling summary to GCS. default 1, 0 disables.
+ * "actuator_queue_size": commands per actuator lane. default 256.
+ * "actuator_stats_sec": actuator queue depth & coalescing counters to GCS. default 0 - disabled.
+ * "notify_interval_ms": minimum interval between status messages of a changed pin. default 100.
+ *      0 sends each change at the next 10 ms notifier tick - changes within one tick are still merged.
+ * "notify_type_interval_ms": [GENERIC, SYSTEM] interval per gpio_type. default notify_interval_ms.
+ * "pins": [{"gpio", "notify_ms"}] interval of a pin. default interval of its gpio_type.
+ * "recorder_path": flight recorder ring file. default none - disabled.
+ * "recorder_records": records in flight recorder ring. default 65536.
+ */
+void de::gpio::CGPIOMain::initStatusFromConfigFile()
+{
+    const Json_de& jsonConfig = de::CConfigFile::getInstance().GetConfigJSON();
+
+    if (jsonConfig.contains("status_keyframe_sec"))
+    {
+        m_internal_keyframe_usec = jsonConfig["status_keyframe_sec"].get<uint64_t>() * 1000000;
+    }
+
+    if (jsonConfig.contains("status_external_keyframe_sec"))
+    {
+        m_external_keyframe_usec = jsonConfig["status_external_keyframe_sec"].get<uint64_t>() * 1000000;
+    }
+
+    if (jsonConfig.contains("status_format") && (jsonConfig["status_format"].get<std::string>() == "binary"))
+    {
+        CGPIO_Facade::getInstance().setBroadcastStatusFormat(GPIO_STATUS_FORMAT_BINARY);
+    }
+
+    if (jsonConfig.contains("scheduler_stats_sec"))
     {
-        try
+        m_scheduler_stats_usec = jsonConfig["scheduler_stats_sec"].get<uint64_t>() * 1000000;
+    }
+
+    if (jsonConfig.contains("latency_trace"))
+    {
+        CGPIOLatency::getInstance().setEnabled(jsonConfig["latency_trace"].get<bool>());
+    }
+
+    if (jsonConfig.contains("latency_report_sec"))
+    {
+        m_latency_report_usec = jsonConfig["latency_report_sec"].get<uint64_t>() * 1000000;
+    }
+
+    if (jsonConfig.contains("encoder_report_sec"))
+    {
+        m_encoder_report_usec = static_cast<uint64_t>(jsonConfig["encoder_report_sec"].get<double>() * 1000000);
+    }
+
+    if (jsonConfig.contains("pulse_report_sec"))
+    {
+        m_pulse_report_usec = static_cast<uint64_t>(jsonConfig["pulse_report_sec"].get<double>() * 1000000);
+    }
+
+    if (jsonConfig.contains("input_sample_report_sec"))
+    {
+        m_sampling_report_usec = static_cast<uint64_t>(jsonConfig["input_sample_report_sec"].get<double>() * 1000000);
+    }
+
+    if (jsonConfig.contains("actuator_queue_size"))
+    {
+        m_actuator_queue_size = jsonConfig["actuator_queue_size"].get<uint64_t>();
+    }
+
+    if (jsonConfig.contains("actuator_stats_sec"))
+    {
+        m_actuator_stats_usec = static_cast<uint64_t>(jsonConfig["actuator_stats_sec"].get<double>() * 1000000);
+    }
+
+    CGPIONotifier& notifier = CGPIONotifier::getInstance();
+    if (jsonConfig.contains("notify_interval_ms"))
+    {
+        notifier.setInterval(jsonConfig["notify_interval_ms"].get<int64_t>() * 1000);
+    }
+
+    if (jsonConfig.contains("notify_type_interval_ms") && jsonConfig["notify_type_interval_ms"].is_array())
+    {
+        const Json_de& intervals = jsonConfig["notify_type_interval_ms"];
+        for (uint gpio_type = 0; gpio_type < intervals.size(); ++gpio_type)
         {
-            // timer each 10m sec.
-            wait_time_nsec (0,10000000);
-
-            m_counter++;
-
-            if (m_counter%1000 ==0)
-            {   // each 1000 msec
-                CGPIO_Facade::getInstance().API_sendGPIOStatus("", true);
-            }
-            if (m_counter%10000 ==0)
-            {   // each 10000 msec
-                CGPIO_Facade::getInstance().API_sendGPIOStatus("", false);
-                
-            }
+            notifier.setTypeInterval(gpio_type, intervals[gpio_type].get<int64_t>() * 1000);
         }
-        catch (int error)
-        {
+    }
 
+    if (jsonConfig.contains("pins"))
+    {
+        for (const auto& pin : jsonConfig["pins"])
+        {
+            if (!pin.contains("gpio") || !pin.contains("notify_ms")) continue;
+            notifier.setPinInterval(pin["gpio"].get<uint>(), pin["notify_ms"].get<int64_t>() * 1000);
         }
     }
 
-    return ;
+    if (jsonConfig.contains("recorder_path"))
+    {
+        const uint64_t records = jsonConfig.contains("recorder_records") ? jsonConfig["recorder_records"].get<uint64_t>() : GPIO_RECORDER_DEFAULT_RECORDS;
+        CGPIORecorder::getInstance().open(jsonConfig["recorder_path"].get<std::string>(), records);
+    }
 }
 
+
 bool de::gpio::CGPIOMain::init(const std::string& module_key)
 {
     m_module_key = module_key;
 
+    initStatusFromConfigFile();
+
     m_gpio_driver.init();
+
+    CGPIOActuator::getInstance().start(m_actuator_queue_size);
     
-    m_exit_thread = false; 
+    m_scheduler.addTask("status_internal", 1000000, [this](){ publishStatus(true); });
+    m_scheduler.addTask("status_external", 10000000, [this](){ publishStatus(false); });
+    // changed pins are sent by scheduler thread - writers only mark them.
+    m_scheduler.addTask("status_notify", GPIO_NOTIFIER_TICK_US, [](){ CGPIONotifier::getInstance().flush(get_time_usec()); });
+    CGPIONotifier::getInstance().start();
+    if (m_scheduler_stats_usec != 0)
+    {
+        m_scheduler.enableStats(m_scheduler_stats_usec);
+    }
 
+    if (CGPIOLatency::getInstance().isEnabled())
+    {
+        // dump is requested by SIGUSR1.
+        m_scheduler.addTask("latency_dump", 1000000, [](){
+            CGPIOLatency& latency = CGPIOLatency::getInstance();
+            if (latency.takeDumpRequest()) latency.dump();
+        });
 
-    m_scheduler_thread = std::thread{[&](){ loopScheduler(); }};
+        if (m_latency_report_usec != 0)
+        {
+            m_scheduler.addTask("latency_report", m_latency_report_usec, [](){ CGPIO_Facade::getInstance().API_sendLatencyReport("", false); });
+        }
+    }
 
-    
-    return true;
+    if ((m_gpio_driver.getEncoders().getCount() != 0) && (m_encoder_report_usec != 0))
+    {
+        m_scheduler.addTask("encoder_report", m_encoder_report_usec, [](){ CGPIO_Facade::getInstance().API_sendEncoderStatus("", -1, GPIO_ENCODER_READER_REPORT, false); });
+    }
+
+    // PULSE_INPUT pins can be configured at any time - report sends nothing without them.
+    if (m_pulse_report_usec != 0)
+    {
+        m_scheduler.addTask("pulse_report", m_pulse_report_usec, [](){ CGPIO_Facade::getInstance().API_sendPulseStatus("", false); });
+    }
+
+    if (m_gpio_driver.getSampler().isEnabled() && (m_sampling_report_usec != 0))
+    {
+        m_scheduler.addTask("input_sampling", m_sampling_report_usec, [](){ CGPIO_Facade::getInstance().API_sendInputSampling("", false); });
+    }
+
+    if (m_actuator_stats_usec != 0)
+    {
+        m_scheduler.addTask("actuator_stats", m_actuator_stats_usec, [](){ CGPIO_Facade::getInstance().API_sendActuatorStats("", false); });
+    }
+
+    return m_scheduler.start();
 }
 
 bool de::gpio::CGPIOMain::uninit()
 {
-    m_exit_thread = true;
-
-    // Wait for the thread to finish
-    m_scheduler_thread.join();
+    m_scheduler.stop();
+    CGPIONotifier::getInstance().stop();
+    CGPIOActuator::getInstance().uninit();
+    CGPIOSequencer::getInstance().uninit();
     
     return true;
 }
\ No newline at end of file
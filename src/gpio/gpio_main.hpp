@@ -6,6 +6,8 @@
 #include "gpio_facade.hpp"
 #include "gpio_parser.hpp"
 #include "gpio_driver.hpp"
+#include "gpio_scheduler.hpp"
+#include "gpio_actuator.hpp"
 
 #include "../de_common/helpers/json_nlohmann.hpp"
 using Json_de = nlohmann::json;
@@ -55,7 +57,11 @@ namespace gpio
             
             bool init (const std::string& module_key);
             bool uninit ();
-            void loopScheduler();
+
+        private:
+
+            void initStatusFromConfigFile ();
+            void publishStatus (const bool internal);
 
         public:
             
@@ -74,12 +80,38 @@ namespace gpio
 
         private:
 
-            u_int64_t m_counter = 0;
-            std::thread m_scheduler_thread;
+            CGPIOScheduler m_scheduler;
 
             std::string m_module_key;
-            
-            bool m_exit_thread = true;
+
+            // scheduler timing is printed at this interval. 0 disables.
+            uint64_t m_scheduler_stats_usec = 0;
+
+            // command latency report is sent at this interval when tracing is enabled. 0 disables.
+            uint64_t m_latency_report_usec = 60000000;
+
+            // encoder status is sent at this interval when encoders are configured. 0 - on request only.
+            uint64_t m_encoder_report_usec = 1000000;
+
+            // pulse measurements of PULSE_INPUT pins are sent at this interval. 0 disables.
+            uint64_t m_pulse_report_usec = 1000000;
+
+            // input sampling summary is sent at this interval when sampling is enabled. 0 disables.
+            uint64_t m_sampling_report_usec = 1000000;
+
+            // commands per actuator lane.
+            uint64_t m_actuator_queue_size = GPIO_ACTUATOR_DEFAULT_QUEUE;
+            // actuator queue counters are sent at this interval. 0 disables.
+            uint64_t m_actuator_stats_usec = 0;
+
+            // pins changed since last internal/external status publish.
+            uint64_t m_internal_dirty_mask = 0;
+            uint64_t m_external_dirty_mask = 0;
+            // full status is sent at these intervals, otherwise only changed pins.
+            uint64_t m_internal_keyframe_usec = 10000000;
+            uint64_t m_external_keyframe_usec = 30000000;
+            uint64_t m_last_internal_keyframe_usec = 0;
+            uint64_t m_last_external_keyframe_usec = 0;
             
             CGPIODriver &m_gpio_driver = CGPIODriver::getInstance();
 
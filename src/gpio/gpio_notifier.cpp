@@ -0,0 +1,85 @@
+#include "gpio_driver.hpp"
+#include "gpio_facade.hpp"
+#include "gpio_notifier.hpp"
+
+
+using namespace de::gpio;
+
+
+void CGPIONotifier::setTypeInterval (const uint gpio_type, const int64_t interval_us)
+{
+    if (gpio_type >= GPIO_NOTIFIER_TYPES) return ;
+
+    m_type_interval_us[gpio_type] = interval_us < 0 ? 0 : interval_us;
+}
+
+
+void CGPIONotifier::setPinInterval (const uint pin_number, const int64_t interval_us)
+{
+    if (pin_number >= GPIO_NOTIFIER_PINS) return ;
+
+    m_pin_interval_us[pin_number] = interval_us < 0 ? 0 : interval_us;
+}
+
+
+/**
+ * @brief send pending pins whose interval elapsed - scheduler thread only.
+ */
+void CGPIONotifier::flush (const uint64_t now_us)
+{
+    m_pending_mask |= m_changed_mask.exchange(0, std::memory_order_acquire);
+    if (m_pending_mask == 0) return ;
+
+    // gpio_type of pins is read from a snapshot - the registry belongs to configuring threads.
+    GPIO_SNAPSHOT snapshot;
+    CGPIODriver::getInstance().getGPIOSnapshot(snapshot, m_pending_mask);
+
+    uint64_t due_mask = 0;
+    for (uint64_t pins = m_pending_mask; pins; pins &= pins - 1)
+    {
+        const uint pin_number = __builtin_ctzll(pins);
+
+        const int64_t interval_us = getPinInterval(snapshot, pin_number);
+        if (now_us - m_last_sent_us[pin_number] < static_cast<uint64_t>(interval_us)) continue;
+
+        due_mask |= 1ull << pin_number;
+        m_last_sent_us[pin_number] = now_us;
+    }
+
+    if (due_mask == 0) return ;
+
+    m_pending_mask &= ~due_mask;
+    send(due_mask);
+}
+
+
+int64_t CGPIONotifier::getPinInterval (const GPIO_SNAPSHOT& snapshot, const uint pin_number) const
+{
+    if (m_pin_interval_us[pin_number] != GPIO_NOTIFIER_NO_INTERVAL) return m_pin_interval_us[pin_number];
+
+    if ((pin_number < MAX_GPIO_PINS) && (snapshot.used_mask & (1ull << pin_number)))
+    {
+        const uint gpio_type = snapshot.gpios[pin_number].gpio_type;
+        if ((gpio_type < GPIO_NOTIFIER_TYPES) && (m_type_interval_us[gpio_type] != GPIO_NOTIFIER_NO_INTERVAL))
+        {
+            return m_type_interval_us[gpio_type];
+        }
+    }
+
+    return m_interval_us;
+}
+
+
+/**
+ * @brief current status of pins - removed pins are skipped by the snapshot.
+ */
+void CGPIONotifier::send (const uint64_t pin_mask)
+{
+    if (m_send_handler)
+    {
+        m_send_handler(pin_mask);
+        return ;
+    }
+
+    CGPIO_Facade::getInstance().API_sendGPIOStatus("", pin_mask, false);
+}
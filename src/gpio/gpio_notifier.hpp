@@ -0,0 +1,142 @@
+#ifndef GPIO_NOTIFIER_H_
+#define GPIO_NOTIFIER_H_
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <sys/types.h>
+
+#include "gpio_driver.hpp"
+
+
+#define GPIO_NOTIFIER_PINS 64
+#define GPIO_NOTIFIER_TYPES 2 // ENUM_GPIO_TYPE::COUNT
+#define GPIO_NOTIFIER_DEFAULT_INTERVAL_US 100000
+#define GPIO_NOTIFIER_TICK_US 10000 // pending notifications are checked at this interval
+#define GPIO_NOTIFIER_NO_INTERVAL -1
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief Rate limited status notifications of changed pins.
+     *
+     * Writers only mark changed pins in an atomic mask, so the receive, actuator and event
+     * threads never serialize status. flush() runs on scheduler thread every GPIO_NOTIFIER_TICK_US
+     * and sends pins whose minimum interval elapsed since their last notification.
+     * A pin changed again within its interval stays pending and is sent when the interval ends,
+     * with its state at that time - many changes become one message and the final state
+     * is always reported.
+     *
+     * Interval of a pin is its own if set, else the interval of its gpio_type, else the default.
+     * Interval 0 disables merging over time only - changes still wait for the next tick,
+     * so a pin is reported at most once per GPIO_NOTIFIER_TICK_US.
+     * Changes are sent immediately while flush() is not started.
+     */
+    class CGPIONotifier
+    {
+        public:
+
+            static CGPIONotifier& getInstance()
+            {
+                static CGPIONotifier instance;
+
+                return instance;
+            }
+
+            CGPIONotifier(CGPIONotifier const&)            = delete;
+            void operator=(CGPIONotifier const&)         = delete;
+
+            // status of pins in pin_mask is due - status message of CGPIO_Facade if not set.
+            typedef std::function<void(const uint64_t pin_mask)> SEND_HANDLER;
+
+
+        private:
+
+            CGPIONotifier()
+            {
+                m_pin_interval_us.fill(GPIO_NOTIFIER_NO_INTERVAL);
+                m_type_interval_us.fill(GPIO_NOTIFIER_NO_INTERVAL);
+                m_last_sent_us.fill(0);
+            }
+
+
+        public:
+
+            ~CGPIONotifier ()
+            {
+
+            }
+
+        public:
+
+            inline void setInterval (const int64_t interval_us)
+            {
+                m_interval_us = interval_us < 0 ? 0 : interval_us;
+            }
+
+            inline void setSendHandler (SEND_HANDLER send_handler)
+            {
+                m_send_handler = send_handler;
+            }
+
+            void setTypeInterval (const uint gpio_type, const int64_t interval_us);
+            void setPinInterval (const uint pin_number, const int64_t interval_us);
+
+            inline void start ()
+            {
+                m_running.store(true, std::memory_order_release);
+            }
+
+            inline void stop ()
+            {
+                m_running.store(false, std::memory_order_release);
+            }
+
+            /**
+             * @brief pins in pin_mask changed - any thread.
+             */
+            inline void markChanged (const uint64_t pin_mask)
+            {
+                if (pin_mask == 0) return ;
+
+                if (!m_running.load(std::memory_order_acquire))
+                {
+                    send(pin_mask);
+                    return ;
+                }
+
+                m_changed_mask.fetch_or(pin_mask, std::memory_order_release);
+            }
+
+            void flush (const uint64_t now_us);
+
+        private:
+
+            int64_t getPinInterval (const GPIO_SNAPSHOT& snapshot, const uint pin_number) const;
+            void send (const uint64_t pin_mask);
+
+        private:
+
+            std::atomic<bool> m_running {false};
+            std::atomic<uint64_t> m_changed_mask {0};
+
+            // intervals are set before start().
+            int64_t m_interval_us = GPIO_NOTIFIER_DEFAULT_INTERVAL_US;
+            std::array<int64_t, GPIO_NOTIFIER_TYPES> m_type_interval_us;
+            std::array<int64_t, GPIO_NOTIFIER_PINS> m_pin_interval_us;
+            SEND_HANDLER m_send_handler;
+
+            // scheduler thread only.
+            uint64_t m_pending_mask = 0;
+            std::array<uint64_t, GPIO_NOTIFIER_PINS> m_last_sent_us;
+    };
+
+}
+}
+
+#endif
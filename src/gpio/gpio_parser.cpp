@@ -1,28 +1,32 @@
+#include <cstring>
+#include <algorithm>
+#include <array>
 #include "../global.hpp"
 #include "../de_common/helpers/colors.hpp"
 #include "../de_common/helpers/helpers.hpp"
 #include "gpio_parser.hpp"
+#include "gpio_protocol.hpp"
 #include "gpio_facade.hpp"
 #include "gpio_main.hpp"
+#include "gpio_latency.hpp"
+#include "gpio_recorder.hpp"
+#include "gpio_actuator.hpp"
 
 using namespace de::gpio;
 
-#ifdef TEST_MODE_NO_WIRINGPI_LINK
 
-#else
-#include <wiringPi.h>
-#endif
 
-
-
-/// @brief Parses & executes messages received from uavos_comm"
+/// @brief Parses messages received from uavos_comm" - commands are executed by CGPIOActuator
 /// @param parsed JSON message received from uavos_comm 
 /// @param full_message 
 /// @param full_message_length 
 void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_message, const int & full_message_length)
 {
     const int messageType = andruav_message[ANDRUAV_PROTOCOL_MESSAGE_TYPE].get<int>();
-    bool is_binary = !(full_message[full_message_length-1]==125 || (full_message[full_message_length-2]==125));   // "}".charCodeAt(0)  IS TEXT / BINARY Msg  
+    // binary payload follows the '\0' that ends the JSON header - text may only end with '\0'.
+    // payload bytes can be anything, so its last byte cannot tell text from binary.
+    const char * separator = static_cast<const char *>(memchr(full_message, 0x0, full_message_length));
+    const bool is_binary = (separator != nullptr) && (separator < full_message + full_message_length - 1);
     
 
     uint32_t permission = 0;
@@ -37,7 +41,6 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
         is_system = true;
     }
 
-    UNUSED(is_system);
     UNUSED(permission);
 
     #ifdef DEBUG
@@ -54,7 +57,7 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
 
     else
     {
-        Json_de cmd = andruav_message[ANDRUAV_PROTOCOL_MESSAGE_CMD];
+        Json_de& cmd = andruav_message[ANDRUAV_PROTOCOL_MESSAGE_CMD];
         
         switch (messageType)
         {
@@ -67,8 +70,6 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
                 * 
                 */
 
-                const Json_de cmd = andruav_message[ANDRUAV_PROTOCOL_MESSAGE_CMD];
-        
                 if (cmd.contains("i")) 
                 {   // if module_key is specified then check if it is the same as the current module key.
 
@@ -82,6 +83,12 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
                     }
                 }
 
+                if (is_binary)
+                {   // compact binary command - decoded directly from message buffer.
+                    parseBinaryAction(full_message, full_message_length, is_system);
+                    break;
+                }
+
                 if (!cmd.contains("a") || !cmd["a"].is_number_integer()) return ;
                     
                 
@@ -103,6 +110,8 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
                          * *    SOFT_TONE_OUTPUT	    5
                          * *    PWM_TONE_OUTPUT		    6
                          * *    PM_OFF		            7   // to input / release line
+                         * *    PULSE_INPUT             10  // input with pulse count, frequency & duty
+                         * *    ENCODER_INPUT           11  // input that is a channel of a quadrature encoder
                          *  
                          * 'n': gpio name
                          * 'p': gpio number
@@ -121,12 +130,11 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
                         }
                         if (cmd.contains("n"))
                         {
-                            gpio.pin_name = cmd["n"].get<int>();
+                            gpio.pin_name = cmd["n"].get<std::string>();
                         }
-                        m_gpio_driver.configurePort (gpio);
 
-                        // Send updated GPIO Status
-                        CGPIO_Facade::getInstance().API_sendGPIOStatus("", true);
+                        onCommand(GPIO_LATENCY_PORT_CONFIG, gpio.pin_number);
+                        submitConfigs({gpio});
 
                     }
                     break;
@@ -137,58 +145,108 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
                          * 'n': gpio name       // 1st priority
                          * 'p': gpio number     // 2nd priority
                          * 'v': value           // mandatory
+                         * 
+                         * OR
+                         * 
+                         * 'l': [{'n'|'p', 'v', 'd'}, ...]  // batch - all digital outputs change together.
                          */
 
+                        if (cmd.contains("l"))
+                        {
+                            parsePortWriteBatch(cmd["l"], is_system);
+                            break;
+                        }
+
                         // Mandatory value check
                         if (!cmd.contains("v")) return;
 
-                        // Extract the GPIO value
-                        const uint value = cmd["v"].get<int>();
-                        
-                        // Find the GPIO object
-                        const GPIO* gpio = nullptr;
+                        // pin mode is checked by actuator - PWM pins are written only with a width.
+                        std::vector<GPIO_WRITE_COMMAND> commands(1);
+                        std::vector<std::string> names(1);
+                        GPIO_WRITE_COMMAND& command = commands[0];
+                        command.value = cmd["v"].get<int>();
+                        command.has_pwm_width = cmd.contains("d");
+                        command.pwm_width = command.has_pwm_width ? cmd["d"].get<uint>() : 0;
+
                         if (cmd.contains("n")) {
                             // Priority for named GPIO
-                            gpio = m_gpio_driver.getGPIOByName(cmd["n"].get<std::string>());
+                            names[0] = cmd["n"].get<std::string>();
+                            command.pin_number = MAX_GPIO_PINS;
                         } else if (cmd.contains("p")) {
                             // Fallback to GPIO number
-                            gpio = m_gpio_driver.getGPIOByNumber(cmd["p"].get<uint>());
+                            command.pin_number = cmd["p"].get<uint>();
+                        } else {
+                            return;
                         }
 
-                        // Validate GPIO
-                        if (gpio == nullptr) return; // GPIO not found
+                        // status of changed pin is sent by actuator.
+                        submitPortWrites(commands, names, command.has_pwm_width ? GPIO_LATENCY_PORT_WRITE_PWM : GPIO_LATENCY_PORT_WRITE, is_system);
+                    }
+                    break;
 
+                    case GPIO_ACTION_PATTERN:
+                    {
+                        /**
+                         * 's': [{'m': pin mask | 'n': gpio name, 'v': level, 'd': duration usec}, ...]
+                         *      // OPTIONAL - running pattern is stopped if missing. 'd' >= GPIO_SEQUENCER_MIN_STEP_US
+                         * 'r': repeat pattern     // OPTIONAL - default one-shot. cycle >= GPIO_SEQUENCER_MIN_CYCLE_US and busy
+                         *                         // wait of GPIO_SEQUENCER_SPIN_US per step <= GPIO_SEQUENCER_MAX_SPIN_PERCENT of it.
+                         */
+                        if (!cmd.contains("s"))
+                        {   // stopping outputs is served ahead of other commands - patterns queued before it are dropped.
+                            m_pattern_generation.fetch_add(1, std::memory_order_relaxed);
+                            CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_PRIORITY, [](){
+                                CGPIOSequencer::getInstance().stop();
+                            });
+                            break;
+                        }
 
-                        // Determine if an event should be triggered
-                        bool trigger_event = false;
-                        
-                        
-                        // Handle GPIO write based on mode
-                        if (gpio->pin_mode == OUTPUT) {
-                            if (gpio->pin_value != value) 
-                            {
-                                if (gpio->pin_name != "power_led")
-                                {
-                                    trigger_event = true;
-                                }
-                            }
-                            m_gpio_driver.writePin(gpio->pin_number, value);
-                        } else if (gpio->pin_mode == PWM_OUTPUT) {
-                            // PWM mode requires PWM width
-                            if (!cmd.contains("d")) return;
+                        parsePattern(cmd["s"], cmd.contains("r") && cmd["r"].get<bool>());
+                    }
+                    break;
 
-                            const uint pwm_width = cmd["d"].get<uint>();
-                            if (gpio->pin_pwm_width != pwm_width) trigger_event = true;
+                    case GPIO_ACTION_ENCODER:
+                    {
+                        /**
+                         * 'e': encoder index or name  // OPTIONAL - all encoders if missing.
+                         * 'z': zero position          // OPTIONAL - current position becomes 0.
+                         * status is sent to sender.
+                         */
+                        CGPIOEncoder& encoders = m_gpio_driver.getEncoders();
 
-                            m_gpio_driver.writePWM(gpio->pin_number, value, pwm_width);
+                        int encoder = -1;
+                        if (cmd.contains("e"))
+                        {
+                            encoder = cmd["e"].is_string() ? encoders.findEncoder(cmd["e"].get<std::string>()) : cmd["e"].get<int>();
+                            if ((encoder < 0) || (encoder >= static_cast<int>(encoders.getCount()))) break;
                         }
-                        
 
-                        // Send updated GPIO Status
-                        if (trigger_event)
+                        const bool zero = cmd.contains("z") && cmd["z"].get<bool>();
+
+                        std::string target_party_id = "";
+                        if (validateField(andruav_message, ANDRUAV_PROTOCOL_SENDER, Json_de::value_t::string))
                         {
-                            CGPIO_Facade::getInstance().API_sendSingleGPIOStatus("", *gpio, false);
+                            target_party_id = andruav_message[ANDRUAV_PROTOCOL_SENDER].get<std::string>();
                         }
+
+                        onCommand(GPIO_LATENCY_STATUS);
+                        CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_BULK, [&encoders, encoder, zero, target_party_id](){
+                            CGPIOLatency::getInstance().markDispatch();
+
+                            if (zero)
+                            {
+                                if (encoder >= 0)
+                                {
+                                    encoders.zero(encoder);
+                                }
+                                else
+                                {
+                                    for (uint i = 0; i < encoders.getCount(); ++i) encoders.zero(i);
+                                }
+                            }
+
+                            CGPIO_Facade::getInstance().API_sendEncoderStatus(target_party_id, encoder, GPIO_ENCODER_READER_REQUEST, false);
+                        });
                     }
                     break;
 
@@ -219,18 +277,44 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
                 {
 
                     case TYPE_AndruavMessage_GPIO_STATUS:
-                        if (cmd.contains("p")) {
-                            const GPIO* gpio = nullptr;
-                            gpio = m_gpio_driver.getGPIOByNumber(cmd["p"].get<uint>());
-                            if (gpio!= nullptr) 
+                    {
+                        /**
+                         * 'p': gpio number     // OPTIONAL - all pins if missing.
+                         * 'f': status format   // OPTIONAL - GPIO_STATUS_FORMAT_JSON / GPIO_STATUS_FORMAT_BINARY
+                         *                      // sender gets status in this format from now on. ignored if not an integer.
+                         */
+                        std::string target_party_id = "";
+                        int status_format = -1;
+                        if (cmd.contains("f") && cmd["f"].is_number_integer() && validateField(andruav_message, ANDRUAV_PROTOCOL_SENDER, Json_de::value_t::string))
+                        {
+                            target_party_id = andruav_message[ANDRUAV_PROTOCOL_SENDER].get<std::string>();
+                            status_format = cmd["f"].get<int>();
+                        }
+
+                        const int pin_number = cmd.contains("p") ? cmd["p"].get<int>() : -1;
+
+                        onCommand(GPIO_LATENCY_STATUS);
+                        CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_BULK, [this, target_party_id, status_format, pin_number](){
+                            CGPIOLatency::getInstance().markDispatch();
+
+                            if (status_format != -1)
                             {
-                                CGPIO_Facade::getInstance().API_sendSingleGPIOStatus("", *gpio, false);
-                                break;
+                                CGPIO_Facade::getInstance().setPeerStatusFormat(target_party_id, status_format);
                             }
-                            // if pin number is not found then send all GPIO status
-                        }
 
-                        CGPIO_Facade::getInstance().API_sendGPIOStatus("", false);
+                            if (pin_number >= 0) {
+                                const GPIO* gpio = m_gpio_driver.getGPIOByNumber(pin_number);
+                                if (gpio!= nullptr) 
+                                {
+                                    CGPIO_Facade::getInstance().API_sendSingleGPIOStatus(target_party_id, *gpio, false);
+                                    return;
+                                }
+                                // if pin number is not found then send all GPIO status
+                            }
+
+                            CGPIO_Facade::getInstance().API_sendGPIOStatus(target_party_id, false);
+                        });
+                    }
 
                     break;
 
@@ -248,8 +332,6 @@ void CGPIOParser::parseMessage (Json_de &andruav_message, const char * full_mess
         }
 
     }
-
-    UNUSED(is_binary);
 }
 
 /**
@@ -287,4 +369,318 @@ void CGPIOParser::parseRemoteExecute (Json_de &andruav_message)
     #endif 
 
     UNUSED (remoteCommand);
+}
+
+
+/**
+ * @brief GPIO_ACTION_PORT_WRITE batch form.
+ * 
+ * @param pins [{'n': name | 'p': number, 'v': value, 'd': pwm width}, ...]
+ * @param is_system sender is communication server.
+ */
+void CGPIOParser::parsePortWriteBatch (const Json_de &pins, const bool is_system)
+{
+    if (!pins.is_array()) return ;
+
+    std::vector<GPIO_WRITE_COMMAND> commands;
+    std::vector<std::string> names;
+    commands.reserve(pins.size());
+    names.reserve(pins.size());
+
+    for (const auto& pin : pins)
+    {
+        if (!pin.contains("v")) continue;
+
+        GPIO_WRITE_COMMAND command;
+        std::string name;
+        if (pin.contains("n")) {
+            name = pin["n"].get<std::string>();
+            command.pin_number = MAX_GPIO_PINS;
+        } else if (pin.contains("p")) {
+            command.pin_number = pin["p"].get<uint>();
+        } else {
+            continue;
+        }
+
+        command.value = pin["v"].get<int>();
+        command.has_pwm_width = pin.contains("d");
+        command.pwm_width = command.has_pwm_width ? pin["d"].get<uint>() : 0;
+        
+        commands.push_back(command);
+        names.push_back(std::move(name));
+    }
+
+    submitPortWrites(commands, names, GPIO_LATENCY_PORT_WRITE_BATCH, is_system);
+}
+
+
+/**
+ * @brief queue GPIO_ACTION_PORT_WRITE writes - names[i] addresses commands[i] if not empty.
+ * The registry belongs to actuator thread, so names are looked up in a snapshot and
+ * pins that are not configured are dropped by actuator. While a PORT_CONFIG is queued the
+ * snapshot does not show it yet - named writes are then resolved by actuator behind it.
+ *
+ * @param action GPIO_LATENCY_* command kind.
+ */
+void CGPIOParser::submitPortWrites (std::vector<GPIO_WRITE_COMMAND>& commands, std::vector<std::string>& names, const int action, const bool is_system)
+{
+    const bool named = std::any_of(names.begin(), names.end(), [](const std::string& name){ return !name.empty(); });
+
+    if (named && (m_pending_configs.load(std::memory_order_acquire) != 0))
+    {
+        // pins are known only when task runs - a priority write to them queued meanwhile wins.
+        CGPIOActuator& actuator = CGPIOActuator::getInstance();
+        std::array<uint32_t, MAX_GPIO_PINS> generations;
+        for (uint pin_number = 0; pin_number < MAX_GPIO_PINS; ++pin_number)
+        {
+            generations[pin_number] = actuator.getPinGeneration(pin_number);
+        }
+
+        onCommand(action);
+        actuator.submitTask(GPIO_ACTUATOR_LANE_NORMAL, [this, commands = std::move(commands), names = std::move(names), generations]() mutable {
+            CGPIOActuator& actuator = CGPIOActuator::getInstance();
+            for (size_t i = 0; i < commands.size(); ++i)
+            {
+                if (!names[i].empty())
+                {
+                    const GPIO* gpio = m_gpio_driver.getGPIOByName(names[i]);
+                    commands[i].pin_number = (gpio != nullptr) ? gpio->pin_number : MAX_GPIO_PINS;
+                }
+
+                const uint pin_number = commands[i].pin_number;
+                if ((pin_number < MAX_GPIO_PINS) && (generations[pin_number] != actuator.getPinGeneration(pin_number)))
+                {
+                    commands[i].pin_number = MAX_GPIO_PINS;
+                }
+            }
+
+            actuator.applyWrites(commands.data(), commands.size());
+        });
+        return ;
+    }
+
+    if (named)
+    {
+        m_gpio_driver.getGPIOSnapshot(m_snapshot);
+
+        size_t count = 0;
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            if (!names[i].empty())
+            {
+                const int pin_number = findPin(names[i]);
+                if (pin_number < 0) continue; // GPIO not found
+                commands[i].pin_number = pin_number;
+            }
+            commands[count++] = commands[i];
+        }
+        commands.resize(count);
+    }
+
+    if (commands.empty()) return ;
+
+    onCommand(action, (commands.size() == 1) ? commands[0].pin_number : GPIO_RECORD_NO_PIN);
+    CGPIOActuator::getInstance().submitWrites(getWriteLane(commands.data(), commands.size(), is_system), commands.data(), commands.size());
+}
+
+
+/**
+ * @brief queue PORT_CONFIG of pins. Writes parsed until it is executed keep behind it.
+ */
+void CGPIOParser::submitConfigs (std::vector<GPIO> gpios)
+{
+    m_pending_configs.fetch_add(1, std::memory_order_relaxed);
+
+    const bool queued = CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_NORMAL, [this, gpios = std::move(gpios)](){
+        CGPIOLatency::getInstance().markDispatch();
+        for (const GPIO& gpio : gpios)
+        {
+            m_gpio_driver.configurePort (gpio);
+        }
+
+        // snapshot shows these pins from now on.
+        m_pending_configs.fetch_sub(1, std::memory_order_release);
+
+        // Send updated GPIO Status
+        CGPIO_Facade::getInstance().API_sendGPIOStatus("", true);
+    });
+
+    if (!queued) m_pending_configs.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief number of a configured pin by name in m_snapshot.
+ * @return -1 if not found.
+ */
+int CGPIOParser::findPin (const std::string& pin_name) const
+{
+    for (uint64_t pins = m_snapshot.used_mask; pins; pins &= pins - 1)
+    {
+        const GPIO_STATE& state = m_snapshot.gpios[__builtin_ctzll(pins)];
+        if ((state.name_length == pin_name.size()) && (memcmp(state.pin_name, pin_name.data(), state.name_length) == 0))
+        {
+            return state.pin_number;
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief GPIO_ACTION_PATTERN steps - replaces running pattern.
+ * 
+ * @param steps [{'m': pin mask | 'n': gpio name, 'v': level, 'd': duration usec}, ...]
+ */
+void CGPIOParser::parsePattern (const Json_de &steps, const bool loop)
+{
+    if (!steps.is_array()) return ;
+
+    GPIO_SEQUENCE sequence;
+    sequence.loop = loop;
+    sequence.steps.reserve(steps.size());
+
+    // pin of a named step is looked up by actuator - a queued PORT_CONFIG may define it.
+    std::vector<std::string> names;
+    names.reserve(steps.size());
+
+    for (const auto& step : steps)
+    {
+        if (!step.contains("v") || !step.contains("d")) return ;
+
+        GPIO_SEQUENCE_STEP sequence_step;
+        sequence_step.pin_mask = 0;
+        sequence_step.level = step["v"].get<uint>();
+        sequence_step.duration_us = step["d"].get<uint32_t>();
+
+        std::string name;
+        if (step.contains("m"))
+        {
+            sequence_step.pin_mask = step["m"].get<uint64_t>();
+        }
+        else if (step.contains("n"))
+        {
+            name = step["n"].get<std::string>();
+        }
+
+        sequence.steps.push_back(sequence_step);
+        names.push_back(std::move(name));
+    }
+
+    // pattern is written by sequencer thread - total ends when it is accepted.
+    onCommand(GPIO_LATENCY_PATTERN);
+    const uint32_t generation = m_pattern_generation.load(std::memory_order_relaxed);
+    CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_NORMAL, [this, sequence = std::move(sequence), names = std::move(names), generation]() mutable {
+        CGPIOLatency::getInstance().markDispatch();
+
+        // a stop received after this pattern runs first on priority lane - pattern must not restart.
+        if (m_pattern_generation.load(std::memory_order_relaxed) != generation) return ;
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (names[i].empty()) continue;
+
+            const GPIO* gpio = m_gpio_driver.getGPIOByName(names[i]);
+            if (gpio == nullptr)
+            {
+                std::cout << _ERROR_CONSOLE_TEXT_ << "Invalid GPIO pattern - unknown pin " << names[i] << "." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+                return ;
+            }
+            sequence.steps[i].pin_mask = 1ull << gpio->pin_number;
+        }
+
+        if (!CGPIOSequencer::getInstance().start(sequence))
+        {
+            std::cout << _ERROR_CONSOLE_TEXT_ << "Invalid GPIO pattern - " << sequence.steps.size() << " steps." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        }
+    });
+}
+
+
+/**
+ * @brief binary GPIO_ACTION message. Payload follows the JSON header after a '\0'.
+ * see CGPIOCommandCodec for format.
+ */
+void CGPIOParser::parseBinaryAction (const char * full_message, const int full_message_length, const bool is_system)
+{
+    const char * binary_message = static_cast<const char *>(memchr(full_message, 0x0, full_message_length));
+    if (binary_message == nullptr) return ;
+    binary_message++;
+
+    const uint8_t * payload = reinterpret_cast<const uint8_t *>(binary_message);
+    const size_t payload_length = full_message_length - (binary_message - full_message);
+
+    uint action;
+    uint count;
+    if (!CGPIOCommandCodec::decodeHeader(payload, payload_length, action, count)) return ;
+
+    switch (action)
+    {
+        case GPIO_ACTION_PORT_WRITE:
+        {
+            GPIO_WRITE_COMMAND commands[GPIO_PARSER_MAX_BINARY_WRITES];
+            size_t command_count;
+            if (!CGPIOCommandCodec::decodeWrite(payload, payload_length, commands, GPIO_PARSER_MAX_BINARY_WRITES, command_count)) return ;
+
+            onCommand(GPIO_LATENCY_BINARY_WRITE);
+            CGPIOActuator::getInstance().submitWrites(getWriteLane(commands, command_count, is_system), commands, command_count);
+        }
+        break;
+
+        case GPIO_ACTION_PORT_CONFIG:
+        {
+            std::vector<GPIO> gpios;
+            if (!CGPIOCommandCodec::decodeConfig(payload, payload_length, gpios)) return ;
+
+            onCommand(GPIO_LATENCY_BINARY_CONFIG);
+            submitConfigs(std::move(gpios));
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+
+/**
+ * @brief actuator lane of writes. Writes are kept in one lane so they are applied together,
+ * the priority lane if any pin is a SYSTEM pin or sender is communication server.
+ * gpio_type is read from a snapshot. While a PORT_CONFIG is queued writes stay in normal lane
+ * behind it, as it may create or change their pins.
+ */
+uint CGPIOParser::getWriteLane (const GPIO_WRITE_COMMAND* commands, const size_t count, const bool is_system)
+{
+    if (m_pending_configs.load(std::memory_order_acquire) != 0) return GPIO_ACTUATOR_LANE_NORMAL;
+
+    if (is_system) return GPIO_ACTUATOR_LANE_PRIORITY;
+
+    uint64_t pin_mask = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (commands[i].pin_number < MAX_GPIO_PINS) pin_mask |= 1ull << commands[i].pin_number;
+    }
+
+    m_gpio_driver.getGPIOSnapshot(m_snapshot, pin_mask);
+    for (uint64_t pins = m_snapshot.used_mask; pins; pins &= pins - 1)
+    {
+        if (m_snapshot.gpios[__builtin_ctzll(pins)].gpio_type == ENUM_GPIO_TYPE::SYSTEM) return GPIO_ACTUATOR_LANE_PRIORITY;
+    }
+
+    return GPIO_ACTUATOR_LANE_NORMAL;
+}
+
+
+
+/**
+ * @brief command is parsed and about to be queued - traced & recorded.
+ * 
+ * @param action GPIO_LATENCY_* command kind.
+ * @param pin_number target pin or GPIO_RECORD_NO_PIN.
+ */
+void CGPIOParser::onCommand (const int action, const uint pin_number)
+{
+    CGPIOLatency::getInstance().markParsed(action);
+    CGPIORecorder::getInstance().record(GPIO_RECORD_COMMAND, pin_number, action);
 }
\ No newline at end of file
@@ -1,11 +1,20 @@
 #ifndef GPIO_PARSER_H_
 #define GPIO_PARSER_H_
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "../de_common/helpers/json_nlohmann.hpp"
 using Json_de = nlohmann::json;
 
 #include "gpio_facade.hpp"
 #include "gpio_driver.hpp"
+#include "gpio_command_codec.hpp"
+#include "gpio_sequencer.hpp"
+#include "gpio_recorder.hpp"
+
+#define GPIO_PARSER_MAX_BINARY_WRITES 64 // records accepted in one binary PORT_WRITE
 
 namespace de
 {
@@ -13,7 +22,12 @@ namespace gpio
 {
 
     /**
-     * @brief This class parses messages received via communicator and executes it.
+     * @brief This class parses messages received via communicator and queues
+     * decoded commands to CGPIOActuator.
+     *
+     * parseMessage runs on the receive thread and never reads the pin registry - that belongs
+     * to the actuator thread. Pins are looked up in a snapshot, or by the actuator when the
+     * command depends on a PORT_CONFIG still queued.
      * 
      */
     class CGPIOParser
@@ -52,11 +66,28 @@ namespace gpio
             
         protected:
             void parseRemoteExecute (Json_de &andruav_message);
+            void parsePortWriteBatch (const Json_de &pins, const bool is_system);
+            void parsePattern (const Json_de &steps, const bool loop);
+            void parseBinaryAction (const char * full_message, const int full_message_length, const bool is_system);
+            void submitPortWrites (std::vector<GPIO_WRITE_COMMAND>& commands, std::vector<std::string>& names, const int action, const bool is_system);
+            void submitConfigs (std::vector<GPIO> gpios);
+            int findPin (const std::string& pin_name) const;
+            uint getWriteLane (const GPIO_WRITE_COMMAND* commands, const size_t count, const bool is_system);
+            void onCommand (const int action, const uint pin_number = GPIO_RECORD_NO_PIN);
    
 
         private:
             de::gpio::CGPIO_Facade& m_gpio_facade = de::gpio::CGPIO_Facade::getInstance();
             de::gpio::CGPIODriver& m_gpio_driver  = de::gpio::CGPIODriver::getInstance();                    
+
+            // pin lookups of receive thread - registry belongs to actuator thread.
+            GPIO_SNAPSHOT m_snapshot;
+
+            // PORT_CONFIG tasks queued and not executed yet - incremented by receive thread only.
+            std::atomic<uint> m_pending_configs {0};
+
+            // incremented by each pattern stop - a pattern queued before it is not started.
+            std::atomic<uint32_t> m_pattern_generation {0};
                 
     };
 
@@ -0,0 +1,17 @@
+#ifndef GPIO_PROTOCOL_H_
+#define GPIO_PROTOCOL_H_
+
+#include "../de_common/de_databus/messages.hpp"
+
+
+// GPIO_ACTION & GPIO_STATUS sub commands of this module.
+// GPIO_ACTION_PORT_CONFIG 1, GPIO_ACTION_PORT_WRITE 2, GPIO_ACTION_PORT_READ 3 & GPIO_ACTION_INFO 4 are in messages.hpp.
+#define GPIO_ACTION_PATTERN         5   // GPIO_ACTION: upload / start / stop an output pattern
+#define GPIO_ACTION_LATENCY_INFO    6   // GPIO_STATUS: command latency report
+#define GPIO_ACTION_SAMPLING_INFO   7   // GPIO_STATUS: input sampling summary
+#define GPIO_ACTION_PULSE_INFO      8   // GPIO_STATUS: pulse measurements
+#define GPIO_ACTION_ENCODER         9   // GPIO_ACTION: encoder status / zero - GPIO_STATUS: encoder status
+#define GPIO_ACTION_ACTUATOR_INFO   10  // GPIO_STATUS: actuator queue counters
+
+
+#endif
@@ -0,0 +1,107 @@
+#include "gpio_pulse.hpp"
+
+
+using namespace de::gpio;
+
+
+/**
+ * @brief start counting from zero - any thread. called when pin is configured.
+ * counters are cleared by the event thread at the next edge, so it stays their only writer.
+ */
+void CGPIOPulse::reset (const uint pin_number)
+{
+    if (pin_number >= GPIO_PULSE_PINS) return ;
+
+    m_pins[pin_number].reset_generation.fetch_add(1, std::memory_order_release);
+}
+
+
+/**
+ * @brief measurements of pins in pin_mask since previous call.
+ * @return number of pins measured.
+ */
+size_t CGPIOPulse::takeMeasurements (const uint64_t pin_mask, std::vector<PULSE_MEASUREMENT>& measurements)
+{
+    measurements.clear();
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (uint64_t pins = pin_mask; pins; pins &= pins - 1)
+    {
+        const uint pin_number = __builtin_ctzll(pins);
+        if (pin_number >= GPIO_PULSE_PINS) break;
+
+        PULSE_TOTALS totals;
+        readTotals(pin_number, totals);
+
+        // reset not applied yet - counters still belong to previous configuration.
+        const uint32_t generation = m_pins[pin_number].reset_generation.load(std::memory_order_acquire);
+        if (totals.generation != generation)
+        {
+            totals = PULSE_TOTALS();
+            totals.generation = generation;
+        }
+
+        PULSE_TOTALS& reported = m_reported[pin_number];
+        if (reported.generation != totals.generation)
+        {
+            reported = PULSE_TOTALS();
+        }
+        const uint64_t periods = totals.periods - reported.periods;
+        const uint64_t period_sum_ns = totals.period_sum_ns - reported.period_sum_ns;
+        const uint64_t highs = totals.highs - reported.highs;
+        const uint64_t high_sum_ns = totals.high_sum_ns - reported.high_sum_ns;
+
+        PULSE_MEASUREMENT measurement;
+        measurement.pin_number = pin_number;
+        measurement.count = totals.count;
+        measurement.pulses = totals.count - reported.count;
+        measurement.period_us = (periods == 0) ? 0.0 : period_sum_ns / 1000.0 / periods;
+        measurement.frequency = (period_sum_ns == 0) ? 0.0 : periods * 1e9 / period_sum_ns;
+        measurement.width_us = (highs == 0) ? 0.0 : high_sum_ns / 1000.0 / highs;
+        measurement.duty = (measurement.period_us == 0.0) ? 0.0 : measurement.width_us / measurement.period_us;
+        measurements.push_back(measurement);
+
+        reported = totals;
+    }
+
+    return measurements.size();
+}
+
+
+/**
+ * @brief consistent copy of counters of a pin - retried while event thread updates them.
+ */
+void CGPIOPulse::readTotals (const uint pin_number, PULSE_TOTALS& totals) const
+{
+    const PULSE_PIN& pin = m_pins[pin_number];
+
+    while (true)
+    {
+        const uint32_t seq = pin.seq.load(std::memory_order_acquire);
+        if (seq & 1) continue;
+
+        totals.generation = pin.generation.load(std::memory_order_acquire);
+        totals.count = pin.count.load(std::memory_order_acquire);
+        totals.period_sum_ns = pin.period_sum_ns.load(std::memory_order_acquire);
+        totals.periods = pin.periods.load(std::memory_order_acquire);
+        totals.high_sum_ns = pin.high_sum_ns.load(std::memory_order_acquire);
+        totals.highs = pin.highs.load(std::memory_order_acquire);
+
+        if (pin.seq.load(std::memory_order_relaxed) == seq) return ;
+    }
+}
+
+
+/**
+ * @brief zero counters & edges of a pin - event thread only, inside its seq update.
+ */
+void CGPIOPulse::clear (PULSE_PIN& pin, PULSE_EDGES& edges)
+{
+    pin.count.store(0, std::memory_order_release);
+    pin.period_sum_ns.store(0, std::memory_order_release);
+    pin.periods.store(0, std::memory_order_release);
+    pin.high_sum_ns.store(0, std::memory_order_release);
+    pin.highs.store(0, std::memory_order_release);
+    edges = PULSE_EDGES();
+}
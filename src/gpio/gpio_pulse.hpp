@@ -0,0 +1,176 @@
+#ifndef GPIO_PULSE_H_
+#define GPIO_PULSE_H_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <sys/types.h>
+
+
+#ifndef PULSE_INPUT
+#define PULSE_INPUT 10 // pin mode: INPUT whose pulses are counted & measured
+#endif
+
+#define GPIO_PULSE_PINS 54
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief pulses of a PULSE_INPUT pin since the previous measurement.
+     * values are 0 if no complete period was seen.
+     */
+    typedef struct PULSE_MEASUREMENT{
+            uint pin_number;
+            uint64_t count;             // rising edges since pin was configured
+            uint64_t pulses;            // rising edges since previous measurement
+            double frequency;           // Hz - mean of complete periods
+            double duty;                // high time / period: 0..1
+            double width_us;            // mean high time
+            double period_us;           // mean period
+        } PULSE_MEASUREMENT;
+
+
+    /**
+     * @brief Pulse counting and period/duty measurement of PULSE_INPUT pins.
+     *
+     * Edges come from the edge event thread with kernel timestamps, so measurements
+     * do not depend on how late the thread runs. Each pin has cumulative counters with a
+     * single writer - the event thread - and a sequence number, so readers take a consistent
+     * copy without a lock and interval values are differences between two copies.
+     *
+     * reset() only requests a new generation of counters. The event thread clears them at the
+     * next edge of the pin, and readers see zeros until then.
+     */
+    class CGPIOPulse
+    {
+        public:
+
+            CGPIOPulse()
+            {
+
+            }
+
+            CGPIOPulse(CGPIOPulse const&)          = delete;
+            void operator=(CGPIOPulse const&)     = delete;
+
+        public:
+
+            void reset (const uint pin_number);
+
+            /**
+             * @brief edge of a PULSE_INPUT pin - event thread only.
+             */
+            inline void onEdge (const uint pin_number, const uint level, const uint64_t timestamp_ns)
+            {
+                if (pin_number >= GPIO_PULSE_PINS) return ;
+
+                PULSE_PIN& pin = m_pins[pin_number];
+                PULSE_EDGES& edges = m_edges[pin_number];
+
+                const uint32_t seq = pin.seq.load(std::memory_order_relaxed);
+                pin.seq.store(seq + 1, std::memory_order_relaxed);
+
+                const uint32_t generation = pin.reset_generation.load(std::memory_order_acquire);
+                if (pin.generation.load(std::memory_order_relaxed) != generation)
+                {
+                    clear(pin, edges);
+                    pin.generation.store(generation, std::memory_order_release);
+                }
+
+                if (level)
+                {
+                    if (edges.last_rise_ns != 0)
+                    {
+                        add(pin.period_sum_ns, timestamp_ns - edges.last_rise_ns);
+                        add(pin.periods, 1);
+
+                        // a missing falling edge leaves high time unknown.
+                        if ((edges.last_fall_ns > edges.last_rise_ns) && !edges.high)
+                        {
+                            add(pin.high_sum_ns, edges.last_fall_ns - edges.last_rise_ns);
+                            add(pin.highs, 1);
+                        }
+                    }
+                    add(pin.count, 1);
+                    edges.last_rise_ns = timestamp_ns;
+                    edges.high = true;
+                }
+                else
+                {
+                    edges.last_fall_ns = timestamp_ns;
+                    edges.high = false;
+                }
+
+                pin.seq.store(seq + 2, std::memory_order_release);
+            }
+
+            size_t takeMeasurements (const uint64_t pin_mask, std::vector<PULSE_MEASUREMENT>& measurements);
+
+        private:
+
+            /**
+             * @brief cumulative counters - odd seq means writer is updating them.
+             */
+            typedef struct PULSE_PIN{
+                    std::atomic<uint32_t> seq {0};
+                    std::atomic<uint32_t> reset_generation {0};  // requested by reset()
+                    std::atomic<uint32_t> generation {0};        // of counters - event thread only
+                    std::atomic<uint64_t> count {0};
+                    std::atomic<uint64_t> period_sum_ns {0};
+                    std::atomic<uint64_t> periods {0};
+                    std::atomic<uint64_t> high_sum_ns {0};
+                    std::atomic<uint64_t> highs {0};
+                } PULSE_PIN;
+
+            /**
+             * @brief copy of counters taken by a reader.
+             */
+            typedef struct PULSE_TOTALS{
+                    uint32_t generation = 0;
+                    uint64_t count = 0;
+                    uint64_t period_sum_ns = 0;
+                    uint64_t periods = 0;
+                    uint64_t high_sum_ns = 0;
+                    uint64_t highs = 0;
+                } PULSE_TOTALS;
+
+            /**
+             * @brief last edges - event thread only.
+             */
+            typedef struct PULSE_EDGES{
+                    uint64_t last_rise_ns = 0;
+                    uint64_t last_fall_ns = 0;
+                    bool high = false;
+                } PULSE_EDGES;
+
+            /**
+             * @brief release store - a reader that sees it also sees the odd seq before it.
+             */
+            static inline void add (std::atomic<uint64_t>& counter, const uint64_t value)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_release);
+            }
+
+            static void clear (PULSE_PIN& pin, PULSE_EDGES& edges);
+            void readTotals (const uint pin_number, PULSE_TOTALS& totals) const;
+
+        private:
+
+            std::array<PULSE_PIN, GPIO_PULSE_PINS> m_pins;
+            std::array<PULSE_EDGES, GPIO_PULSE_PINS> m_edges;
+
+            // totals at previous measurement.
+            std::mutex m_mutex;
+            std::array<PULSE_TOTALS, GPIO_PULSE_PINS> m_reported;
+    };
+
+}
+}
+
+#endif
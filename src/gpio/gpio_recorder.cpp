@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_recorder.hpp"
+
+
+using namespace de::gpio;
+
+
+static inline uint64_t realtime_ns ()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+
+/**
+ * @brief map ring file, create it if missing or if it has another layout.
+ *
+ * @param path ring file.
+ * @param records records in ring - rounded up to a power of two.
+ */
+bool CGPIORecorder::open (const std::string& path, const uint64_t records)
+{
+    close();
+
+    if ((records == 0) || (records > (1ull << 32))) return false;
+
+    uint64_t capacity = 1;
+    while (capacity < records) capacity <<= 1;
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open flight recorder " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    const size_t size = sizeof(GPIO_RECORDER_HEADER) + capacity * sizeof(GPIO_RECORD);
+
+    struct stat st;
+    bool reuse = (fstat(fd, &st) == 0) && (static_cast<size_t>(st.st_size) == size);
+    if (!reuse && (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to size flight recorder " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to map flight recorder " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    GPIO_RECORDER_HEADER* header = static_cast<GPIO_RECORDER_HEADER*>(memory);
+    reuse = reuse
+            && (memcmp(header->magic, GPIO_RECORDER_MAGIC, sizeof(header->magic)) == 0)
+            && (header->version == GPIO_RECORDER_VERSION)
+            && (header->record_size == sizeof(GPIO_RECORD))
+            && (header->capacity == capacity);
+
+    if (!reuse)
+    {
+        memset(memory, 0, size);
+        memcpy(header->magic, GPIO_RECORDER_MAGIC, sizeof(header->magic));
+        header->version = GPIO_RECORDER_VERSION;
+        header->record_size = sizeof(GPIO_RECORD);
+        header->capacity = capacity;
+        header->head.store(0);
+        header->realtime_ns = realtime_ns();
+        header->monotonic_ns = now();
+    }
+
+    m_header = header;
+    m_records = reinterpret_cast<GPIO_RECORD*>(static_cast<uint8_t*>(memory) + sizeof(GPIO_RECORDER_HEADER));
+    m_capacity = capacity;
+    m_size = size;
+
+    record(GPIO_RECORD_START, GPIO_RECORD_NO_PIN, realtime_ns(), getpid());
+
+    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "Flight recorder: " << _INFO_CONSOLE_BOLD_TEXT << path
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << (reuse ? " continued at record " : " created, ") << _INFO_CONSOLE_BOLD_TEXT << (reuse ? header->head.load() : capacity)
+              << _SUCCESS_CONSOLE_BOLD_TEXT_ << (reuse ? "" : " records") << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    return true;
+}
+
+
+void CGPIORecorder::close ()
+{
+    if (m_header == nullptr) return ;
+
+    void* memory = m_header;
+    m_records = nullptr;
+    m_header = nullptr;
+
+    munmap(memory, m_size);
+}
@@ -0,0 +1,157 @@
+#ifndef GPIO_RECORDER_H_
+#define GPIO_RECORDER_H_
+
+#include <cstdint>
+#include <string>
+#include <atomic>
+#include <time.h>
+#include <sys/types.h>
+
+
+#define GPIO_RECORDER_MAGIC "DEGPIOFR"
+#define GPIO_RECORDER_VERSION 1
+#define GPIO_RECORDER_DEFAULT_RECORDS 65536 // 2 MB ring - capacity is rounded up to a power of two
+
+// record types
+#define GPIO_RECORD_START       0   // module started - value: CLOCK_REALTIME nsec at timestamp
+#define GPIO_RECORD_CONFIG      1   // pin configured - value: mode, extra: initial value
+#define GPIO_RECORD_PIN         2   // digital level changed - value: level
+#define GPIO_RECORD_PWM         3   // PWM changed - value: width, extra: frequency
+#define GPIO_RECORD_COMMAND     4   // command received - value: GPIO_LATENCY_* action
+#define GPIO_RECORD_EDGE        5   // edge of INPUT line before filtering - value: level
+
+// what caused a GPIO_RECORD_PIN / GPIO_RECORD_PWM record
+#define GPIO_RECORD_SOURCE_WRITE    0
+#define GPIO_RECORD_SOURCE_INPUT    1
+
+#define GPIO_RECORD_NO_PIN          0xFF
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief one event - fixed size so the file is a plain array.
+     * sequence is record index + 1 and is written last. A record whose sequence does not
+     * match its slot was being written when the module stopped and is skipped by readers.
+     */
+    typedef struct GPIO_RECORD{
+            std::atomic<uint64_t> sequence;
+            uint64_t timestamp_ns;      // CLOCK_MONOTONIC
+            uint64_t value;
+            uint32_t extra;
+            uint8_t type;
+            uint8_t pin;
+            uint16_t source;
+        } GPIO_RECORD;
+
+    static_assert(sizeof(GPIO_RECORD) == 32, "GPIO_RECORD must be 32 bytes");
+
+
+    /**
+     * @brief start of file. records follow the header.
+     */
+    typedef struct GPIO_RECORDER_HEADER{
+            char magic[8];
+            uint32_t version;
+            uint32_t record_size;
+            uint64_t capacity;                  // records in ring
+            std::atomic<uint64_t> head;         // records ever appended
+            uint64_t realtime_ns;               // clocks when file was created
+            uint64_t monotonic_ns;
+            uint64_t reserved[2];
+        } GPIO_RECORDER_HEADER;
+
+    static_assert(sizeof(GPIO_RECORDER_HEADER) == 64, "GPIO_RECORDER_HEADER must be 64 bytes");
+
+
+    /**
+     * @brief Flight recorder of pin activity.
+     *
+     * Records are appended to a ring in a memory mapped file. Append is a fetch_add on
+     * the head and a few stores into the mapping - no lock and no system call.
+     * Pages of a shared file mapping belong to the kernel page cache, so records written
+     * before a crash are still written to the file.
+     *
+     * An existing ring of the same size is continued. Each start appends GPIO_RECORD_START
+     * so readers can convert monotonic timestamps of each run to wall clock.
+     */
+    class CGPIORecorder
+    {
+        public:
+
+            static CGPIORecorder& getInstance()
+            {
+                static CGPIORecorder instance;
+
+                return instance;
+            }
+
+            CGPIORecorder(CGPIORecorder const&)           = delete;
+            void operator=(CGPIORecorder const&)        = delete;
+
+        private:
+
+            CGPIORecorder()
+            {
+
+            }
+
+        public:
+
+            // mapping is left to process exit - other threads may still record while statics are destroyed.
+            ~CGPIORecorder ()
+            {
+
+            }
+
+        public:
+
+            bool open (const std::string& path, const uint64_t records);
+            void close ();
+
+            inline bool isOpen () const
+            {
+                return m_records != nullptr;
+            }
+
+            inline void record (const uint8_t type, const uint pin, const uint64_t value, const uint32_t extra = 0, const uint16_t source = GPIO_RECORD_SOURCE_WRITE)
+            {
+                if (m_records == nullptr) return ;
+
+                const uint64_t index = m_header->head.fetch_add(1, std::memory_order_relaxed);
+                GPIO_RECORD& record = m_records[index & (m_capacity - 1)];
+
+                // readers open the file after the module stopped - program order is enough, no barrier.
+                record.sequence.store(0, std::memory_order_relaxed);
+                std::atomic_signal_fence(std::memory_order_release);
+                record.timestamp_ns = now();
+                record.value = value;
+                record.extra = extra;
+                record.type = type;
+                record.pin = static_cast<uint8_t>(pin);
+                record.source = source;
+                record.sequence.store(index + 1, std::memory_order_release);
+            }
+
+            static inline uint64_t now ()
+            {
+                struct timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+            }
+
+        private:
+
+            GPIO_RECORDER_HEADER* m_header = nullptr;
+            GPIO_RECORD* m_records = nullptr;
+            uint64_t m_capacity = 0;           // power of two
+            size_t m_size = 0;
+    };
+
+}
+}
+
+#endif
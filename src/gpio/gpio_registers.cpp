@@ -0,0 +1,114 @@
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_registers.hpp"
+
+
+using namespace de::gpio;
+
+
+/**
+ * @brief map GPIO register block.
+ *
+ * @param path /dev/gpiomem, or a regular file if register_file is set.
+ * @param register_file path is a register file for testing - it is created if missing.
+ *        Otherwise path must be a device, a missing device is an error.
+ * @return true if mapped.
+ */
+bool CGPIORegisters::open(const std::string& path, const bool register_file)
+{
+    close();
+
+    const int flags = register_file ? (O_RDWR | O_SYNC | O_CREAT | O_CLOEXEC) : (O_RDWR | O_SYNC | O_CLOEXEC);
+    m_fd = ::open(path.c_str(), flags, 0644);
+    if (m_fd < 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to open GPIO registers at " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to stat " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        close();
+        return false;
+    }
+
+    m_file_backed = S_ISREG(st.st_mode);
+    if (m_file_backed != register_file)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: " << path << (register_file ? " is not a register file." : " is not a GPIO device - use gpio_mem_file for a register file.") << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        close();
+        return false;
+    }
+
+    if (m_file_backed && (st.st_size < GPIO_REG_BLOCK_SIZE))
+    {
+        // a fresh register file - all pins input & low.
+        if (ftruncate(m_fd, GPIO_REG_BLOCK_SIZE) != 0)
+        {
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to size register file " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    void * map = mmap(nullptr, GPIO_REG_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to mmap GPIO registers at " << path << " : " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        close();
+        return false;
+    }
+
+    m_regs = static_cast<volatile uint32_t *>(map);
+
+    std::cout << _SUCCESS_CONSOLE_BOLD_TEXT_ << "GPIO registers mapped from: " << _INFO_CONSOLE_BOLD_TEXT << path
+              << (m_file_backed ? " (register file)" : "") << _NORMAL_CONSOLE_TEXT_ << std::endl;
+
+    return true;
+}
+
+
+void CGPIORegisters::close()
+{
+    if (m_regs != nullptr)
+    {
+        munmap(const_cast<uint32_t *>(m_regs), GPIO_REG_BLOCK_SIZE);
+        m_regs = nullptr;
+    }
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    m_file_backed = false;
+}
+
+
+void CGPIORegisters::setFunction(const uint pin_number, const uint fsel)
+{
+    if (pin_number > GPIO_REG_MAX_PIN) return ;
+
+    const uint reg = GPIO_REG_GPFSEL0 + pin_number / 10;
+    const uint shift = (pin_number % 10) * 3;
+
+    m_regs[reg] = (m_regs[reg] & ~(7u << shift)) | ((fsel & 7u) << shift);
+}
+
+
+uint CGPIORegisters::getFunction(const uint pin_number) const
+{
+    if (pin_number > GPIO_REG_MAX_PIN) return GPIO_FSEL_INPUT;
+
+    return (m_regs[GPIO_REG_GPFSEL0 + pin_number / 10] >> ((pin_number % 10) * 3)) & 7u;
+}
@@ -0,0 +1,130 @@
+#ifndef GPIO_REGISTERS_H_
+#define GPIO_REGISTERS_H_
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+
+// BCM283x/BCM2711 GPIO register block - offsets are in 32-bit words.
+#define GPIO_REG_GPFSEL0            0   // function select 0..5  (10 pins per register, 3 bits each)
+#define GPIO_REG_GPSET0             7   // output set 0..1       (write 1 to set)
+#define GPIO_REG_GPCLR0             10  // output clear 0..1     (write 1 to clear)
+#define GPIO_REG_GPLEV0             13  // pin level 0..1        (read only on real hardware)
+
+#define GPIO_REG_BLOCK_SIZE         4096
+#define GPIO_REG_BANK_PINS          32
+#define GPIO_REG_MAX_PIN            53
+
+#define GPIO_FSEL_INPUT             0
+#define GPIO_FSEL_OUTPUT            1
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief Direct access to GPIO registers through a memory mapped block.
+     *
+     * * On a Raspberry Pi the block is mapped from /dev/gpiomem.
+     * * In register file mode a regular file is mapped instead - created if missing - and
+     *   GPSET/GPCLR writes are mirrored into GPLEV so bit manipulation can be checked on any Linux box.
+     *
+     */
+    class CGPIORegisters
+    {
+        public:
+
+            CGPIORegisters()
+            {
+
+            }
+
+            CGPIORegisters(CGPIORegisters const&)         = delete;
+            void operator=(CGPIORegisters const&)        = delete;
+
+            ~CGPIORegisters ()
+            {
+                close();
+            }
+
+        public:
+
+            bool open (const std::string& path, const bool register_file);
+            void close ();
+
+            inline bool isOpen () const
+            {
+                return m_regs != nullptr;
+            }
+
+            inline bool isFileBacked () const
+            {
+                return m_file_backed;
+            }
+
+        public:
+
+            void setFunction (const uint pin_number, const uint fsel);
+            uint getFunction (const uint pin_number) const;
+
+            /**
+             * @brief set all pins in mask of a bank in one register write.
+             *
+             * @param bank 0: GPIO 0-31, 1: GPIO 32-53
+             * @param mask
+             */
+            inline void setMask (const uint bank, const uint32_t mask)
+            {
+                m_regs[GPIO_REG_GPSET0 + bank] = mask;
+                if (m_file_backed) m_regs[GPIO_REG_GPLEV0 + bank] |= mask;
+            }
+
+            /**
+             * @brief clear all pins in mask of a bank in one register write.
+             *
+             * @param bank 0: GPIO 0-31, 1: GPIO 32-53
+             * @param mask
+             */
+            inline void clearMask (const uint bank, const uint32_t mask)
+            {
+                m_regs[GPIO_REG_GPCLR0 + bank] = mask;
+                if (m_file_backed) m_regs[GPIO_REG_GPLEV0 + bank] &= ~mask;
+            }
+
+            inline uint32_t readLevels (const uint bank) const
+            {
+                return m_regs[GPIO_REG_GPLEV0 + bank];
+            }
+
+            inline void writePin (const uint pin_number, const uint pin_value)
+            {
+                const uint32_t mask = 1u << (pin_number % GPIO_REG_BANK_PINS);
+                if (pin_value)
+                {
+                    setMask (pin_number / GPIO_REG_BANK_PINS, mask);
+                }
+                else
+                {
+                    clearMask (pin_number / GPIO_REG_BANK_PINS, mask);
+                }
+            }
+
+            inline int readPin (const uint pin_number) const
+            {
+                return (readLevels(pin_number / GPIO_REG_BANK_PINS) >> (pin_number % GPIO_REG_BANK_PINS)) & 1u;
+            }
+
+        private:
+
+            volatile uint32_t * m_regs = nullptr;
+            int m_fd = -1;
+            bool m_file_backed = false;
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <time.h>
+#include <pthread.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_sampler.hpp"
+
+
+using namespace de::gpio;
+
+
+static inline uint64_t monotonic_ns ()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
+
+
+void CGPIOSampler::setReadHandler (READ_HANDLER read_handler)
+{
+    stop();
+
+    m_read_handler = read_handler;
+}
+
+
+/**
+ * @brief sampling rate and ring size. takes effect at next start.
+ *
+ * @param rate_hz samples per second - 0 disables sampling.
+ * @param buffer_samples samples kept in ring - rounded up to a power of two.
+ */
+bool CGPIOSampler::configure (const double rate_hz, const size_t buffer_samples)
+{
+    if ((rate_hz < 0.0) || (rate_hz > GPIO_SAMPLER_MAX_HZ) || (buffer_samples == 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: input sampling rate must be 0.." << GPIO_SAMPLER_MAX_HZ << " Hz with a non empty buffer." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    stop();
+
+    size_t capacity = 1;
+    while (capacity < buffer_samples) capacity <<= 1;
+
+    m_rate_hz = rate_hz;
+    m_ring.reset(new std::atomic<uint64_t>[capacity]());
+    m_ring_size = capacity;
+    m_head = 0;
+
+    return true;
+}
+
+
+/**
+ * @brief sample pins in pin_mask - restarts thread if already running.
+ */
+bool CGPIOSampler::start (const uint64_t pin_mask)
+{
+    stop();
+
+    {
+        // summary reads mask & counters under m_mutex - they change together.
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_pin_mask.store(pin_mask, std::memory_order_relaxed);
+        if (!isEnabled() || (pin_mask == 0) || !m_read_handler) return false;
+
+        m_counters = SAMPLER_COUNTERS();
+        m_summary_ns = monotonic_ns();
+        m_stats = SAMPLER_STATS();
+    }
+
+    m_exit_thread = false;
+    m_thread = std::thread{[&](){ loopSampler(); }};
+
+    return true;
+}
+
+
+void CGPIOSampler::stop ()
+{
+    if (!m_thread.joinable()) return ;
+
+    m_exit_thread = true;
+    m_thread.join();
+}
+
+
+/**
+ * @brief copy of latest samples, oldest first.
+ *
+ * @param last_sample_ns CLOCK_MONOTONIC time of last copied sample.
+ * @return samples copied - samples overwritten while copying are dropped from the front.
+ */
+size_t CGPIOSampler::getSamples (uint64_t* samples, const size_t count, uint64_t& last_sample_ns) const
+{
+    const uint64_t capacity = m_ring_size;
+    if (capacity == 0) return 0;
+
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    last_sample_ns = m_last_sample_ns.load(std::memory_order_relaxed);
+
+    const uint64_t available = std::min<uint64_t>(std::min<uint64_t>(head, capacity), count);
+    const uint64_t first = head - available;
+    for (uint64_t i = 0; i < available; ++i)
+    {
+        samples[i] = m_ring[(first + i) & (capacity - 1)].load(std::memory_order_acquire);
+    }
+
+    // writer may have overwritten the oldest copied samples - including the one it is writing now.
+    // A sample seen by an acquire load above implies the head stored before it.
+    const uint64_t written = m_head.load(std::memory_order_acquire) + 1;
+    const uint64_t lapped = (written > first + capacity) ? (written - first - capacity) : 0;
+    if (lapped == 0) return available;
+    if (lapped >= available) return 0;
+
+    std::memmove(samples, samples + lapped, (available - lapped) * sizeof(uint64_t));
+    return available - lapped;
+}
+
+
+/**
+ * @brief duty, toggle rate & last change of each sampled pin since previous call.
+ * @return number of samples summarized.
+ */
+size_t CGPIOSampler::takeSummary (std::vector<SAMPLER_PIN_SUMMARY>& summary)
+{
+    summary.clear();
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    const uint64_t now_ns = monotonic_ns();
+    const double elapsed_sec = (now_ns - m_summary_ns) / 1e9;
+    const uint64_t samples = m_counters.samples;
+
+    for (uint64_t pins = m_pin_mask.load(std::memory_order_relaxed); pins; pins &= pins - 1)
+    {
+        const uint pin = __builtin_ctzll(pins);
+        SAMPLER_PIN_COUNTERS& counters = m_counters.pins[pin];
+
+        SAMPLER_PIN_SUMMARY pin_summary;
+        pin_summary.pin_number = pin;
+        pin_summary.level = (m_counters.levels >> pin) & 1;
+        pin_summary.duty = (samples == 0) ? 0.0 : static_cast<double>(counters.high_samples) / samples;
+        pin_summary.toggle_rate = (elapsed_sec <= 0.0) ? 0.0 : counters.toggles / elapsed_sec;
+        pin_summary.toggles = counters.toggles;
+        pin_summary.since_change_ns = (counters.last_change_ns == 0) ? -1 : static_cast<int64_t>(now_ns - counters.last_change_ns);
+        summary.push_back(pin_summary);
+
+        counters.high_samples = 0;
+        counters.toggles = 0;
+    }
+
+    m_counters.samples = 0;
+    m_summary_ns = now_ns;
+
+    return samples;
+}
+
+
+SAMPLER_STATS CGPIOSampler::getStats () const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_stats;
+}
+
+
+void CGPIOSampler::loopSampler ()
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = GPIO_SAMPLER_PRIORITY;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+    {
+        std::cout << _LOG_CONSOLE_BOLD_TEXT << "WARNING: input sampler runs without real-time priority." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+
+    const uint64_t pin_mask = m_pin_mask.load(std::memory_order_relaxed);
+    const uint64_t ring_mask = m_ring_size - 1;
+    const uint64_t period_ns = static_cast<uint64_t>(1e9 / m_rate_hz);
+
+    SAMPLER_COUNTERS counters;
+    SAMPLER_STATS stats;
+    bool first = true;
+    uint64_t previous = 0;
+    uint64_t head = m_head.load();
+
+    uint64_t deadline_ns = monotonic_ns();
+    uint64_t publish_ns = deadline_ns + GPIO_SAMPLER_PUBLISH_NS;
+
+    while (!m_exit_thread)
+    {
+        waitUntil(deadline_ns);
+
+        uint64_t levels;
+        const bool valid = m_read_handler(levels);
+        const uint64_t now_ns = monotonic_ns();
+
+        stats.lateness_max_ns = std::max(stats.lateness_max_ns, now_ns - deadline_ns);
+
+        if (valid)
+        {
+            levels &= pin_mask;
+
+            m_ring[head & ring_mask].store(levels, std::memory_order_release);
+            m_last_sample_ns.store(now_ns, std::memory_order_relaxed);
+            m_head.store(++head, std::memory_order_release);
+
+            const uint64_t changed = first ? 0 : (levels ^ previous);
+            for (uint64_t bits = changed; bits; bits &= bits - 1)
+            {
+                SAMPLER_PIN_COUNTERS& pin = counters.pins[__builtin_ctzll(bits)];
+                pin.toggles++;
+                pin.last_change_ns = now_ns;
+            }
+            for (uint64_t bits = levels; bits; bits &= bits - 1)
+            {
+                counters.pins[__builtin_ctzll(bits)].high_samples++;
+            }
+
+            counters.samples++;
+            counters.levels = levels;
+            previous = levels;
+            first = false;
+            stats.samples++;
+        }
+        else
+        {
+            stats.read_errors++;
+        }
+
+        deadline_ns += period_ns;
+        if (now_ns > deadline_ns)
+        {   // thread was delayed by more than a period - skip to current one.
+            const uint64_t missed = (now_ns - deadline_ns) / period_ns + 1;
+            stats.missed_samples += missed;
+            deadline_ns += missed * period_ns;
+        }
+
+        if (now_ns >= publish_ns)
+        {
+            publishCounters(counters, stats);
+            publish_ns = now_ns + GPIO_SAMPLER_PUBLISH_NS;
+        }
+    }
+
+    publishCounters(counters, stats);
+}
+
+
+/**
+ * @brief add counters of sampler thread to those read by summary.
+ */
+void CGPIOSampler::publishCounters (SAMPLER_COUNTERS& counters, const SAMPLER_STATS& stats)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_counters.samples += counters.samples;
+    m_counters.levels = counters.levels;
+    for (uint64_t pins = m_pin_mask.load(std::memory_order_relaxed); pins; pins &= pins - 1)
+    {
+        const uint pin = __builtin_ctzll(pins);
+        SAMPLER_PIN_COUNTERS& published = m_counters.pins[pin];
+        const SAMPLER_PIN_COUNTERS& local = counters.pins[pin];
+
+        published.high_samples += local.high_samples;
+        published.toggles += local.toggles;
+        if (local.toggles != 0) published.last_change_ns = local.last_change_ns;
+    }
+    m_stats = stats;
+
+    const uint64_t levels = counters.levels;
+    counters = SAMPLER_COUNTERS();
+    counters.levels = levels;
+}
+
+
+/**
+ * @brief sleep until GPIO_SAMPLER_SPIN_US before deadline then busy wait.
+ */
+void CGPIOSampler::waitUntil (const uint64_t deadline_ns) const
+{
+    const uint64_t spin_ns = GPIO_SAMPLER_SPIN_US * 1000ull;
+
+    if (monotonic_ns() + spin_ns < deadline_ns)
+    {
+        const uint64_t sleep_ns = deadline_ns - spin_ns;
+        struct timespec wake;
+        wake.tv_sec = sleep_ns / 1000000000ull;
+        wake.tv_nsec = sleep_ns % 1000000000ull;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR)
+        {
+        }
+    }
+
+    while (monotonic_ns() < deadline_ns)
+    {
+    }
+}
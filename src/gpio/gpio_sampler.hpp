@@ -0,0 +1,161 @@
+#ifndef GPIO_SAMPLER_H_
+#define GPIO_SAMPLER_H_
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <sys/types.h>
+
+
+#define GPIO_SAMPLER_PINS 54
+#define GPIO_SAMPLER_MAX_HZ 50000
+#define GPIO_SAMPLER_DEFAULT_BUFFER 16384 // samples kept - rounded up to a power of two
+#define GPIO_SAMPLER_PUBLISH_NS 10000000ull // sampler thread publishes statistics every 10 ms
+#define GPIO_SAMPLER_SPIN_US 10 // last part of each wait is a busy wait
+#define GPIO_SAMPLER_PRIORITY 80 // SCHED_FIFO priority - below soft PWM
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief what an INPUT pin did since the previous summary.
+     */
+    typedef struct SAMPLER_PIN_SUMMARY{
+            uint pin_number;
+            uint level;                     // level at last sample
+            double duty;                    // part of samples that were high: 0..1
+            double toggle_rate;             // level changes per second
+            uint64_t toggles;
+            int64_t since_change_ns;        // time since last change, -1 if level never changed
+        } SAMPLER_PIN_SUMMARY;
+
+
+    typedef struct SAMPLER_STATS{
+            uint64_t samples = 0;
+            uint64_t missed_samples = 0;    // sample times skipped as thread was late
+            uint64_t read_errors = 0;
+            uint64_t lateness_max_ns = 0;
+        } SAMPLER_STATS;
+
+
+    /**
+     * @brief Periodic sampling of INPUT pins.
+     *
+     * One SCHED_FIFO thread reads the levels of all sampled pins with one read per sample.
+     * Each sample is kept bit-packed as a 64-bit word - bit n is GPIO n - in a ring buffer
+     * that readers copy without a lock.
+     *
+     * Duty, toggle count and last change time of each pin are accumulated on the sampler thread
+     * and handed to the summary every GPIO_SAMPLER_PUBLISH_NS, so only summaries leave the device.
+     */
+    class CGPIOSampler
+    {
+        public:
+
+            typedef std::function<bool(uint64_t& levels)> READ_HANDLER;
+
+        public:
+
+            CGPIOSampler()
+            {
+
+            }
+
+            CGPIOSampler(CGPIOSampler const&)          = delete;
+            void operator=(CGPIOSampler const&)       = delete;
+
+            ~CGPIOSampler ()
+            {
+                stop();
+            }
+
+        public:
+
+            void setReadHandler (READ_HANDLER read_handler);
+            bool configure (const double rate_hz, const size_t buffer_samples);
+
+            bool start (const uint64_t pin_mask);
+            void stop ();
+
+            inline bool isEnabled () const
+            {
+                return m_rate_hz > 0.0;
+            }
+
+            inline bool isRunning () const
+            {
+                return m_thread.joinable();
+            }
+
+            inline double getRate () const
+            {
+                return m_rate_hz;
+            }
+
+            /**
+             * @brief read by the sampler thread through its read handler - set by start under m_mutex.
+             */
+            inline uint64_t getPinMask () const
+            {
+                return m_pin_mask.load(std::memory_order_relaxed);
+            }
+
+            size_t getSamples (uint64_t* samples, const size_t count, uint64_t& last_sample_ns) const;
+            size_t takeSummary (std::vector<SAMPLER_PIN_SUMMARY>& summary);
+            SAMPLER_STATS getStats () const;
+
+        private:
+
+            /**
+             * @brief counters of one pin. level changes are rare so last_change_ns is written per change only.
+             */
+            typedef struct SAMPLER_PIN_COUNTERS{
+                    uint64_t high_samples = 0;
+                    uint64_t toggles = 0;
+                    uint64_t last_change_ns = 0;
+                } SAMPLER_PIN_COUNTERS;
+
+            typedef struct SAMPLER_COUNTERS{
+                    uint64_t samples = 0;
+                    uint64_t levels = 0;
+                    std::array<SAMPLER_PIN_COUNTERS, GPIO_SAMPLER_PINS> pins;
+                } SAMPLER_COUNTERS;
+
+            void loopSampler ();
+            void publishCounters (SAMPLER_COUNTERS& counters, const SAMPLER_STATS& stats);
+            void waitUntil (const uint64_t deadline_ns) const;
+
+        private:
+
+            READ_HANDLER m_read_handler;
+            double m_rate_hz = 0.0;
+            std::atomic<uint64_t> m_pin_mask {0};
+
+            // single writer ring - m_head is the number of samples ever written.
+            std::unique_ptr<std::atomic<uint64_t>[]> m_ring;
+            uint64_t m_ring_size = 0;
+            std::atomic<uint64_t> m_head {0};
+            std::atomic<uint64_t> m_last_sample_ns {0};
+
+            // counters published by sampler thread and taken by summary.
+            mutable std::mutex m_mutex;
+            SAMPLER_COUNTERS m_counters;
+            uint64_t m_summary_ns = 0;
+            SAMPLER_STATS m_stats;
+
+            std::thread m_thread;
+            std::atomic<bool> m_exit_thread {true};
+    };
+
+}
+}
+
+#endif
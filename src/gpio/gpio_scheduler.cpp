@@ -0,0 +1,183 @@
+#include <iostream>
+#include <cstring>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_scheduler.hpp"
+
+
+using namespace de::gpio;
+
+
+static inline uint64_t monotonic_ns ()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
+
+
+/**
+ * @brief register a periodic task. must be called before start().
+ *
+ * @param name used in stats output.
+ * @param interval_usec
+ * @param task runs on scheduler thread.
+ */
+void CGPIOScheduler::addTask (const std::string& name, const uint64_t interval_usec, TASK task)
+{
+    if (interval_usec == 0) return ;
+
+    SCHEDULER_TASK scheduler_task;
+    scheduler_task.name = name;
+    scheduler_task.interval_ns = interval_usec * 1000;
+    scheduler_task.next_deadline_ns = 0;
+    scheduler_task.task = task;
+
+    m_tasks.push_back(scheduler_task);
+}
+
+
+void CGPIOScheduler::enableStats (const uint64_t interval_usec)
+{
+    addTask("stats", interval_usec, [this](){ printStats(); });
+}
+
+
+bool CGPIOScheduler::start ()
+{
+    stop();
+
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    m_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((m_timer_fd < 0) || (m_event_fd < 0))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: Unable to create scheduler timer: " << strerror(errno) << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        stop();
+        return false;
+    }
+
+    const uint64_t now = monotonic_ns();
+    for (SCHEDULER_TASK& task : m_tasks)
+    {
+        task.next_deadline_ns = now + task.interval_ns;
+        task.stats = SCHEDULER_TASK_STATS();
+    }
+
+    m_exit_thread = false;
+    m_thread = std::thread{[&](){ loopScheduler(); }};
+
+    return true;
+}
+
+
+void CGPIOScheduler::stop ()
+{
+    if (m_thread.joinable())
+    {
+        m_exit_thread = true;
+        const uint64_t one = 1;
+        if (write(m_event_fd, &one, sizeof(one)) < 0) { /* thread exits on next deadline anyway */ }
+        m_thread.join();
+    }
+
+    if (m_timer_fd >= 0) { close(m_timer_fd); m_timer_fd = -1; }
+    if (m_event_fd >= 0) { close(m_event_fd); m_event_fd = -1; }
+}
+
+
+void CGPIOScheduler::loopScheduler ()
+{
+    struct pollfd fds[2];
+    fds[0].fd = m_timer_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_event_fd;
+    fds[1].events = POLLIN;
+
+    while (!m_exit_thread)
+    {
+        if (m_tasks.empty())
+        {
+            poll(&fds[1], 1, -1);
+            continue;
+        }
+
+        uint64_t next_deadline_ns = m_tasks[0].next_deadline_ns;
+        for (const SCHEDULER_TASK& task : m_tasks)
+        {
+            if (task.next_deadline_ns < next_deadline_ns) next_deadline_ns = task.next_deadline_ns;
+        }
+
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = next_deadline_ns / 1000000000ull;
+        spec.it_value.tv_nsec = next_deadline_ns % 1000000000ull;
+        timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+        if (poll(fds, 2, -1) < 0) continue;
+
+        if (fds[0].revents & POLLIN)
+        {
+            uint64_t expirations;
+            if (read(m_timer_fd, &expirations, sizeof(expirations)) < 0) { /* re-armed below */ }
+        }
+
+        if (m_exit_thread) break;
+
+        runDueTasks(monotonic_ns());
+    }
+}
+
+
+void CGPIOScheduler::runDueTasks (const uint64_t now_ns)
+{
+    for (SCHEDULER_TASK& task : m_tasks)
+    {
+        if (task.next_deadline_ns > now_ns) continue;
+
+        const uint64_t lateness_ns = now_ns - task.next_deadline_ns;
+        const uint64_t missed = lateness_ns / task.interval_ns;
+
+        task.stats.runs++;
+        task.stats.missed += missed;
+        task.stats.lateness_sum_ns += lateness_ns;
+        if (lateness_ns > task.stats.lateness_max_ns) task.stats.lateness_max_ns = lateness_ns;
+
+        if (missed != 0)
+        {
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Scheduler: task " << task.name << " missed " << missed << " deadline(s)" << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        }
+
+        // next deadline stays on the start + n * interval grid.
+        task.next_deadline_ns += (missed + 1) * task.interval_ns;
+
+        try
+        {
+            task.task();
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Exception in scheduler task " << task.name << ": " << e.what() << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        }
+    }
+}
+
+
+void CGPIOScheduler::printStats () const
+{
+    for (const SCHEDULER_TASK& task : m_tasks)
+    {
+        const uint64_t mean_ns = (task.stats.runs == 0) ? 0 : task.stats.lateness_sum_ns / task.stats.runs;
+
+        std::cout << _INFO_CONSOLE_TEXT << "Scheduler: " << _LOG_CONSOLE_BOLD_TEXT << task.name
+                  << _INFO_CONSOLE_TEXT << " runs:" << _LOG_CONSOLE_BOLD_TEXT << task.stats.runs
+                  << _INFO_CONSOLE_TEXT << " missed:" << _LOG_CONSOLE_BOLD_TEXT << task.stats.missed
+                  << _INFO_CONSOLE_TEXT << " lateness mean(us):" << _LOG_CONSOLE_BOLD_TEXT << mean_ns / 1000
+                  << _INFO_CONSOLE_TEXT << " max(us):" << _LOG_CONSOLE_BOLD_TEXT << task.stats.lateness_max_ns / 1000
+                  << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef GPIO_SCHEDULER_H_
+#define GPIO_SCHEDULER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief timing of a periodic task.
+     * lateness is time between planned deadline and actual start of task.
+     */
+    typedef struct SCHEDULER_TASK_STATS{
+            uint64_t runs = 0;
+            uint64_t missed = 0;                // periods skipped because task ran too late
+            uint64_t lateness_sum_ns = 0;
+            uint64_t lateness_max_ns = 0;
+        } SCHEDULER_TASK_STATS;
+
+
+    /**
+     * @brief Drift free periodic scheduler.
+     *
+     * * Each task has its own interval and deadlines are absolute: start + n * interval,
+     *   so run time of a task never shifts later deadlines.
+     * * The thread sleeps on a timerfd armed at the nearest deadline - no fixed tick.
+     * * Deadlines that passed while a task was late are skipped and counted as missed.
+     *
+     */
+    class CGPIOScheduler
+    {
+        public:
+
+            typedef std::function<void()> TASK;
+
+        public:
+
+            CGPIOScheduler()
+            {
+
+            }
+
+            CGPIOScheduler(CGPIOScheduler const&)        = delete;
+            void operator=(CGPIOScheduler const&)       = delete;
+
+            ~CGPIOScheduler ()
+            {
+                stop();
+            }
+
+        public:
+
+            void addTask (const std::string& name, const uint64_t interval_usec, TASK task);
+            bool start ();
+            void stop ();
+
+            /**
+             * @brief print timing of each task every interval_usec.
+             * used to measure jitter & drift.
+             */
+            void enableStats (const uint64_t interval_usec);
+
+            inline size_t getTaskCount () const
+            {
+                return m_tasks.size();
+            }
+
+            inline const SCHEDULER_TASK_STATS& getTaskStats (const size_t index) const
+            {
+                return m_tasks[index].stats;
+            }
+
+        private:
+
+            typedef struct SCHEDULER_TASK{
+                    std::string name;
+                    uint64_t interval_ns;
+                    uint64_t next_deadline_ns;
+                    TASK task;
+                    SCHEDULER_TASK_STATS stats;
+                } SCHEDULER_TASK;
+
+            void loopScheduler ();
+            void runDueTasks (const uint64_t now_ns);
+            void printStats () const;
+
+        private:
+
+            std::vector<SCHEDULER_TASK> m_tasks;
+
+            int m_timer_fd = -1;
+            int m_event_fd = -1;
+
+            std::thread m_thread;
+            std::atomic<bool> m_exit_thread {true};
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <pthread.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_driver.hpp"
+#include "gpio_sequencer.hpp"
+
+
+using namespace de::gpio;
+
+
+/**
+ * @brief run sequence - replaces any running pattern.
+ * sequencer runs at SCHED_FIFO, so steps shorter than GPIO_SEQUENCER_MIN_STEP_US and
+ * looped cycles shorter than GPIO_SEQUENCER_MIN_CYCLE_US are rejected. Each step ends with up to
+ * GPIO_SEQUENCER_SPIN_US of busy wait, so a looped pattern that would spin more than
+ * GPIO_SEQUENCER_MAX_SPIN_PERCENT of its cycle is rejected too - it would hold a core.
+ *
+ * @return false if sequence is empty, too long or too fast.
+ */
+bool CGPIOSequencer::start (const GPIO_SEQUENCE& sequence)
+{
+    if (sequence.steps.empty() || (sequence.steps.size() > GPIO_SEQUENCER_MAX_STEPS)) return false;
+
+    uint64_t cycle_us = 0;
+    uint64_t spin_us = 0;
+    for (const GPIO_SEQUENCE_STEP& step : sequence.steps)
+    {
+        if (step.duration_us < GPIO_SEQUENCER_MIN_STEP_US)
+        {
+            std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: GPIO pattern step of " << step.duration_us << " us is shorter than " << GPIO_SEQUENCER_MIN_STEP_US << " us." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+            return false;
+        }
+
+        cycle_us += step.duration_us;
+        spin_us += std::min<uint32_t>(step.duration_us, GPIO_SEQUENCER_SPIN_US);
+    }
+
+    if (sequence.loop && (cycle_us < GPIO_SEQUENCER_MIN_CYCLE_US))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: GPIO pattern cycle of " << cycle_us << " us is shorter than " << GPIO_SEQUENCER_MIN_CYCLE_US << " us." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    if (sequence.loop && (spin_us * 100 > cycle_us * GPIO_SEQUENCER_MAX_SPIN_PERCENT))
+    {
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: GPIO pattern would busy wait " << spin_us << " us of its " << cycle_us << " us cycle - use fewer or longer steps." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<const GPIO_SEQUENCE> new_sequence = std::make_shared<const GPIO_SEQUENCE>(sequence);
+
+    // timing of replaced pattern.
+    if (isRunning()) printStats();
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_sequence = new_sequence;
+        m_generation++;
+        m_running = true;
+        m_stats = GPIO_SEQUENCER_STATS();
+
+        if (!m_thread.joinable())
+        {
+            m_exit_thread = false;
+            m_thread = std::thread{[&](){ loopSequencer(); }};
+        }
+    }
+
+    m_condition.notify_all();
+
+    return true;
+}
+
+
+void CGPIOSequencer::stop ()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_sequence == nullptr) return ;
+
+        m_sequence = nullptr;
+        m_generation++;
+        m_running = false;
+    }
+
+    m_condition.notify_all();
+
+    printStats();
+}
+
+
+void CGPIOSequencer::uninit ()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_sequence = nullptr;
+        m_generation++;
+        m_running = false;
+        m_exit_thread = true;
+    }
+
+    m_condition.notify_all();
+
+    if (m_thread.joinable()) m_thread.join();
+}
+
+
+bool CGPIOSequencer::isRunning () const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_running;
+}
+
+
+GPIO_SEQUENCER_STATS CGPIOSequencer::getStats () const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_stats;
+}
+
+
+void CGPIOSequencer::loopSequencer ()
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = GPIO_SEQUENCER_PRIORITY;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+    {
+        std::cout << _LOG_CONSOLE_BOLD_TEXT << "WARNING: sequencer runs without real-time priority." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_exit_thread)
+    {
+        m_condition.wait(lock, [&](){ return m_exit_thread || (m_sequence != nullptr); });
+        if (m_exit_thread) break;
+
+        std::shared_ptr<const GPIO_SEQUENCE> sequence = m_sequence;
+        const uint64_t generation = m_generation;
+
+        lock.unlock();
+        runSequence(sequence, generation);
+        lock.lock();
+
+        if ((m_generation == generation) && (m_sequence != nullptr))
+        {   // one-shot pattern completed.
+            m_sequence = nullptr;
+            m_running = false;
+
+            lock.unlock();
+            printStats();
+            lock.lock();
+        }
+    }
+}
+
+
+/**
+ * @brief execute sequence until it ends or generation changes.
+ * deadlines are absolute from pattern start, so a late step does not delay the next ones.
+ */
+void CGPIOSequencer::runSequence (std::shared_ptr<const GPIO_SEQUENCE> sequence, const uint64_t generation)
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        for (const GPIO_SEQUENCE_STEP& step : sequence->steps)
+        {
+            if (!waitUntil(deadline, generation)) return ;
+
+            if (step.level)
+            {
+                driver.writePinMasks(step.pin_mask, 0);
+            }
+            else
+            {
+                driver.writePinMasks(0, step.pin_mask);
+            }
+
+            const uint64_t lateness_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - deadline).count();
+
+            {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_stats.steps++;
+                m_stats.lateness_sum_ns += lateness_ns;
+                if (lateness_ns > m_stats.lateness_max_ns) m_stats.lateness_max_ns = lateness_ns;
+                if (lateness_ns >= static_cast<uint64_t>(step.duration_us) * 1000) m_stats.overruns++;
+            }
+
+            deadline += std::chrono::microseconds(step.duration_us);
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.cycles++;
+        }
+
+        if (!sequence->loop)
+        {   // hold last step for its duration before reporting completion.
+            waitUntil(deadline, generation);
+            return ;
+        }
+    }
+}
+
+
+/**
+ * @brief sleep until deadline - GPIO_SEQUENCER_SPIN_US before it, then busy wait.
+ *
+ * @return false if pattern was stopped or replaced meanwhile.
+ */
+bool CGPIOSequencer::waitUntil (const std::chrono::steady_clock::time_point deadline, const uint64_t generation)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_condition.wait_until(lock, deadline - std::chrono::microseconds(GPIO_SEQUENCER_SPIN_US),
+            [&](){ return m_generation != generation; });
+
+        if (m_generation != generation) return false;
+    }
+
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+    }
+
+    return true;
+}
+
+
+void CGPIOSequencer::printStats () const
+{
+    const GPIO_SEQUENCER_STATS stats = getStats();
+    const uint64_t mean_ns = (stats.steps == 0) ? 0 : stats.lateness_sum_ns / stats.steps;
+
+    std::cout << _INFO_CONSOLE_TEXT << "Sequencer: steps:" << _LOG_CONSOLE_BOLD_TEXT << stats.steps
+              << _INFO_CONSOLE_TEXT << " cycles:" << _LOG_CONSOLE_BOLD_TEXT << stats.cycles
+              << _INFO_CONSOLE_TEXT << " lateness mean(us):" << _LOG_CONSOLE_BOLD_TEXT << mean_ns / 1000
+              << _INFO_CONSOLE_TEXT << " max(us):" << _LOG_CONSOLE_BOLD_TEXT << stats.lateness_max_ns / 1000
+              << _INFO_CONSOLE_TEXT << " overruns:" << _LOG_CONSOLE_BOLD_TEXT << stats.overruns
+              << _NORMAL_CONSOLE_TEXT_ << std::endl;
+}
@@ -0,0 +1,130 @@
+#ifndef GPIO_SEQUENCER_H_
+#define GPIO_SEQUENCER_H_
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+#define GPIO_SEQUENCER_MAX_STEPS 256
+#define GPIO_SEQUENCER_SPIN_US 50 // last part of each wait is a busy wait for sub-scheduler-tick accuracy
+#define GPIO_SEQUENCER_MIN_STEP_US GPIO_SEQUENCER_SPIN_US // shorter steps cannot be timed - a step of this length is all busy wait
+#define GPIO_SEQUENCER_MIN_CYCLE_US 1000 // shortest cycle of a looped pattern
+#define GPIO_SEQUENCER_MAX_SPIN_PERCENT 25 // share of a looped cycle that may be busy wait
+#define GPIO_SEQUENCER_PRIORITY 80 // SCHED_FIFO priority of sequencer thread
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief one step of a pattern: pins in pin_mask are set to level
+     * then held for duration_us.
+     */
+    typedef struct GPIO_SEQUENCE_STEP{
+            uint64_t pin_mask;
+            uint level;
+            uint32_t duration_us;
+        } GPIO_SEQUENCE_STEP;
+
+
+    typedef struct GPIO_SEQUENCE{
+            std::vector<GPIO_SEQUENCE_STEP> steps;
+            bool loop = false;
+        } GPIO_SEQUENCE;
+
+
+    /**
+     * @brief actual vs planned timing of executed steps.
+     * lateness is time between planned and actual write of a step.
+     */
+    typedef struct GPIO_SEQUENCER_STATS{
+            uint64_t steps = 0;
+            uint64_t cycles = 0;
+            uint64_t lateness_sum_ns = 0;
+            uint64_t lateness_max_ns = 0;
+            uint64_t overruns = 0;              // steps written after their own duration had already elapsed
+        } GPIO_SEQUENCER_STATS;
+
+
+    /**
+     * @brief Runs output patterns locally so step timing does not depend on network jitter.
+     *
+     * Steps are written through CGPIODriver::writePinMasks at absolute deadlines
+     * from a SCHED_FIFO thread.
+     * start() replaces the running pattern as a whole - new pattern begins at its first step -
+     * and stop() ends it between steps. Pins keep the level of the last executed step.
+     */
+    class CGPIOSequencer
+    {
+        public:
+
+            static CGPIOSequencer& getInstance()
+            {
+                static CGPIOSequencer instance;
+
+                return instance;
+            }
+
+            CGPIOSequencer(CGPIOSequencer const&)          = delete;
+            void operator=(CGPIOSequencer const&)         = delete;
+
+
+        private:
+
+            CGPIOSequencer()
+            {
+
+            }
+
+
+        public:
+
+            ~CGPIOSequencer ()
+            {
+                uninit();
+            }
+
+        public:
+
+            bool start (const GPIO_SEQUENCE& sequence);
+            void stop ();
+            void uninit ();
+
+            bool isRunning () const;
+            GPIO_SEQUENCER_STATS getStats () const;
+
+        private:
+
+            void loopSequencer ();
+            void runSequence (std::shared_ptr<const GPIO_SEQUENCE> sequence, const uint64_t generation);
+            bool waitUntil (const std::chrono::steady_clock::time_point deadline, const uint64_t generation);
+            void printStats () const;
+
+        private:
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            // pattern to run - replaced as a whole. nullptr when stopped.
+            std::shared_ptr<const GPIO_SEQUENCE> m_sequence;
+            // changed on every start/stop so the thread drops what it is running.
+            uint64_t m_generation = 0;
+            bool m_running = false;
+
+            GPIO_SEQUENCER_STATS m_stats;
+
+            std::thread m_thread;
+            bool m_exit_thread = false;
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,384 @@
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <time.h>
+#include <pthread.h>
+
+#include "../de_common/helpers/colors.hpp"
+
+#include "gpio_soft_pwm.hpp"
+
+
+using namespace de::gpio;
+
+
+static inline uint64_t monotonic_ns (const clockid_t clock = CLOCK_MONOTONIC)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
+
+
+void CGPIOSoftPWM::setWriteHandler (WRITE_HANDLER write_handler)
+{
+    stop();
+
+    m_write_handler = write_handler;
+}
+
+
+/**
+ * @brief generate PWM by DMA instead of PWM thread.
+ * @return false if DMA hardware is not available - thread is used then.
+ */
+bool CGPIOSoftPWM::useDMA (const uint dma_channel, const uint sample_us)
+{
+    stop();
+
+    return m_dma.open(dma_channel, sample_us);
+}
+
+
+/**
+ * @brief frequency shared by all channels.
+ */
+void CGPIOSoftPWM::setFrequency (const double freq)
+{
+    if (freq <= 0.0) return ;
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_freq = freq;
+        rebuildSchedule();
+    }
+
+    playDMA();
+}
+
+
+/**
+ * @brief set duty of a pin as width/range - adds channel if needed.
+ * thread is started with first channel.
+ */
+void CGPIOSoftPWM::setWidth (const uint pin_number, const uint32_t width, const uint32_t range)
+{
+    if ((pin_number >= GPIO_SOFT_PWM_PINS) || (range == 0)) return ;
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        SOFT_PWM_CHANNEL& channel = m_channels[pin_number];
+        const uint32_t clamped_width = std::min(width, range);
+        if (channel.active && (channel.width == clamped_width) && (channel.range == range)) return ;
+
+        channel.active = true;
+        channel.width = clamped_width;
+        channel.range = range;
+        rebuildSchedule();
+    }
+
+    playDMA();
+
+    if (!m_thread.joinable() && m_write_handler && !m_dma.isOpen())
+    {
+        m_exit_thread = false;
+        m_schedule_changed = true;
+        m_thread = std::thread{[&](){ loopPWM(); }};
+    }
+}
+
+
+/**
+ * @brief pin is no longer driven by PWM. It is left low.
+ * PWM thread or DMA waveform clears it at the end of the current period - the caller does not wait.
+ */
+void CGPIOSoftPWM::removeChannel (const uint pin_number)
+{
+    if (pin_number >= GPIO_SOFT_PWM_PINS) return ;
+
+    bool empty = true;
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_channels[pin_number].active) return ;
+
+        m_channels[pin_number].active = false;
+        m_release_mask |= 1ull << pin_number;
+        rebuildSchedule();
+
+        for (const SOFT_PWM_CHANNEL& channel : m_channels)
+        {
+            if (channel.active) empty = false;
+        }
+    }
+
+    if (!empty)
+    {   // next schedule releases it.
+        playDMA();
+        return ;
+    }
+
+    stop();
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_release_mask = 0;
+    }
+
+    if (m_write_handler) m_write_handler(0, 1ull << pin_number);
+}
+
+
+void CGPIOSoftPWM::stop ()
+{
+    if (m_dma.isOpen())
+    {
+        const std::lock_guard<std::mutex> lock(m_dma_mutex);
+        m_dma.stop();
+    }
+
+    if (!m_thread.joinable()) return ;
+
+    m_exit_thread = true;
+    m_thread.join();
+}
+
+
+SOFT_PWM_STATS CGPIOSoftPWM::getStats () const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_stats;
+}
+
+
+/**
+ * @brief sort channels into edges. requires m_mutex.
+ */
+void CGPIOSoftPWM::rebuildSchedule ()
+{
+    std::shared_ptr<SOFT_PWM_SCHEDULE> schedule = std::make_shared<SOFT_PWM_SCHEDULE>();
+    schedule->period_ns = static_cast<uint64_t>(1000000000.0 / m_freq);
+    schedule->set_mask = 0;
+    schedule->off_mask = 0;
+    schedule->channels = 0;
+
+    for (uint pin = 0; pin < GPIO_SOFT_PWM_PINS; ++pin)
+    {
+        const SOFT_PWM_CHANNEL& channel = m_channels[pin];
+        if (!channel.active) continue;
+
+        const uint64_t bit = 1ull << pin;
+        schedule->channels++;
+
+        if (channel.width == 0)
+        {
+            schedule->off_mask |= bit;
+            continue;
+        }
+
+        schedule->set_mask |= bit;
+        if (channel.width >= channel.range) continue; // always high
+
+        SOFT_PWM_EDGE edge;
+        edge.offset_ns = schedule->period_ns * channel.width / channel.range;
+        edge.clear_mask = bit;
+        schedule->edges.push_back(edge);
+    }
+
+    std::sort(schedule->edges.begin(), schedule->edges.end(),
+        [](const SOFT_PWM_EDGE& a, const SOFT_PWM_EDGE& b){ return a.offset_ns < b.offset_ns; });
+
+    // pins going low together are written together.
+    std::vector<SOFT_PWM_EDGE> merged;
+    for (const SOFT_PWM_EDGE& edge : schedule->edges)
+    {
+        if (!merged.empty() && (merged.back().offset_ns == edge.offset_ns))
+        {
+            merged.back().clear_mask |= edge.clear_mask;
+            continue;
+        }
+        merged.push_back(edge);
+    }
+    schedule->edges.swap(merged);
+
+    m_schedule = schedule;
+    m_schedule_changed = true;
+}
+
+
+/**
+ * @brief play latest schedule as a DMA waveform - called without m_mutex
+ * as CGPIODMA::play may wait for DMA to leave the chain it reuses.
+ * edge offsets are rounded to samples from period start so rounding does not add up.
+ */
+void CGPIOSoftPWM::playDMA ()
+{
+    if (!m_dma.isOpen()) return ;
+
+    // one waveform at a time. schedule is read after the lock so the latest one is played last.
+    const std::lock_guard<std::mutex> dma_lock(m_dma_mutex);
+
+    std::shared_ptr<const SOFT_PWM_SCHEDULE> schedule;
+    uint64_t release_mask;
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        schedule = m_schedule;
+        release_mask = m_release_mask & ~schedule->set_mask;
+        m_release_mask = 0;
+    }
+
+    const uint64_t sample_ns = m_dma.getSampleUS() * 1000ull;
+    const uint64_t period_samples = std::max<uint64_t>(1, (schedule->period_ns + sample_ns / 2) / sample_ns);
+
+    std::vector<WAVEFORM_PULSE> pulses;
+    pulses.reserve(schedule->edges.size() + 1);
+
+    WAVEFORM_PULSE pulse;
+    pulse.set_mask = schedule->set_mask;
+    pulse.clear_mask = schedule->off_mask;
+    uint64_t pulse_start = 0;
+
+    for (const SOFT_PWM_EDGE& edge : schedule->edges)
+    {
+        const uint64_t edge_sample = std::min(period_samples, (edge.offset_ns + sample_ns / 2) / sample_ns);
+        pulse.delay_samples = static_cast<uint32_t>(edge_sample - pulse_start);
+        pulses.push_back(pulse);
+
+        pulse.set_mask = 0;
+        pulse.clear_mask = edge.clear_mask;
+        pulse_start = edge_sample;
+    }
+
+    pulse.delay_samples = static_cast<uint32_t>(period_samples - pulse_start);
+    pulses.push_back(pulse);
+
+    if (!m_dma.play(pulses.data(), pulses.size(), release_mask))
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_release_mask |= release_mask;
+        std::cerr << _ERROR_CONSOLE_TEXT_ << "Error: soft PWM waveform of " << pulses.size() << " pulses not played." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+}
+
+
+void CGPIOSoftPWM::loopPWM ()
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = GPIO_SOFT_PWM_PRIORITY;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+    {
+        std::cout << _LOG_CONSOLE_BOLD_TEXT << "WARNING: soft PWM runs without real-time priority." << _NORMAL_CONSOLE_TEXT_ << std::endl;
+    }
+
+    std::shared_ptr<const SOFT_PWM_SCHEDULE> schedule;
+    SOFT_PWM_STATS stats;
+    bool write_off_mask = false;
+    uint64_t release_mask = 0;
+
+    uint64_t period_start_ns = monotonic_ns();
+    uint64_t wall_start_ns = period_start_ns;
+    uint64_t cpu_start_ns = monotonic_ns(CLOCK_THREAD_CPUTIME_ID);
+
+    while (!m_exit_thread)
+    {
+        if (m_schedule_changed.exchange(false))
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (stats.wall_ns >= 1000000000ull) printStats(stats);
+
+            schedule = m_schedule;
+            release_mask = m_release_mask & ~schedule->set_mask;
+            m_release_mask = 0;
+            stats = SOFT_PWM_STATS();
+            stats.channels = schedule->channels;
+            m_stats = stats;
+            write_off_mask = true;
+            wall_start_ns = monotonic_ns();
+            cpu_start_ns = monotonic_ns(CLOCK_THREAD_CPUTIME_ID);
+        }
+
+        if (schedule == nullptr) break;
+
+        waitUntil(period_start_ns);
+        m_write_handler(schedule->set_mask, write_off_mask ? (schedule->off_mask | release_mask) : 0);
+        write_off_mask = false;
+
+        uint64_t lateness_ns = monotonic_ns() - period_start_ns;
+        stats.lateness_sum_ns += lateness_ns;
+        stats.lateness_max_ns = std::max(stats.lateness_max_ns, lateness_ns);
+
+        for (const SOFT_PWM_EDGE& edge : schedule->edges)
+        {
+            const uint64_t deadline_ns = period_start_ns + edge.offset_ns;
+            waitUntil(deadline_ns);
+            m_write_handler(0, edge.clear_mask);
+
+            lateness_ns = monotonic_ns() - deadline_ns;
+            stats.lateness_sum_ns += lateness_ns;
+            stats.lateness_max_ns = std::max(stats.lateness_max_ns, lateness_ns);
+        }
+
+        stats.periods++;
+        stats.edges += schedule->edges.size() + 1;
+        period_start_ns += schedule->period_ns;
+
+        const uint64_t now_ns = monotonic_ns();
+        if (now_ns > period_start_ns)
+        {   // thread was delayed by more than a period - skip to current one.
+            const uint64_t missed = (now_ns - period_start_ns) / schedule->period_ns + 1;
+            stats.missed_periods += missed;
+            period_start_ns += missed * schedule->period_ns;
+        }
+
+        stats.wall_ns = now_ns - wall_start_ns;
+        stats.cpu_ns = monotonic_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start_ns;
+
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = stats;
+    }
+}
+
+
+/**
+ * @brief sleep until GPIO_SOFT_PWM_SPIN_US before deadline then busy wait.
+ */
+void CGPIOSoftPWM::waitUntil (const uint64_t deadline_ns) const
+{
+    const uint64_t spin_ns = GPIO_SOFT_PWM_SPIN_US * 1000ull;
+
+    if (monotonic_ns() + spin_ns < deadline_ns)
+    {
+        const uint64_t sleep_ns = deadline_ns - spin_ns;
+        struct timespec wake;
+        wake.tv_sec = sleep_ns / 1000000000ull;
+        wake.tv_nsec = sleep_ns % 1000000000ull;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR)
+        {
+        }
+    }
+
+    while (monotonic_ns() < deadline_ns)
+    {
+    }
+}
+
+
+void CGPIOSoftPWM::printStats (const SOFT_PWM_STATS& stats) const
+{
+    const uint64_t mean_ns = (stats.edges == 0) ? 0 : stats.lateness_sum_ns / stats.edges;
+    const double cpu = (stats.wall_ns == 0) ? 0.0 : 100.0 * stats.cpu_ns / stats.wall_ns;
+
+    std::cout << _INFO_CONSOLE_TEXT << "Soft PWM: channels:" << _LOG_CONSOLE_BOLD_TEXT << stats.channels
+              << _INFO_CONSOLE_TEXT << " periods:" << _LOG_CONSOLE_BOLD_TEXT << stats.periods
+              << _INFO_CONSOLE_TEXT << " missed:" << _LOG_CONSOLE_BOLD_TEXT << stats.missed_periods
+              << _INFO_CONSOLE_TEXT << " lateness mean(us):" << _LOG_CONSOLE_BOLD_TEXT << mean_ns / 1000
+              << _INFO_CONSOLE_TEXT << " max(us):" << _LOG_CONSOLE_BOLD_TEXT << stats.lateness_max_ns / 1000
+              << _INFO_CONSOLE_TEXT << " cpu(%):" << _LOG_CONSOLE_BOLD_TEXT << cpu
+              << _NORMAL_CONSOLE_TEXT_ << std::endl;
+}
@@ -0,0 +1,161 @@
+#ifndef GPIO_SOFT_PWM_H_
+#define GPIO_SOFT_PWM_H_
+
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+#include "gpio_dma.hpp"
+
+
+#define GPIO_SOFT_PWM_PINS 54
+#define GPIO_SOFT_PWM_DEFAULT_FREQ 100.0 // Hz - same default as wiringPi softPwm
+#define GPIO_SOFT_PWM_SPIN_US 20 // last part of each wait is a busy wait
+#define GPIO_SOFT_PWM_PRIORITY 85 // SCHED_FIFO priority of PWM thread
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief pins that go low at offset_ns from period start.
+     */
+    typedef struct SOFT_PWM_EDGE{
+            uint64_t offset_ns;
+            uint64_t clear_mask;
+        } SOFT_PWM_EDGE;
+
+
+    /**
+     * @brief one PWM period of all channels.
+     * set_mask pins go high at period start, off_mask pins are kept low.
+     * edges are sorted by offset, pins with the same offset share one edge.
+     */
+    typedef struct SOFT_PWM_SCHEDULE{
+            uint64_t period_ns;
+            uint64_t set_mask;
+            uint64_t off_mask;
+            std::vector<SOFT_PWM_EDGE> edges;
+            uint channels;
+        } SOFT_PWM_SCHEDULE;
+
+
+    /**
+     * @brief timing of the PWM thread since schedule was last rebuilt.
+     * lateness is time between planned and actual write of an edge.
+     */
+    typedef struct SOFT_PWM_STATS{
+            uint channels = 0;
+            uint64_t periods = 0;
+            uint64_t missed_periods = 0;
+            uint64_t edges = 0;
+            uint64_t lateness_sum_ns = 0;
+            uint64_t lateness_max_ns = 0;
+            uint64_t cpu_ns = 0;
+            uint64_t wall_ns = 0;
+        } SOFT_PWM_STATS;
+
+
+    /**
+     * @brief Software PWM of SOFT_PWM_OUTPUT pins.
+     *
+     * One SCHED_FIFO thread drives all channels. All channels share one frequency
+     * so a period is a single sorted list of edges, written as set/clear masks.
+     * The schedule is rebuilt only when a width changes and is swapped in at the next period.
+     *
+     * After useDMA() the schedule is played as a DMA waveform instead - no thread and no jitter,
+     * edges are rounded to the DMA sample time.
+     */
+    class CGPIOSoftPWM
+    {
+        public:
+
+            typedef std::function<void(const uint64_t set_mask, const uint64_t clear_mask)> WRITE_HANDLER;
+
+        public:
+
+            CGPIOSoftPWM()
+            {
+
+            }
+
+            CGPIOSoftPWM(CGPIOSoftPWM const&)          = delete;
+            void operator=(CGPIOSoftPWM const&)       = delete;
+
+            ~CGPIOSoftPWM ()
+            {
+                stop();
+            }
+
+        public:
+
+            void setWriteHandler (WRITE_HANDLER write_handler);
+            bool useDMA (const uint dma_channel, const uint sample_us);
+            void setFrequency (const double freq);
+
+            inline double getFrequency () const
+            {
+                return m_freq;
+            }
+
+            /**
+             * @brief DMA paces waveforms with the PWM peripheral - hardware PWM is not available.
+             */
+            inline bool isDMA () const
+            {
+                return m_dma.isOpen();
+            }
+
+            void setWidth (const uint pin_number, const uint32_t width, const uint32_t range);
+            void removeChannel (const uint pin_number);
+            void stop ();
+
+            SOFT_PWM_STATS getStats () const;
+
+        private:
+
+            typedef struct SOFT_PWM_CHANNEL{
+                    bool active = false;
+                    uint32_t width = 0;
+                    uint32_t range = 1;
+                } SOFT_PWM_CHANNEL;
+
+            void rebuildSchedule ();
+            void playDMA ();
+            void loopPWM ();
+            void waitUntil (const uint64_t deadline_ns) const;
+            void printStats (const SOFT_PWM_STATS& stats) const;
+
+        private:
+
+            WRITE_HANDLER m_write_handler;
+            double m_freq = GPIO_SOFT_PWM_DEFAULT_FREQ;
+
+            // channels & schedule are changed by callers and read by PWM thread at period start.
+            mutable std::mutex m_mutex;
+            std::array<SOFT_PWM_CHANNEL, GPIO_SOFT_PWM_PINS> m_channels;
+            std::shared_ptr<const SOFT_PWM_SCHEDULE> m_schedule;
+            std::atomic<bool> m_schedule_changed {false};
+            // removed channels - written low at start of next schedule or waveform.
+            uint64_t m_release_mask = 0;
+
+            SOFT_PWM_STATS m_stats;
+
+            CGPIODMA m_dma;
+            std::mutex m_dma_mutex;        // serializes waveforms - never taken inside m_mutex
+
+            std::thread m_thread;
+            std::atomic<bool> m_exit_thread {true};
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include <algorithm>
+
+#include "gpio_status_codec.hpp"
+
+
+using namespace de::gpio;
+
+
+/**
+ * @brief encode pins into a binary GPIO_STATUS frame.
+ *
+ * @param gpios pins - any order, frame is always in ascending pin order.
+ * @param buffer cleared and filled with the frame.
+ */
+void CGPIOStatusCodec::encode (const GPIO* gpios, const size_t count, std::vector<uint8_t>& buffer)
+{
+    const GPIO* by_pin[MAX_GPIO_PINS] = {};
+    uint64_t pin_bitmap = 0;
+    uint64_t level_bitmap = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GPIO& gpio = gpios[i];
+        if (gpio.pin_number >= MAX_GPIO_PINS) continue;
+
+        by_pin[gpio.pin_number] = &gpio;
+        pin_bitmap |= 1ull << gpio.pin_number;
+        if (gpio.pin_value == 1) level_bitmap |= 1ull << gpio.pin_number;
+    }
+
+    buffer.clear();
+    buffer.push_back(GPIO_STATUS_BINARY_VERSION);
+    putUInt64(buffer, pin_bitmap);
+    putUInt64(buffer, level_bitmap);
+
+    for (uint pin = 0; pin < MAX_GPIO_PINS; ++pin)
+    {
+        const GPIO* gpio = by_pin[pin];
+        if (gpio == nullptr) continue;
+
+        uint8_t flags = (gpio->pin_mode & 0x0f) | ((gpio->gpio_type & 0x03) << 4);
+        if (!gpio->pin_name.empty()) flags |= GPIO_STATUS_FLAG_NAME;
+        if (gpio->pin_value > 1) flags |= GPIO_STATUS_FLAG_WIDE_VALUE;
+        buffer.push_back(flags);
+
+        if (flags & GPIO_STATUS_FLAG_WIDE_VALUE) putVarint(buffer, gpio->pin_value);
+        if ((gpio->pin_mode == PWM_OUTPUT) || (gpio->pin_mode == SOFT_PWM_OUTPUT)) putVarint(buffer, gpio->pin_pwm_width);
+
+        if (flags & GPIO_STATUS_FLAG_NAME)
+        {
+            const size_t name_length = std::min<size_t>(gpio->pin_name.size(), 255);
+            buffer.push_back(static_cast<uint8_t>(name_length));
+            buffer.insert(buffer.end(), gpio->pin_name.begin(), gpio->pin_name.begin() + name_length);
+        }
+    }
+}
+
+
+/**
+ * @brief decode a binary GPIO_STATUS frame.
+ *
+ * @return false if frame is truncated or of unknown version.
+ */
+bool CGPIOStatusCodec::decode (const uint8_t* buffer, const size_t length, std::vector<GPIO>& gpios)
+{
+    gpios.clear();
+
+    if ((length < 1) || (buffer[0] != GPIO_STATUS_BINARY_VERSION)) return false;
+
+    size_t offset = 1;
+    uint64_t pin_bitmap;
+    uint64_t level_bitmap;
+    if (!getUInt64(buffer, length, offset, pin_bitmap)) return false;
+    if (!getUInt64(buffer, length, offset, level_bitmap)) return false;
+
+    for (uint pin = 0; pin < MAX_GPIO_PINS; ++pin)
+    {
+        if (!(pin_bitmap & (1ull << pin))) continue;
+        if (offset >= length) return false;
+
+        const uint8_t flags = buffer[offset++];
+
+        GPIO gpio;
+        gpio.pin_number = pin;
+        gpio.pin_mode = flags & 0x0f;
+        gpio.gpio_type = static_cast<ENUM_GPIO_TYPE>((flags >> 4) & 0x03);
+        gpio.pin_value = (level_bitmap >> pin) & 1;
+        gpio.pin_pwm_width = 0;
+
+        uint32_t value;
+        if (flags & GPIO_STATUS_FLAG_WIDE_VALUE)
+        {
+            if (!getVarint(buffer, length, offset, value)) return false;
+            gpio.pin_value = value;
+        }
+
+        if ((gpio.pin_mode == PWM_OUTPUT) || (gpio.pin_mode == SOFT_PWM_OUTPUT))
+        {
+            if (!getVarint(buffer, length, offset, value)) return false;
+            gpio.pin_pwm_width = value;
+        }
+
+        if (flags & GPIO_STATUS_FLAG_NAME)
+        {
+            if (offset >= length) return false;
+            const size_t name_length = buffer[offset++];
+            if (offset + name_length > length) return false;
+            gpio.pin_name.assign(reinterpret_cast<const char*>(buffer + offset), name_length);
+            offset += name_length;
+        }
+
+        gpios.push_back(gpio);
+    }
+
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef GPIO_STATUS_CODEC_H_
+#define GPIO_STATUS_CODEC_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "gpio_driver.hpp"
+
+
+#define GPIO_STATUS_FORMAT_JSON         0
+#define GPIO_STATUS_FORMAT_BINARY       1
+
+#define GPIO_STATUS_BINARY_VERSION      1
+
+// record flags
+#define GPIO_STATUS_FLAG_NAME           0x40    // name follows: length byte + chars
+#define GPIO_STATUS_FLAG_WIDE_VALUE     0x80    // value is not 0/1 - varint value follows
+
+
+namespace de
+{
+namespace gpio
+{
+
+    /**
+     * @brief Compact binary GPIO_STATUS frame.
+     *
+     * Module key is sent once in the JSON header of the binary message.
+     *
+     *      uint8   version
+     *      uint64  pin bitmap          bit n set if GPIO n is in the frame
+     *      uint64  level bitmap        bit n is value of GPIO n when value is 0/1
+     *      records in ascending pin order:
+     *          uint8   mode(bits 0-3) | gpio_type(bits 4-5) | GPIO_STATUS_FLAG_NAME | GPIO_STATUS_FLAG_WIDE_VALUE
+     *          varint  value           if GPIO_STATUS_FLAG_WIDE_VALUE
+     *          varint  pwm width       if mode is PWM_OUTPUT or SOFT_PWM_OUTPUT
+     *          uint8 length + chars    if GPIO_STATUS_FLAG_NAME
+     *
+     * bitmaps & multi-byte fields are little endian.
+     */
+    class CGPIOStatusCodec
+    {
+        public:
+
+            static void encode (const GPIO* gpios, const size_t count, std::vector<uint8_t>& buffer);
+            static bool decode (const uint8_t* buffer, const size_t length, std::vector<GPIO>& gpios);
+
+        public:
+
+            static inline void putVarint (std::vector<uint8_t>& buffer, uint32_t value)
+            {
+                while (value >= 0x80)
+                {
+                    buffer.push_back(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                buffer.push_back(static_cast<uint8_t>(value));
+            }
+
+            static inline bool getVarint (const uint8_t* buffer, const size_t length, size_t& offset, uint32_t& value)
+            {
+                value = 0;
+                for (uint shift = 0; (shift < 35) && (offset < length); shift += 7)
+                {
+                    const uint8_t byte = buffer[offset++];
+                    value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+                    if (!(byte & 0x80)) return true;
+                }
+                return false;
+            }
+
+            static inline void putUInt64 (std::vector<uint8_t>& buffer, const uint64_t value)
+            {
+                for (uint i = 0; i < 8; ++i)
+                {
+                    buffer.push_back(static_cast<uint8_t>(value >> (i * 8)));
+                }
+            }
+
+            static inline bool getUInt64 (const uint8_t* buffer, const size_t length, size_t& offset, uint64_t& value)
+            {
+                if (offset + 8 > length) return false;
+
+                value = 0;
+                for (uint i = 0; i < 8; ++i)
+                {
+                    value |= static_cast<uint64_t>(buffer[offset++]) << (i * 8);
+                }
+                return true;
+            }
+    };
+
+}
+}
+
+#endif
@@ -16,6 +16,7 @@
 #include "./de_common/de_databus/de_module.hpp"
 #include "./gpio/gpio_driver.hpp"
 #include "./gpio/gpio_main.hpp"
+#include "./gpio/gpio_latency.hpp"
 
 
 using namespace de;
@@ -55,6 +56,7 @@ static std::string hardware_serial;
 
        
 void quit_handler( int sig );
+void latency_dump_handler( int sig );
 void onReceive (const char * message, int len, Json_de jMsg);
 void uninit ();
 
@@ -123,6 +125,9 @@ void onReceive (const char * message, int len, Json_de jMsg)
         std::cout << _INFO_CONSOLE_TEXT << "RX MSG: :len " << std::to_string(len) << ":" << message <<   _NORMAL_CONSOLE_TEXT_ << std::endl;
     #endif
     
+    de::gpio::CGPIOLatency& cGPIOLatency = de::gpio::CGPIOLatency::getInstance();
+    cGPIOLatency.begin();
+
     try
     {
         cGPIOParser.parseMessage(jMsg, message, len);
@@ -131,6 +136,8 @@ void onReceive (const char * message, int len, Json_de jMsg)
     {
         std::cerr << e.what() << '\n';
     }
+
+    cGPIOLatency.end();
 }
 
 
@@ -239,6 +246,7 @@ void init (int argc, char *argv[])
 {
     signal(SIGINT,quit_handler);
     signal(SIGTERM,quit_handler);
+    signal(SIGUSR1,latency_dump_handler);
     
     instance_time_stamp = std::time(nullptr);
     
@@ -318,6 +326,12 @@ void quit_handler( int sig )
     }
 }
 
+// this function is called on SIGUSR1 - command latency is printed by scheduler thread.
+void latency_dump_handler( int sig )
+{
+    de::gpio::CGPIOLatency::getInstance().requestDump();
+}
+
 int main (int argc, char *argv[])
 {
     #ifdef DDEBUG
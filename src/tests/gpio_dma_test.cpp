@@ -0,0 +1,213 @@
+/**
+ * @brief DMA waveform chains run through CGPIODMA::simulate().
+ *
+ * Edges of a 2-pin servo waveform must fall on their sample times every period,
+ * and delays longer than one control block can hold must keep their length.
+ */
+
+#include <vector>
+
+#include "../gpio/gpio_dma.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+#define TEST_SAMPLE_US  5
+#define TEST_PIN_A      17
+#define TEST_PIN_B      18
+
+
+static const uint64_t PIN_A = 1ull << TEST_PIN_A;
+static const uint64_t PIN_B = 1ull << TEST_PIN_B;
+
+
+/**
+ * @brief 50 Hz servo pulses - pin A 1500us, pin B 1000us.
+ */
+static void testServoWaveform ()
+{
+    CGPIODMA dma;
+    CHECK(dma.openSimulation(TEST_SAMPLE_US));
+
+    const WAVEFORM_PULSE pulses[] = {
+        {PIN_A | PIN_B, 0, 1000 / TEST_SAMPLE_US},
+        {0, PIN_B, 500 / TEST_SAMPLE_US},
+        {0, PIN_A, 18500 / TEST_SAMPLE_US},
+    };
+    CHECK(dma.play(pulses, 3, 0));
+
+    std::vector<WAVEFORM_TRANSITION> transitions;
+    dma.simulate(3 * 20000, transitions);
+
+    CHECK(transitions.size() == 9);
+    if (transitions.size() != 9) return ;
+
+    for (uint period = 0; period < 3; ++period)
+    {
+        const uint64_t start_us = period * 20000;
+        const WAVEFORM_TRANSITION* t = &transitions[period * 3];
+
+        CHECK(t[0].time_us == start_us);
+        CHECK(t[0].levels == (PIN_A | PIN_B));
+        CHECK(t[1].time_us == start_us + 1000);
+        CHECK(t[1].levels == PIN_A);
+        CHECK(t[2].time_us == start_us + 1500);
+        CHECK(t[2].levels == 0);
+    }
+}
+
+
+/**
+ * @brief a new waveform starts when the running one ends its period.
+ */
+static void testWaveformReplace ()
+{
+    CGPIODMA dma;
+    CHECK(dma.openSimulation(TEST_SAMPLE_US));
+
+    const WAVEFORM_PULSE first[] = {
+        {PIN_A, 0, 1000 / TEST_SAMPLE_US},
+        {0, PIN_A, 9000 / TEST_SAMPLE_US},
+    };
+    CHECK(dma.play(first, 2, 0));
+
+    std::vector<WAVEFORM_TRANSITION> transitions;
+    dma.simulate(2500, transitions);
+
+    const WAVEFORM_PULSE second[] = {
+        {PIN_B, 0, 2000 / TEST_SAMPLE_US},
+        {0, PIN_B, 8000 / TEST_SAMPLE_US},
+    };
+    CHECK(dma.play(second, 2, 0));
+
+    dma.simulate(20000, transitions);
+
+    CHECK(transitions.size() == 6);
+    if (transitions.size() != 6) return ;
+
+    CHECK((transitions[0].time_us == 0) && (transitions[0].levels == PIN_A));
+    CHECK((transitions[1].time_us == 1000) && (transitions[1].levels == 0));
+    CHECK((transitions[2].time_us == 10000) && (transitions[2].levels == PIN_B));
+    CHECK((transitions[3].time_us == 12000) && (transitions[3].levels == 0));
+    CHECK((transitions[4].time_us == 20000) && (transitions[4].levels == PIN_B));
+    CHECK((transitions[5].time_us == 22000) && (transitions[5].levels == 0));
+}
+
+
+/**
+ * @brief a released pin is cleared once when the new waveform starts, then stays untouched.
+ */
+static void testRelease ()
+{
+    CGPIODMA dma;
+    CHECK(dma.openSimulation(TEST_SAMPLE_US));
+
+    const WAVEFORM_PULSE both[] = {
+        {PIN_A | PIN_B, 0, 1000 / TEST_SAMPLE_US},
+        {0, PIN_A, 9000 / TEST_SAMPLE_US},
+    };
+    CHECK(dma.play(both, 2, 0));
+
+    std::vector<WAVEFORM_TRANSITION> transitions;
+    dma.simulate(500, transitions);
+
+    // pin B is always high - removed while high.
+    const WAVEFORM_PULSE only_a[] = {
+        {PIN_A, 0, 1000 / TEST_SAMPLE_US},
+        {0, PIN_A, 9000 / TEST_SAMPLE_US},
+    };
+    CHECK(dma.play(only_a, 2, PIN_B));
+
+    dma.simulate(29000, transitions);
+
+    CHECK(transitions.size() == 6);
+    if (transitions.size() != 6) return ;
+
+    CHECK((transitions[0].time_us == 0) && (transitions[0].levels == (PIN_A | PIN_B)));
+    CHECK((transitions[1].time_us == 1000) && (transitions[1].levels == PIN_B));
+    CHECK((transitions[2].time_us == 10000) && (transitions[2].levels == PIN_A));
+    CHECK((transitions[3].time_us == 11000) && (transitions[3].levels == 0));
+    CHECK((transitions[4].time_us == 20000) && (transitions[4].levels == PIN_A));
+    CHECK((transitions[5].time_us == 21000) && (transitions[5].levels == 0));
+}
+
+
+/**
+ * @brief 1 Hz waveform - delays are split so no control block exceeds a 16-bit txfr_len.
+ */
+static void testLongDelay ()
+{
+    const uint32_t high_samples = 300000 / TEST_SAMPLE_US;
+    const uint32_t low_samples = 700000 / TEST_SAMPLE_US;
+    const WAVEFORM_PULSE pulses[] = {
+        {PIN_A, 0, high_samples},
+        {0, PIN_A, low_samples},
+    };
+
+    // chain as built for hardware.
+    std::vector<DMA_CONTROL_BLOCK> control_blocks(64);
+    std::vector<uint32_t> data(64);
+    const size_t count = CGPIODMA::buildChain(pulses, 2, 0, control_blocks.data(), 0x1000, control_blocks.size(),
+                                              data.data(), 0x2000, data.size(), 0x3000, 0x4000);
+    CHECK(count > 0);
+
+    uint64_t samples = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        CHECK(control_blocks[i].txfr_len <= 0xffff);
+        CHECK(control_blocks[i].nextconbk == 0x1000 + ((i + 1) % count) * sizeof(DMA_CONTROL_BLOCK));
+        if (control_blocks[i].dest_ad == 0x4000) samples += control_blocks[i].txfr_len / 4;
+    }
+    CHECK(samples == high_samples + low_samples);
+
+    // same waveform in simulation keeps its edge times.
+    CGPIODMA dma;
+    CHECK(dma.openSimulation(TEST_SAMPLE_US));
+    CHECK(dma.play(pulses, 2, 0));
+
+    std::vector<WAVEFORM_TRANSITION> transitions;
+    dma.simulate(2000000, transitions);
+
+    CHECK(transitions.size() == 4);
+    if (transitions.size() != 4) return ;
+
+    CHECK((transitions[0].time_us == 0) && (transitions[0].levels == PIN_A));
+    CHECK((transitions[1].time_us == 300000) && (transitions[1].levels == 0));
+    CHECK((transitions[2].time_us == 1000000) && (transitions[2].levels == PIN_A));
+    CHECK((transitions[3].time_us == 1300000) && (transitions[3].levels == 0));
+}
+
+
+/**
+ * @brief a waveform without delay would spin the DMA engine.
+ */
+static void testNoDelayRejected ()
+{
+    CGPIODMA dma;
+    CHECK(dma.openSimulation(TEST_SAMPLE_US));
+
+    const WAVEFORM_PULSE pulses[] = {
+        {PIN_A, 0, 0},
+        {0, PIN_A, 0},
+    };
+    CHECK(!dma.play(pulses, 2, 0));
+}
+
+
+int main ()
+{
+    {
+        CQuietConsole quiet;
+
+        testServoWaveform();
+        testWaveformReplace();
+        testRelease();
+        testLongDelay();
+        testNoDelayRejected();
+    }
+
+    return report("gpio_dma_test");
+}
@@ -0,0 +1,187 @@
+/**
+ * @brief CGPIOEncoder decodes quadrature edges through its transition table and keeps readers apart.
+ */
+
+#include <thread>
+#include <chrono>
+
+#include "../gpio/gpio_encoder.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+#define TEST_PIN_A 5
+#define TEST_PIN_B 6
+#define TEST_PIN_INDEX 13
+
+
+static void addEncoder (CGPIOEncoder& encoders, const bool index_reset)
+{
+    GPIO_ENCODER encoder;
+    encoder.name = "wheel";
+    encoder.pin_a = TEST_PIN_A;
+    encoder.pin_b = TEST_PIN_B;
+    encoder.pin_index = TEST_PIN_INDEX;
+    encoder.index_reset = index_reset;
+
+    CHECK(encoders.addEncoder(encoder) == 0);
+    encoders.setLevel(TEST_PIN_A, 0);
+    encoders.setLevel(TEST_PIN_B, 0);
+}
+
+
+/**
+ * @brief full cycles with A leading B (up) or B leading A (down) - four counts each.
+ */
+static void turn (CGPIOEncoder& encoders, const uint cycles, const bool up)
+{
+    const uint first = up ? TEST_PIN_A : TEST_PIN_B;
+    const uint second = up ? TEST_PIN_B : TEST_PIN_A;
+
+    for (uint i = 0; i < cycles; ++i)
+    {
+        encoders.onEdge(first, 1);
+        encoders.onEdge(second, 1);
+        encoders.onEdge(first, 0);
+        encoders.onEdge(second, 0);
+    }
+}
+
+
+static void pulseIndex (CGPIOEncoder& encoders)
+{
+    encoders.onEdge(TEST_PIN_INDEX, 1);
+    encoders.onEdge(TEST_PIN_INDEX, 0);
+}
+
+
+static ENCODER_STATUS status (CGPIOEncoder& encoders, const uint reader = GPIO_ENCODER_READER_REQUEST)
+{
+    ENCODER_STATUS encoder_status = {};
+    CHECK(encoders.getStatus(0, encoder_status, reader));
+    return encoder_status;
+}
+
+
+static void testDirection ()
+{
+    CGPIOEncoder encoders;
+    addEncoder(encoders, false);
+
+    turn(encoders, 10, true);
+    CHECK(status(encoders).position == 40);
+
+    turn(encoders, 3, false);
+    CHECK(status(encoders).position == 28);
+
+    // each single transition of a half cycle counts too.
+    encoders.onEdge(TEST_PIN_A, 1);
+    CHECK(status(encoders).position == 29);
+    encoders.onEdge(TEST_PIN_A, 0);
+    CHECK(status(encoders).position == 28);
+    CHECK(status(encoders).errors == 0);
+}
+
+
+static void testIllegalTransitions ()
+{
+    CGPIOEncoder encoders;
+    addEncoder(encoders, false);
+
+    // an edge that leaves the state unchanged means one of the other channel was lost.
+    encoders.onEdge(TEST_PIN_A, 1);
+    encoders.onEdge(TEST_PIN_A, 1);
+    ENCODER_STATUS encoder_status = status(encoders);
+    CHECK(encoder_status.position == 1);
+    CHECK(encoder_status.errors == 1);
+
+    // decoding continues from the state after the error.
+    encoders.onEdge(TEST_PIN_B, 1);
+    encoder_status = status(encoders);
+    CHECK(encoder_status.position == 2);
+    CHECK(encoder_status.errors == 1);
+}
+
+
+static void testIndex ()
+{
+    CGPIOEncoder encoders;
+    addEncoder(encoders, false);
+
+    turn(encoders, 5, true);
+    pulseIndex(encoders);
+    turn(encoders, 2, true);
+
+    const ENCODER_STATUS encoder_status = status(encoders);
+    CHECK(encoder_status.position == 28);
+    CHECK(encoder_status.index_count == 1);
+    CHECK(encoder_status.index_position == 20);
+}
+
+
+/**
+ * @brief an index reset after zero() must not leave the zero offset applied.
+ */
+static void testIndexResetClearsOffset ()
+{
+    CGPIOEncoder encoders;
+    addEncoder(encoders, true);
+
+    turn(encoders, 5, true);
+    CHECK(encoders.zero(0));
+    CHECK(status(encoders).position == 0);
+
+    turn(encoders, 1, true);
+    CHECK(status(encoders).position == 4);
+
+    pulseIndex(encoders);
+    turn(encoders, 2, true);
+    const ENCODER_STATUS encoder_status = status(encoders);
+    CHECK(encoder_status.position == 8);
+    CHECK(encoder_status.index_count == 1);
+
+    // zero() after the index applies again until the next one.
+    CHECK(encoders.zero(0));
+    turn(encoders, 1, false);
+    CHECK(status(encoders).position == -4);
+}
+
+
+/**
+ * @brief a request between two reports does not take counts from the report window.
+ */
+static void testReaderWindows ()
+{
+    CGPIOEncoder encoders;
+    addEncoder(encoders, true);
+
+    status(encoders, GPIO_ENCODER_READER_REPORT);
+
+    turn(encoders, 25, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK(status(encoders, GPIO_ENCODER_READER_REQUEST).velocity > 0.0);
+    CHECK(status(encoders, GPIO_ENCODER_READER_REQUEST).velocity == 0.0);
+
+    // travel survives the index reset - velocity does not jump backwards.
+    pulseIndex(encoders);
+    CHECK(status(encoders, GPIO_ENCODER_READER_REPORT).velocity > 0.0);
+
+    ENCODER_STATUS encoder_status;
+    CHECK(!encoders.getStatus(0, encoder_status, GPIO_ENCODER_READERS));
+    CHECK(!encoders.getStatus(1, encoder_status, GPIO_ENCODER_READER_REPORT));
+}
+
+
+int main ()
+{
+    testDirection();
+    testIllegalTransitions();
+    testIndex();
+    testIndexResetClearsOffset();
+    testReaderWindows();
+
+    return report("gpio_encoder_test");
+}
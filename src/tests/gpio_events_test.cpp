@@ -0,0 +1,118 @@
+/**
+ * @brief CGPIOEvents keeps running on injected events when the chip lines cannot be requested.
+ */
+
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <vector>
+
+#include "../gpio/gpio_events.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+#define TEST_CHIP "/nonexistent/gpiochip0"
+#define TEST_MASK ((1ull << 17) | (1ull << 27))
+
+
+/**
+ * @brief events delivered by the event thread.
+ */
+class CEventLog
+{
+    public:
+
+        void add (const GPIO_EVENT& event)
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_events.push_back(event);
+            m_condition.notify_all();
+        }
+
+        std::vector<GPIO_EVENT> waitFor (const size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, std::chrono::seconds(2), [&](){ return m_events.size() >= count; });
+            return m_events;
+        }
+
+    private:
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::vector<GPIO_EVENT> m_events;
+};
+
+
+static void testFailedRequest ()
+{
+    CGPIOEvents events;
+    CEventLog log;
+
+    {
+    CQuietConsole quiet;
+    CHECK(events.start(TEST_CHIP, TEST_MASK, [&](const GPIO_EVENT& event){ log.add(event); }, nullptr));
+    }
+
+    // thread runs without lines - the requested mask is kept so the caller does not retry.
+    CHECK(events.isRunning());
+    CHECK(events.getPinMask() == 0);
+    CHECK(events.getRequestedMask() == TEST_MASK);
+
+    uint64_t levels;
+    CHECK(!events.readLevels(levels));
+
+    events.stop();
+    CHECK(!events.isRunning());
+    CHECK(events.getRequestedMask() == 0);
+}
+
+
+static void testInjectedEvents ()
+{
+    CGPIOEvents events;
+    CEventLog log;
+
+    {
+    CQuietConsole quiet;
+    CHECK(events.start(TEST_CHIP, TEST_MASK, [&](const GPIO_EVENT& event){ log.add(event); }, nullptr));
+    }
+
+    const GPIO_EVENT injected[] = {
+        {17, 1, 1000},
+        {27, 1, 2000},
+        {17, 0, 3000},
+    };
+    for (const GPIO_EVENT& event : injected) CHECK(events.injectEvent(event));
+
+    // delivered on the event thread in injection order.
+    const std::vector<GPIO_EVENT> delivered = log.waitFor(3);
+    CHECK(delivered.size() == 3);
+    for (size_t i = 0; (i < delivered.size()) && (i < 3); ++i)
+    {
+        CHECK(delivered[i].pin_number == injected[i].pin_number);
+        CHECK(delivered[i].level == injected[i].level);
+        CHECK(delivered[i].timestamp_ns == injected[i].timestamp_ns);
+    }
+
+    events.stop();
+    CHECK(events.getStats().injected == 3);
+    CHECK(events.getStats().events == 0);
+
+    // nothing to deliver to once stopped.
+    CHECK(!events.injectEvent(injected[0]));
+}
+
+
+int main ()
+{
+    testFailedRequest();
+    testInjectedEvents();
+
+    return report("gpio_events_test");
+}
@@ -0,0 +1,152 @@
+/**
+ * @brief CGPIOInputFilter decisions for edges, timer deadlines and majority samples.
+ *
+ * The filter does not read lines itself - samples are fed as the event thread would
+ * when isSampleDue() at getDeadline().
+ */
+
+#include "../gpio/gpio_input_filter.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+#define US  1000ull
+
+
+static GPIO_INPUT_FILTER majorityFilter (const uint32_t samples, const uint32_t interval_us)
+{
+    GPIO_INPUT_FILTER settings;
+    settings.majority = samples;
+    settings.majority_interval_us = interval_us;
+    return settings;
+}
+
+
+/**
+ * @brief feed samples at their deadlines. returns true if any sample accepted the edge.
+ */
+static bool feedSamples (CGPIOInputFilter& filter, const uint* levels, const uint count)
+{
+    bool accepted = false;
+    for (uint i = 0; i < count; ++i)
+    {
+        const uint64_t deadline = filter.getDeadline();
+        CHECK(deadline != 0);
+        CHECK(!filter.isSampleDue(deadline - 1));
+        CHECK(filter.isSampleDue(deadline));
+        accepted |= filter.onSample(levels[i]);
+    }
+    return accepted;
+}
+
+
+static void testMajorityAccepts ()
+{
+    CGPIOInputFilter filter;
+    filter.configure(majorityFilter(5, 100), 0);
+    CHECK(filter.isEnabled());
+
+    // edge is not reported before its samples.
+    CHECK(!filter.onEdge(1, 1000 * US));
+    CHECK(filter.getLevel() == 0);
+
+    // samples are spaced from the edge time, not from when it is handled.
+    CHECK(filter.getDeadline() == 1100 * US);
+
+    const uint levels[] = {1, 0, 1, 1, 0};
+    CHECK(feedSamples(filter, levels, 5));
+    CHECK(filter.getLevel() == 1);
+    CHECK(filter.getDeadline() == 0);
+    CHECK(filter.getStats().accepted == 1);
+    CHECK(filter.getStats().filtered_majority == 0);
+}
+
+
+static void testMajorityDropsGlitch ()
+{
+    CGPIOInputFilter filter;
+    filter.configure(majorityFilter(5, 50), 0);
+
+    CHECK(!filter.onEdge(1, 0));
+
+    const uint levels[] = {1, 0, 0, 1, 0};
+    CHECK(!feedSamples(filter, levels, 5));
+    CHECK(filter.getLevel() == 0);
+    CHECK(filter.getDeadline() == 0);
+    CHECK(filter.getStats().filtered_majority == 1);
+}
+
+
+static void testEdgeWhileVoting ()
+{
+    CGPIOInputFilter filter;
+    filter.configure(majorityFilter(3, 100), 0);
+
+    // line returns before first sample - first edge is dropped, nothing is left to vote on.
+    CHECK(!filter.onEdge(1, 0));
+    CHECK(!filter.onEdge(0, 40 * US));
+    CHECK(filter.getDeadline() == 0);
+    CHECK(filter.getStats().filtered_majority == 1);
+
+    // a new edge restarts the vote from its own time.
+    CHECK(!filter.onEdge(1, 500 * US));
+    CHECK(!filter.onEdge(0, 520 * US));
+    CHECK(!filter.onEdge(1, 560 * US));
+    CHECK(filter.getDeadline() == 660 * US);
+
+    const uint levels[] = {1, 1, 1};
+    CHECK(feedSamples(filter, levels, 3));
+    CHECK(filter.getLevel() == 1);
+}
+
+
+static void testMajorityWithDebounce ()
+{
+    GPIO_INPUT_FILTER settings = majorityFilter(3, 100);
+    settings.debounce_us = 5000;
+
+    CGPIOInputFilter filter;
+    filter.configure(settings, 0);
+
+    CHECK(!filter.onEdge(1, 0));
+    const uint levels[] = {1, 1, 1};
+    CHECK(feedSamples(filter, levels, 3));
+    CHECK(filter.getLevel() == 1);
+
+    // bounce within debounce window is ignored, settled level is checked when it ends.
+    CHECK(!filter.onEdge(0, 1000 * US));
+    CHECK(filter.getDeadline() == 5000 * US);
+    CHECK(filter.onTimer(5000 * US));
+    CHECK(filter.getLevel() == 0);
+}
+
+
+static void testMinPulseOverridesMajority ()
+{
+    GPIO_INPUT_FILTER settings = majorityFilter(5, 100);
+    settings.min_pulse_us = 200;
+
+    CGPIOInputFilter filter;
+    filter.configure(settings, 0);
+
+    CHECK(!filter.onEdge(1, 0));
+    CHECK(filter.getDeadline() == 200 * US);
+    CHECK(!filter.isSampleDue(200 * US));
+    CHECK(filter.onTimer(200 * US));
+    CHECK(filter.getLevel() == 1);
+}
+
+
+int main ()
+{
+    testMajorityAccepts();
+    testMajorityDropsGlitch();
+    testEdgeWhileVoting();
+    testMajorityWithDebounce();
+    testMinPulseOverridesMajority();
+
+    return report("gpio_input_filter_test");
+}
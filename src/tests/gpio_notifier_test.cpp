@@ -0,0 +1,127 @@
+/**
+ * @brief CGPIONotifier merges changes within an interval and always reports the final state.
+ */
+
+#include <vector>
+
+#include "../gpio/gpio_notifier.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+#define TEST_PIN 5
+#define TEST_INTERVAL_US 100000
+#define TEST_START_US 1000000
+
+
+/**
+ * @brief level of TEST_PIN as seen by each status message - read when it is sent.
+ */
+static uint s_level = 0;
+static std::vector<uint64_t> s_sent_masks;
+static std::vector<uint> s_sent_levels;
+
+
+static void sent (const uint64_t pin_mask)
+{
+    s_sent_masks.push_back(pin_mask);
+    s_sent_levels.push_back(s_level);
+}
+
+
+static void clearSent ()
+{
+    s_sent_masks.clear();
+    s_sent_levels.clear();
+}
+
+
+static void testCoalescing ()
+{
+    CGPIONotifier& notifier = CGPIONotifier::getInstance();
+    notifier.setInterval(TEST_INTERVAL_US);
+    notifier.start();
+    clearSent();
+
+    // first change is sent at the next tick.
+    s_level = 1;
+    notifier.markChanged(1ull << TEST_PIN);
+    notifier.flush(TEST_START_US);
+    CHECK(s_sent_masks.size() == 1);
+    CHECK(s_sent_masks.back() == (1ull << TEST_PIN));
+
+    // changes within the interval wait - many ticks, no message.
+    uint64_t now_us = TEST_START_US;
+    for (uint i = 0; i < 9; ++i)
+    {
+        now_us += GPIO_NOTIFIER_TICK_US;
+        s_level = i & 1;
+        notifier.markChanged(1ull << TEST_PIN);
+        notifier.flush(now_us);
+    }
+    CHECK(s_sent_masks.size() == 1);
+
+    // one message when the interval ends, with the state at that time.
+    s_level = 1;
+    notifier.flush(TEST_START_US + TEST_INTERVAL_US);
+    CHECK(s_sent_masks.size() == 2);
+    CHECK(s_sent_masks.back() == (1ull << TEST_PIN));
+    CHECK(s_sent_levels.back() == 1);
+
+    // nothing pending - later ticks stay quiet.
+    notifier.flush(TEST_START_US + 3 * TEST_INTERVAL_US);
+    CHECK(s_sent_masks.size() == 2);
+
+    notifier.stop();
+}
+
+
+/**
+ * @brief a negative interval is 0 - a change is sent at the next tick instead of never.
+ */
+static void testNegativeInterval ()
+{
+    CGPIONotifier& notifier = CGPIONotifier::getInstance();
+    notifier.setInterval(-TEST_INTERVAL_US);
+    notifier.start();
+    clearSent();
+
+    const uint64_t now_us = TEST_START_US + 10 * TEST_INTERVAL_US;
+    notifier.markChanged(1ull << TEST_PIN);
+    notifier.flush(now_us);
+    CHECK(s_sent_masks.size() == 1);
+
+    notifier.markChanged(1ull << TEST_PIN);
+    notifier.flush(now_us + GPIO_NOTIFIER_TICK_US);
+    CHECK(s_sent_masks.size() == 2);
+
+    notifier.stop();
+}
+
+
+static void testNotStarted ()
+{
+    CGPIONotifier& notifier = CGPIONotifier::getInstance();
+    notifier.setInterval(TEST_INTERVAL_US);
+    clearSent();
+
+    // sent inline while flush is not running.
+    notifier.markChanged((1ull << TEST_PIN) | 1ull);
+    CHECK(s_sent_masks.size() == 1);
+    CHECK(s_sent_masks.back() == ((1ull << TEST_PIN) | 1ull));
+}
+
+
+int main ()
+{
+    CGPIONotifier::getInstance().setSendHandler(sent);
+
+    testCoalescing();
+    testNegativeInterval();
+    testNotStarted();
+
+    return report("gpio_notifier_test");
+}
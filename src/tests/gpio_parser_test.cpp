@@ -0,0 +1,479 @@
+/**
+ * @brief Messages through CGPIOParser::parseMessage as received by onReceive.
+ *
+ * The actuator is not started, so commands run inline and their effect is checked right after parsing.
+ * Ordering tests start it and hold it with a task while messages are queued.
+ */
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+#include "../de_common/de_databus/messages.hpp"
+#include "../gpio/gpio_driver.hpp"
+#include "../gpio/gpio_parser.hpp"
+#include "../gpio/gpio_command_codec.hpp"
+#include "../gpio/gpio_actuator.hpp"
+#include "../gpio/gpio_notifier.hpp"
+#include "../gpio/gpio_protocol.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+static GPIO makeGPIO (const uint pin_number, const uint pin_mode, const std::string& name)
+{
+    GPIO gpio;
+    gpio.pin_number = pin_number;
+    gpio.pin_mode = pin_mode;
+    gpio.pin_value = 0;
+    gpio.pin_pwm_width = 0;
+    gpio.gpio_type = ENUM_GPIO_TYPE::GENERIC;
+    gpio.pin_name = name;
+    return gpio;
+}
+
+
+static std::string textMessage (const Json_de& cmd, const std::string& sender = "test", const int message_type = TYPE_AndruavMessage_GPIO_ACTION)
+{
+    const Json_de message = {
+        {ANDRUAV_PROTOCOL_MESSAGE_TYPE, message_type},
+        {ANDRUAV_PROTOCOL_SENDER, sender},
+        {ANDRUAV_PROTOCOL_MESSAGE_PERMISSION, 0},
+        {ANDRUAV_PROTOCOL_MESSAGE_CMD, cmd}
+    };
+
+    return message.dump();
+}
+
+
+static std::string binaryMessage (const uint action, const std::vector<uint8_t>& payload)
+{
+    std::string message = textMessage({{"a", action}});
+    message.push_back('\0');
+    message.append(reinterpret_cast<const char*>(payload.data()), payload.size());
+    return message;
+}
+
+
+/**
+ * @brief decode JSON header as onReceive does, then parse whole message.
+ */
+static void receive (const std::string& message)
+{
+    const char * header_end = static_cast<const char *>(memchr(message.data(), 0x0, message.size()));
+    Json_de json = Json_de::parse(message.data(), header_end ? header_end : message.data() + message.size());
+    CGPIOParser::getInstance().parseMessage(json, message.data(), static_cast<int>(message.size()));
+}
+
+
+static uint pinValue (const uint pin_number)
+{
+    const GPIO* gpio = CGPIODriver::getInstance().getGPIOByNumber(pin_number);
+    return (gpio != nullptr) ? gpio->pin_value : 0xffffffff;
+}
+
+
+/**
+ * @brief binary writes whose payload ends in every byte value - 0x7D '}' included.
+ */
+static void testBinaryWriteLastByte ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    driver.configurePort(makeGPIO(21, OUTPUT, "out_21"));
+
+    int ends_with_brace = 0;
+    for (uint value = 0; value < 128; ++value)
+    {
+        // one byte varint - value is the last payload byte.
+        std::vector<uint8_t> payload;
+        const GPIO_WRITE_COMMAND command = {21, value, 0, false};
+        CGPIOCommandCodec::encodeWrite(&command, 1, payload);
+        CHECK(payload.back() == value);
+        if (payload.back() == '}') ++ends_with_brace;
+
+        // opposite level first so every write is a change.
+        driver.writePin(21, value ? 0 : 1);
+        receive(binaryMessage(GPIO_ACTION_PORT_WRITE, payload));
+        CHECK(pinValue(21) == (value ? 1u : 0u));
+    }
+
+    CHECK(ends_with_brace == 1);
+}
+
+
+/**
+ * @brief binary configs whose payload ends in every byte value 0..255 - last byte is last char of name.
+ * a lone byte >= 0x80 is not UTF-8, so those configs are rejected and the pin keeps its config.
+ */
+static void testBinaryConfigLastByte ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+
+    for (uint value = 0; value < 256; ++value)
+    {
+        GPIO gpio = makeGPIO(20, OUTPUT, std::string("cfg_") + static_cast<char>(value));
+        gpio.pin_value = value & 1;
+
+        std::vector<uint8_t> payload;
+        CGPIOCommandCodec::encodeConfig(&gpio, 1, payload);
+        CHECK(payload.back() == value);
+
+        GPIO before = makeGPIO(20, OUTPUT, "before");
+        before.pin_value = (value & 1) ^ 1;
+        driver.configurePort(before);
+        receive(binaryMessage(GPIO_ACTION_PORT_CONFIG, payload));
+
+        const GPIO* configured = driver.getGPIOByNumber(20);
+        CHECK(configured != nullptr);
+        if (configured == nullptr) continue;
+        CHECK(configured->pin_mode == OUTPUT);
+        if (value < 0x80)
+        {
+            CHECK(configured->pin_name == gpio.pin_name);
+            CHECK(configured->pin_value == (value & 1));
+        }
+        else
+        {
+            CHECK(configured->pin_name == "before");
+            CHECK(configured->pin_value == ((value & 1) ^ 1));
+        }
+    }
+}
+
+
+/**
+ * @brief names of binary configs must be UTF-8 - they are sent back in JSON status.
+ */
+static void testBinaryConfigName ()
+{
+    const struct {
+        const char* name;
+        bool valid;
+    } names[] = {
+        {"pump", true},
+        {"v\xC3\xA4lve", true},              // U+00E4
+        {"\xE2\x82\xAC", true},             // U+20AC
+        {"\xF0\x9F\x98\x80", true},         // U+1F600
+        {"\xF4\x8F\xBF\xBF", true},         // U+10FFFF
+        {"\xC3", false},                    // truncated
+        {"\xE2\x82", false},
+        {"\xC0\xAF", false},                // overlong '/'
+        {"\xE0\x80\xAF", false},
+        {"\xED\xA0\x80", false},            // surrogate
+        {"\xF4\x90\x80\x80", false},        // above U+10FFFF
+        {"\xFF", false},
+        {"a\x80", false},
+    };
+
+    for (const auto& name : names)
+    {
+        GPIO gpio = makeGPIO(19, OUTPUT, name.name);
+        std::vector<uint8_t> payload;
+        CGPIOCommandCodec::encodeConfig(&gpio, 1, payload);
+
+        std::vector<GPIO> gpios;
+        CHECK(CGPIOCommandCodec::decodeConfig(payload.data(), payload.size(), gpios) == name.valid);
+        if (name.valid) CHECK((gpios.size() == 1) && (gpios[0].pin_name == name.name));
+    }
+}
+
+
+/**
+ * @brief names that do not fit a snapshot are rejected, not truncated.
+ */
+static void testLongName ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    driver.configurePort(makeGPIO(23, OUTPUT, "out_23"));
+
+    const std::string longest(GPIO_STATE_NAME_MAX, 'x');
+    receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 23}, {"m", OUTPUT}, {"v", 0}, {"n", longest + "y"}}));
+    CHECK(driver.getGPIOByNumber(23) != nullptr);
+    CHECK(driver.getGPIOByNumber(23)->pin_name == "out_23");
+    CHECK(driver.getGPIOByName(longest + "y") == nullptr);
+
+    receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 23}, {"m", OUTPUT}, {"v", 0}, {"n", longest}}));
+    CHECK(driver.getGPIOByName(longest) == driver.getGPIOByNumber(23));
+}
+
+
+/**
+ * @brief text messages with and without trailing '\0' stay text.
+ */
+static void testTextMessage ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    driver.configurePort(makeGPIO(22, OUTPUT, "out_22"));
+
+    receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "out_22"}, {"v", 1}}));
+    CHECK(pinValue(22) == 1);
+
+    std::string message = textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"p", 22}, {"v", 0}});
+    message.push_back('\0');
+    receive(message);
+    CHECK(pinValue(22) == 0);
+}
+
+
+/**
+ * @brief pins of a batch are compared with their state before it - not with each other write of the batch.
+ */
+static void testBatchWriteBack ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    driver.configurePort(makeGPIO(25, OUTPUT, "out_25"));
+    driver.configurePort(makeGPIO(18, PWM_OUTPUT, "pwm_18"));
+    receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"p", 18}, {"v", 1000}, {"d", 100}}));
+
+    const uint64_t pins = (1ull << 25) | (1ull << 18);
+    uint64_t reported = 0;
+    CGPIONotifier::getInstance().setSendHandler([&reported](const uint64_t pin_mask){ reported |= pin_mask; });
+    driver.takeDirtyMask();
+
+    // written and written back - nothing changed.
+    receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"l", {
+        {{"p", 25}, {"v", 1}}, {{"p", 25}, {"v", 0}},
+        {{"p", 18}, {"v", 1000}, {"d", 200}}, {{"p", 18}, {"v", 1000}, {"d", 100}}
+    }}}));
+    CHECK(pinValue(25) == 0);
+    CHECK(driver.getGPIOByNumber(18)->pin_pwm_width == 100);
+    CHECK((reported & pins) == 0);
+    CHECK((driver.takeDirtyMask() & pins) == 0);
+
+    // last write differs from the start of the batch.
+    receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"l", {
+        {{"p", 25}, {"v", 0}}, {{"p", 25}, {"v", 1}},
+        {{"p", 18}, {"v", 1000}, {"d", 100}}, {{"p", 18}, {"v", 1000}, {"d", 300}}
+    }}}));
+    CHECK(pinValue(25) == 1);
+    CHECK(driver.getGPIOByNumber(18)->pin_pwm_width == 300);
+    CHECK((reported & pins) == pins);
+    CHECK((driver.takeDirtyMask() & pins) == pins);
+
+    CGPIONotifier::getInstance().setSendHandler(nullptr);
+}
+
+
+/**
+ * @brief a status request with a status format that is not an integer still gets its status.
+ */
+static void testStatusFormatType ()
+{
+    const Json_de formats[] = {"1", 1.5, true, Json_de::array(), nullptr, 1};
+
+    uint failed = 0;
+    for (const Json_de& format : formats)
+    {
+        try
+        {
+            receive(textMessage({{"a", TYPE_AndruavMessage_GPIO_STATUS}, {"f", format}}, "test", TYPE_AndruavMessage_GPIO_REMOTE_EXECUTE));
+        }
+        catch (const std::exception&)
+        {
+            ++failed;
+        }
+    }
+    CHECK(failed == 0);
+}
+
+
+/**
+ * @brief running actuator is blocked by a task until release() - commands queue behind it.
+ */
+class CActuatorHold
+{
+    public:
+
+        CActuatorHold()
+        {
+            CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_NORMAL, [this](){
+                while (!m_released.load()) std::this_thread::yield();
+            });
+        }
+
+        void release ()
+        {
+            m_released.store(true);
+
+            // bulk lane runs once priority & normal lanes are empty.
+            std::atomic<bool> idle {false};
+            CGPIOActuator::getInstance().submitTask(GPIO_ACTUATOR_LANE_BULK, [&idle](){ idle.store(true); });
+            while (!idle.load()) std::this_thread::yield();
+        }
+
+    private:
+
+        std::atomic<bool> m_released {false};
+};
+
+
+static Json_de loopPattern (const uint pin_number)
+{
+    Json_de steps = Json_de::array();
+    for (uint i = 0; i < 4; ++i)
+    {
+        steps.push_back({{"m", 1ull << pin_number}, {"v", i & 1}, {"d", GPIO_SEQUENCER_MIN_CYCLE_US / 4}});
+    }
+
+    return {{"a", GPIO_ACTION_PATTERN}, {"s", steps}, {"r", true}};
+}
+
+
+/**
+ * @brief a pattern stop is served on priority lane - a start queued before it must not run after it.
+ */
+static void testStopAfterStart ()
+{
+    CGPIOSequencer& sequencer = CGPIOSequencer::getInstance();
+    CGPIODriver::getInstance().configurePort(makeGPIO(24, OUTPUT, "pattern_24"));
+
+    {
+        CActuatorHold hold;
+        receive(textMessage(loopPattern(24)));
+        hold.release();
+    }
+    CHECK(sequencer.isRunning());
+
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PATTERN}}));
+        receive(textMessage(loopPattern(24)));
+        hold.release();
+    }
+    CHECK(sequencer.isRunning());
+
+    {
+        CActuatorHold hold;
+        receive(textMessage(loopPattern(24)));
+        receive(textMessage({{"a", GPIO_ACTION_PATTERN}}));
+        hold.release();
+    }
+    CHECK(!sequencer.isRunning());
+}
+
+
+/**
+ * @brief writes - priority lane ones included - are applied after a queued PORT_CONFIG of their pin.
+ */
+static void testWriteAfterConfig ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 5}, {"m", OUTPUT}, {"v", 0}, {"n", "late_5"}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "late_5"}, {"v", 1}}, ANDRUAV_PROTOCOL_SENDER_COMM_SERVER));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 6}, {"m", OUTPUT}, {"v", 0}, {"n", "late_6"}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"p", 6}, {"v", 1}}, ANDRUAV_PROTOCOL_SENDER_COMM_SERVER));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 7}, {"m", OUTPUT}, {"v", 0}, {"n", "late_7"}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"l", {{{"n", "late_7"}, {"v", 1}}, {{"p", 5}, {"v", 0}}}}}));
+        hold.release();
+    }
+    CHECK(pinValue(5) == 0);
+    CHECK(pinValue(6) == 1);
+    CHECK(pinValue(7) == 1);
+
+    // nothing queued - names come from snapshot.
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "late_5"}, {"v", 1}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "missing"}, {"v", 1}}));
+        hold.release();
+    }
+    CHECK(pinValue(5) == 1);
+
+    // a renaming config decides which pin a later write by name reaches.
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 5}, {"m", OUTPUT}, {"v", 0}, {"n", "renamed_5"}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 6}, {"m", OUTPUT}, {"v", 0}, {"n", "late_5"}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "late_5"}, {"v", 1}}));
+        hold.release();
+    }
+    CHECK(pinValue(5) == 0);
+    CHECK(pinValue(6) == 1);
+    CHECK(driver.getGPIOByName("late_5") == driver.getGPIOByNumber(6));
+}
+
+
+/**
+ * @brief a priority write replaces an older write to its pin still queued in normal lane.
+ */
+static void testPriorityWriteWins ()
+{
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    driver.configurePort(makeGPIO(8, OUTPUT, "failsafe_8"));
+    driver.configurePort(makeGPIO(9, OUTPUT, "other_9"));
+
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"l", {{{"p", 8}, {"v", 1}}, {{"p", 9}, {"v", 1}}}}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"p", 8}, {"v", 0}}, ANDRUAV_PROTOCOL_SENDER_COMM_SERVER));
+        hold.release();
+    }
+    CHECK(pinValue(8) == 0);
+    CHECK(pinValue(9) == 1);
+
+    // binary writes and writes by name alike.
+    {
+        CActuatorHold hold;
+        const GPIO_WRITE_COMMAND command = {8, 1, 0, false};
+        std::vector<uint8_t> payload;
+        CGPIOCommandCodec::encodeWrite(&command, 1, payload);
+        receive(binaryMessage(GPIO_ACTION_PORT_WRITE, payload));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "failsafe_8"}, {"v", 1}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "failsafe_8"}, {"v", 0}}, ANDRUAV_PROTOCOL_SENDER_COMM_SERVER));
+        hold.release();
+    }
+    CHECK(pinValue(8) == 0);
+
+    // named write resolved by actuator behind a queued config.
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PORT_CONFIG}, {"p", 9}, {"m", OUTPUT}, {"v", 0}, {"n", "other_9"}}));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"n", "failsafe_8"}, {"v", 1}}));
+        hold.release();
+    }
+    CHECK(pinValue(8) == 1);
+
+    // later normal writes are applied again.
+    {
+        CActuatorHold hold;
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"p", 8}, {"v", 0}}, ANDRUAV_PROTOCOL_SENDER_COMM_SERVER));
+        receive(textMessage({{"a", GPIO_ACTION_PORT_WRITE}, {"p", 8}, {"v", 1}}));
+        hold.release();
+    }
+    CHECK(pinValue(8) == 1);
+}
+
+
+int main ()
+{
+    {
+        CQuietConsole quiet;
+
+        CGPIODriver::getInstance().init();
+
+        testBinaryWriteLastByte();
+        testBinaryConfigLastByte();
+        testBinaryConfigName();
+        testTextMessage();
+        testLongName();
+        testStatusFormatType();
+        testBatchWriteBack();
+
+        CGPIOActuator::getInstance().start(GPIO_ACTUATOR_DEFAULT_QUEUE);
+        testStopAfterStart();
+        testWriteAfterConfig();
+        testPriorityWriteWins();
+        CGPIOActuator::getInstance().uninit();
+        CGPIOSequencer::getInstance().uninit();
+    }
+
+    return report("gpio_parser_test");
+}
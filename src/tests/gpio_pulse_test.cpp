@@ -0,0 +1,143 @@
+/**
+ * @brief CGPIOPulse keeps the event thread as the only writer of counters across reset().
+ */
+
+#include <thread>
+#include <atomic>
+
+#include "../gpio/gpio_pulse.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+#define TEST_PIN 17
+#define TEST_PERIOD_NS 1000000ull
+#define TEST_HIGH_NS 250000ull
+
+
+/**
+ * @brief rising & falling edge of a 1 kHz, 25% duty pulse.
+ */
+static void pulse (CGPIOPulse& counter, const uint64_t index)
+{
+    const uint64_t rise_ns = (index + 1) * TEST_PERIOD_NS;
+    counter.onEdge(TEST_PIN, 1, rise_ns);
+    counter.onEdge(TEST_PIN, 0, rise_ns + TEST_HIGH_NS);
+}
+
+
+static PULSE_MEASUREMENT measure (CGPIOPulse& counter)
+{
+    std::vector<PULSE_MEASUREMENT> measurements;
+    counter.takeMeasurements(1ull << TEST_PIN, measurements);
+    return measurements.empty() ? PULSE_MEASUREMENT() : measurements[0];
+}
+
+
+static void testMeasurement ()
+{
+    CGPIOPulse counter;
+
+    for (uint64_t i = 0; i < 11; ++i) pulse(counter, i);
+
+    const PULSE_MEASUREMENT measurement = measure(counter);
+    CHECK(measurement.count == 11);
+    CHECK(measurement.pulses == 11);
+    CHECK(measurement.period_us == 1000.0);
+    CHECK(measurement.width_us == 250.0);
+    CHECK(measurement.duty == 0.25);
+
+    CHECK(measure(counter).pulses == 0);
+}
+
+
+static void testResetBeforeEdge ()
+{
+    CGPIOPulse counter;
+
+    for (uint64_t i = 0; i < 5; ++i) pulse(counter, i);
+    CHECK(measure(counter).count == 5);
+
+    for (uint64_t i = 5; i < 8; ++i) pulse(counter, i);
+    counter.reset(TEST_PIN);
+
+    // no edge since reset - old counters are not reported.
+    PULSE_MEASUREMENT measurement = measure(counter);
+    CHECK(measurement.count == 0);
+    CHECK(measurement.pulses == 0);
+    CHECK(measurement.frequency == 0.0);
+
+    // first rise after reset starts a new period.
+    for (uint64_t i = 100; i < 103; ++i) pulse(counter, i);
+    measurement = measure(counter);
+    CHECK(measurement.count == 3);
+    CHECK(measurement.pulses == 3);
+    CHECK(measurement.period_us == 1000.0);
+}
+
+
+static void testResetAfterMeasurement ()
+{
+    CGPIOPulse counter;
+
+    for (uint64_t i = 0; i < 20; ++i) pulse(counter, i);
+    CHECK(measure(counter).pulses == 20);
+
+    counter.reset(TEST_PIN);
+    for (uint64_t i = 20; i < 22; ++i) pulse(counter, i);
+
+    // baseline of previous generation must not be subtracted.
+    const PULSE_MEASUREMENT measurement = measure(counter);
+    CHECK(measurement.count == 2);
+    CHECK(measurement.pulses == 2);
+}
+
+
+/**
+ * @brief edges, resets and measurements on their own threads as in the driver.
+ */
+static void testConcurrentReset ()
+{
+    CGPIOPulse counter;
+    std::atomic<bool> done {false};
+    const uint64_t edges = 200000;
+
+    std::thread events([&](){
+        for (uint64_t i = 0; i < edges; ++i) pulse(counter, i);
+        done.store(true);
+    });
+
+    std::thread actuator([&](){
+        while (!done.load())
+        {
+            counter.reset(TEST_PIN);
+            std::this_thread::yield();
+        }
+    });
+
+    uint64_t bad = 0;
+    while (!done.load())
+    {
+        const PULSE_MEASUREMENT measurement = measure(counter);
+        if ((measurement.pulses > measurement.count) || (measurement.count > edges)) ++bad;
+    }
+
+    events.join();
+    actuator.join();
+
+    CHECK(bad == 0);
+}
+
+
+int main ()
+{
+    testMeasurement();
+    testResetBeforeEdge();
+    testResetAfterMeasurement();
+    testConcurrentReset();
+
+    return report("gpio_pulse_test");
+}
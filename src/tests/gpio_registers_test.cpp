@@ -0,0 +1,155 @@
+/**
+ * @brief Bit handling of CGPIORegisters on a register file.
+ *
+ * GPSET/GPCLR writes of both banks must land in the right words and be mirrored into GPLEV,
+ * GPFSEL fields must not touch neighbour pins, and a missing device must not become a file.
+ */
+
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../gpio/gpio_registers.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+static std::string tempPath (const char* name)
+{
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir ? dir : "/tmp") + "/" + name + "." + std::to_string(getpid());
+}
+
+
+static bool exists (const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+
+static void testMissingDevice ()
+{
+    const std::string path = tempPath("gpiomem_missing");
+    unlink(path.c_str());
+
+    CGPIORegisters registers;
+    CHECK(!registers.open(path, false));
+    CHECK(!registers.isOpen());
+    CHECK(!exists(path));
+}
+
+
+static void testRegularFileNeedsRegisterFileMode ()
+{
+    const std::string path = tempPath("gpiomem_regular");
+
+    {
+        CGPIORegisters registers;
+        CHECK(registers.open(path, true));
+    }
+
+    CGPIORegisters registers;
+    CHECK(!registers.open(path, false));
+    CHECK(!registers.isOpen());
+
+    unlink(path.c_str());
+}
+
+
+static void testSetClearLevels ()
+{
+    const std::string path = tempPath("gpiomem_file");
+    unlink(path.c_str());
+
+    CGPIORegisters registers;
+    CHECK(registers.open(path, true));
+    CHECK(registers.isFileBacked());
+    CHECK(registers.readLevels(0) == 0);
+    CHECK(registers.readLevels(1) == 0);
+
+    registers.setMask(0, (1u << 4) | (1u << 31));
+    CHECK(registers.readLevels(0) == ((1u << 4) | (1u << 31)));
+    CHECK(registers.readLevels(1) == 0);
+
+    registers.setMask(1, 1u << (53 - GPIO_REG_BANK_PINS));
+    CHECK(registers.readPin(53) == 1);
+    CHECK(registers.readPin(32) == 0);
+
+    registers.clearMask(0, 1u << 4);
+    CHECK(registers.readLevels(0) == (1u << 31));
+    CHECK(registers.readPin(4) == 0);
+    CHECK(registers.readPin(31) == 1);
+
+    registers.writePin(32, 1);
+    registers.writePin(53, 0);
+    CHECK(registers.readLevels(1) == 1u);
+
+    registers.writePin(0, 1);
+    registers.writePin(0, 1);
+    CHECK(registers.readPin(0) == 1);
+    registers.writePin(0, 0);
+    CHECK(registers.readPin(0) == 0);
+
+    registers.close();
+    CHECK(!registers.isOpen());
+
+    // levels persist in the file.
+    CHECK(registers.open(path, true));
+    CHECK(registers.readLevels(0) == (1u << 31));
+    CHECK(registers.readLevels(1) == 1u);
+
+    unlink(path.c_str());
+}
+
+
+static void testFunctionSelect ()
+{
+    const std::string path = tempPath("gpiomem_fsel");
+    unlink(path.c_str());
+
+    CGPIORegisters registers;
+    CHECK(registers.open(path, true));
+
+    // pins 9 & 10 sit at the border of GPFSEL0 and GPFSEL1.
+    registers.setFunction(9, GPIO_FSEL_OUTPUT);
+    registers.setFunction(10, GPIO_FSEL_OUTPUT);
+    registers.setFunction(11, 4);
+    CHECK(registers.getFunction(9) == GPIO_FSEL_OUTPUT);
+    CHECK(registers.getFunction(10) == GPIO_FSEL_OUTPUT);
+    CHECK(registers.getFunction(11) == 4);
+    CHECK(registers.getFunction(8) == GPIO_FSEL_INPUT);
+    CHECK(registers.getFunction(12) == GPIO_FSEL_INPUT);
+
+    registers.setFunction(10, GPIO_FSEL_INPUT);
+    CHECK(registers.getFunction(10) == GPIO_FSEL_INPUT);
+    CHECK(registers.getFunction(11) == 4);
+
+    registers.setFunction(53, GPIO_FSEL_OUTPUT);
+    CHECK(registers.getFunction(53) == GPIO_FSEL_OUTPUT);
+
+    // out of range is ignored.
+    registers.setFunction(GPIO_REG_MAX_PIN + 1, GPIO_FSEL_OUTPUT);
+    CHECK(registers.getFunction(50) == GPIO_FSEL_INPUT);
+
+    unlink(path.c_str());
+}
+
+
+int main ()
+{
+    {
+        CQuietConsole quiet;
+
+        testMissingDevice();
+        testRegularFileNeedsRegisterFileMode();
+        testSetClearLevels();
+        testFunctionSelect();
+    }
+
+    return report("gpio_registers_test");
+}
@@ -0,0 +1,104 @@
+/**
+ * @brief CGPIOSequencer accepts only patterns it can time without spinning.
+ */
+
+#include "../gpio/gpio_sequencer.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+static GPIO_SEQUENCE makeSequence (const uint steps, const uint32_t duration_us, const bool loop)
+{
+    GPIO_SEQUENCE sequence;
+    for (uint i = 0; i < steps; ++i)
+    {
+        sequence.steps.push_back({1ull << 21, i & 1, duration_us});
+    }
+    sequence.loop = loop;
+    return sequence;
+}
+
+
+static void testStepDuration ()
+{
+    CGPIOSequencer& sequencer = CGPIOSequencer::getInstance();
+
+    CHECK(!sequencer.start(makeSequence(2, 0, false)));
+    CHECK(!sequencer.start(makeSequence(2, GPIO_SEQUENCER_MIN_STEP_US - 1, false)));
+    CHECK(!sequencer.isRunning());
+
+    GPIO_SEQUENCE sequence = makeSequence(2, 1000, false);
+    sequence.steps[1].duration_us = 0;
+    CHECK(!sequencer.start(sequence));
+
+    CHECK(sequencer.start(makeSequence(2, GPIO_SEQUENCER_MIN_STEP_US, false)));
+    sequencer.stop();
+}
+
+
+static void testLoopCycle ()
+{
+    CGPIOSequencer& sequencer = CGPIOSequencer::getInstance();
+
+    const uint32_t step_us = GPIO_SEQUENCER_MIN_CYCLE_US / 4;
+
+    CHECK(!sequencer.start(makeSequence(2, step_us, true)));
+    CHECK(!sequencer.isRunning());
+
+    // same steps are fine once.
+    CHECK(sequencer.start(makeSequence(2, step_us, false)));
+    sequencer.stop();
+
+    CHECK(sequencer.start(makeSequence(4, step_us, true)));
+    CHECK(sequencer.isRunning());
+    sequencer.stop();
+    CHECK(!sequencer.isRunning());
+}
+
+
+/**
+ * @brief a looped pattern of minimum steps passes the cycle check but would only busy wait.
+ */
+static void testLoopSpin ()
+{
+    CGPIOSequencer& sequencer = CGPIOSequencer::getInstance();
+
+    const uint steps = GPIO_SEQUENCER_MIN_CYCLE_US / GPIO_SEQUENCER_MIN_STEP_US;
+    CHECK(!sequencer.start(makeSequence(steps, GPIO_SEQUENCER_MIN_STEP_US, true)));
+    CHECK(!sequencer.isRunning());
+
+    // longest step that still spins more than allowed, and shortest that does not.
+    const uint32_t limit_us = GPIO_SEQUENCER_SPIN_US * 100 / GPIO_SEQUENCER_MAX_SPIN_PERCENT;
+    CHECK(!sequencer.start(makeSequence(8, limit_us - 1, true)));
+    CHECK(sequencer.start(makeSequence(8, limit_us, true)));
+    sequencer.stop();
+
+    // few short steps in a long cycle are fine.
+    GPIO_SEQUENCE sequence = makeSequence(4, GPIO_SEQUENCER_MIN_STEP_US, true);
+    sequence.steps[3].duration_us = GPIO_SEQUENCER_MIN_CYCLE_US;
+    CHECK(sequencer.start(sequence));
+    sequencer.stop();
+
+    // one-shot patterns end by themselves.
+    CHECK(sequencer.start(makeSequence(steps, GPIO_SEQUENCER_MIN_STEP_US, false)));
+    sequencer.stop();
+}
+
+
+int main ()
+{
+    {
+        CQuietConsole quiet;
+
+        testStepDuration();
+        testLoopCycle();
+        testLoopSpin();
+
+        CGPIOSequencer::getInstance().uninit();
+    }
+
+    return report("gpio_sequencer_test");
+}
@@ -0,0 +1,136 @@
+/**
+ * @brief Stress of the pin state seqlock - built with -fsanitize=thread as de_rpi_gpio_tsan.
+ *
+ * A writer toggles all output pins with one writePinMasks while another renames a pin through
+ * configurePort. Readers take lock-free snapshots, and every snapshot must show all output pins
+ * at the same level and each name with its own pin number. ThreadSanitizer reports any access
+ * of pin state that is not ordered by the seqlock.
+ *
+ *      de_rpi_gpio_tsan [toggles]
+ */
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+#include "../gpio/gpio_driver.hpp"
+#include "gpio_test.hpp"
+
+
+#define STRESS_OUTPUT_PINS      16
+#define STRESS_RENAMED_PIN      20
+#define STRESS_READERS          2
+#define STRESS_DEFAULT_TOGGLES  100000
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+static GPIO makeGPIO (const uint pin_number, const std::string& name)
+{
+    GPIO gpio;
+    gpio.pin_number = pin_number;
+    gpio.pin_mode = OUTPUT;
+    gpio.pin_value = 0;
+    gpio.pin_pwm_width = 0;
+    gpio.gpio_type = ENUM_GPIO_TYPE::GENERIC;
+    gpio.pin_name = name;
+    return gpio;
+}
+
+
+static std::string renamedName (const uint generation)
+{
+    // both names fill the snapshot name field so a torn copy mixes them.
+    return std::string(GPIO_STATE_NAME_MAX, (generation & 1) ? 'b' : 'a');
+}
+
+
+int main (int argc, char *argv[])
+{
+    const uint toggles = (argc > 1) ? std::atoi(argv[1]) : STRESS_DEFAULT_TOGGLES;
+
+    CGPIODriver& driver = CGPIODriver::getInstance();
+    std::atomic<bool> done {false};
+    std::atomic<uint64_t> snapshots {0};
+    std::atomic<uint64_t> torn {0};
+
+    {
+        CQuietConsole quiet;
+
+        driver.init();
+        for (uint i = 0; i < STRESS_OUTPUT_PINS; ++i)
+        {
+            driver.configurePort(makeGPIO(i, "out_" + std::to_string(i)));
+        }
+        driver.configurePort(makeGPIO(STRESS_RENAMED_PIN, renamedName(0)));
+
+        const uint64_t output_mask = (1ull << STRESS_OUTPUT_PINS) - 1;
+
+        std::thread toggler([&](){
+            for (uint i = 0; i < toggles; ++i)
+            {
+                if (i & 1)
+                {
+                    driver.writePinMasks(output_mask, 0);
+                }
+                else
+                {
+                    driver.writePinMasks(0, output_mask);
+                }
+            }
+            done = true;
+        });
+
+        std::thread renamer([&](){
+            for (uint generation = 1; !done; ++generation)
+            {
+                driver.configurePort(makeGPIO(STRESS_RENAMED_PIN, renamedName(generation)));
+            }
+        });
+
+        std::thread readers[STRESS_READERS];
+        for (std::thread& reader : readers)
+        {
+            reader = std::thread([&](){
+                GPIO_SNAPSHOT snapshot;
+                while (!done)
+                {
+                    driver.getGPIOSnapshot(snapshot);
+                    snapshots.fetch_add(1, std::memory_order_relaxed);
+
+                    bool consistent = ((snapshot.used_mask & output_mask) == output_mask);
+                    for (uint i = 1; consistent && (i < STRESS_OUTPUT_PINS); ++i)
+                    {
+                        consistent = (snapshot.gpios[i].pin_value == snapshot.gpios[0].pin_value);
+                    }
+
+                    const GPIO_STATE& renamed = snapshot.gpios[STRESS_RENAMED_PIN];
+                    if (consistent && (snapshot.used_mask & (1ull << STRESS_RENAMED_PIN)))
+                    {
+                        const std::string name(renamed.pin_name, renamed.name_length);
+                        consistent = (renamed.pin_number == STRESS_RENAMED_PIN)
+                                  && ((name == renamedName(0)) || (name == renamedName(1)));
+                    }
+
+                    if (!consistent) torn.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        toggler.join();
+        renamer.join();
+        for (std::thread& reader : readers) reader.join();
+
+        driver.uninit();
+    }
+
+    CHECK(snapshots.load() > 0);
+    CHECK(torn.load() == 0);
+
+    s_console << "snapshots: " << snapshots.load() << " torn: " << torn.load() << std::endl;
+
+    return report("gpio_snapshot_stress");
+}
@@ -0,0 +1,134 @@
+/**
+ * @brief CGPIOStatusCodec frames decode to the pins they were encoded from.
+ */
+
+#include <string>
+#include <vector>
+
+#include "../gpio/gpio_status_codec.hpp"
+#include "gpio_test.hpp"
+
+
+using namespace de::gpio;
+using namespace de::gpio::test;
+
+
+static GPIO makeGPIO (const uint pin_number, const uint pin_mode, const uint pin_value, const uint pin_pwm_width, const ENUM_GPIO_TYPE gpio_type, const std::string& name)
+{
+    GPIO gpio;
+    gpio.pin_number = pin_number;
+    gpio.pin_mode = pin_mode;
+    gpio.pin_value = pin_value;
+    gpio.pin_pwm_width = pin_pwm_width;
+    gpio.gpio_type = gpio_type;
+    gpio.pin_name = name;
+    return gpio;
+}
+
+
+static bool same (const GPIO& a, const GPIO& b)
+{
+    return (a.pin_number == b.pin_number) && (a.pin_mode == b.pin_mode) && (a.pin_value == b.pin_value)
+        && (a.pin_pwm_width == b.pin_pwm_width) && (a.gpio_type == b.gpio_type) && (a.pin_name == b.pin_name);
+}
+
+
+/**
+ * @brief one pin of every kind the frame has a field for - encoded out of pin order.
+ */
+static std::vector<GPIO> makePins ()
+{
+    return {
+        makeGPIO(53, OUTPUT, 1, 0, ENUM_GPIO_TYPE::GENERIC, "last"),
+        makeGPIO(0, INPUT, 0, 0, ENUM_GPIO_TYPE::GENERIC, ""),
+        makeGPIO(18, PWM_OUTPUT, 1, 512, ENUM_GPIO_TYPE::GENERIC, "fan"),
+        makeGPIO(17, SOFT_PWM_OUTPUT, 0, 1023, ENUM_GPIO_TYPE::GENERIC, "led"),
+        makeGPIO(21, OUTPUT, 1, 0, ENUM_GPIO_TYPE::SYSTEM, "power"),
+        makeGPIO(22, INPUT, 100000, 0, ENUM_GPIO_TYPE::GENERIC, "wide"),
+        makeGPIO(23, INPUT, 1, 0, ENUM_GPIO_TYPE::GENERIC, std::string(255, 'n')),
+    };
+}
+
+
+static void testRoundTrip ()
+{
+    const std::vector<GPIO> pins = makePins();
+
+    std::vector<uint8_t> frame;
+    CGPIOStatusCodec::encode(pins.data(), pins.size(), frame);
+
+    std::vector<GPIO> decoded;
+    CHECK(CGPIOStatusCodec::decode(frame.data(), frame.size(), decoded));
+    CHECK(decoded.size() == pins.size());
+
+    // frame is in ascending pin order.
+    for (size_t i = 1; i < decoded.size(); ++i)
+    {
+        CHECK(decoded[i - 1].pin_number < decoded[i].pin_number);
+    }
+
+    for (const GPIO& pin : pins)
+    {
+        bool found = false;
+        for (const GPIO& gpio : decoded)
+        {
+            if (gpio.pin_number == pin.pin_number) found = same(gpio, pin);
+        }
+        CHECK(found);
+    }
+}
+
+
+static void testLimits ()
+{
+    const std::vector<GPIO> pins = {
+        makeGPIO(5, OUTPUT, 0, 0, ENUM_GPIO_TYPE::GENERIC, std::string(300, 'x')),
+        makeGPIO(MAX_GPIO_PINS, OUTPUT, 1, 0, ENUM_GPIO_TYPE::GENERIC, "beyond"),
+    };
+
+    std::vector<uint8_t> frame;
+    CGPIOStatusCodec::encode(pins.data(), pins.size(), frame);
+
+    // names are cut at 255 chars, pins beyond MAX_GPIO_PINS are left out.
+    std::vector<GPIO> decoded;
+    CHECK(CGPIOStatusCodec::decode(frame.data(), frame.size(), decoded));
+    CHECK(decoded.size() == 1);
+    CHECK(!decoded.empty() && (decoded[0].pin_name == std::string(255, 'x')));
+
+    // empty frame still has version & bitmaps.
+    CGPIOStatusCodec::encode(pins.data(), 0, frame);
+    CHECK(frame.size() == 17);
+    CHECK(CGPIOStatusCodec::decode(frame.data(), frame.size(), decoded));
+    CHECK(decoded.empty());
+}
+
+
+static void testMalformed ()
+{
+    const std::vector<GPIO> pins = makePins();
+
+    std::vector<uint8_t> frame;
+    CGPIOStatusCodec::encode(pins.data(), pins.size(), frame);
+
+    // every truncation is rejected.
+    std::vector<GPIO> decoded;
+    uint accepted = 0;
+    for (size_t length = 0; length < frame.size(); ++length)
+    {
+        if (CGPIOStatusCodec::decode(frame.data(), length, decoded)) ++accepted;
+    }
+    CHECK(accepted == 0);
+
+    frame[0] = GPIO_STATUS_BINARY_VERSION + 1;
+    CHECK(!CGPIOStatusCodec::decode(frame.data(), frame.size(), decoded));
+}
+
+
+int main ()
+{
+    testRoundTrip();
+    testLimits();
+    testMalformed();
+
+    return report("gpio_status_codec_test");
+}
@@ -0,0 +1,83 @@
+#ifndef GPIO_TEST_H_
+#define GPIO_TEST_H_
+
+#include <iostream>
+#include <streambuf>
+
+
+/**
+ * @brief Minimal checks shared by test binaries of src/tests.
+ *
+ * A failed CHECK prints its location and the test binary exits with the number of failures.
+ */
+#define CHECK(condition) \
+    do { \
+        ++de::gpio::test::s_checks; \
+        if (!(condition)) \
+        { \
+            ++de::gpio::test::s_failures; \
+            de::gpio::test::s_console << "FAIL " << __FILE__ << ":" << __LINE__ << " " << #condition << std::endl; \
+        } \
+    } while (0)
+
+
+namespace de
+{
+namespace gpio
+{
+namespace test
+{
+
+    /**
+     * @brief discards console output of the code under test.
+     */
+    class CNullBuffer : public std::streambuf
+    {
+        protected:
+            int overflow (int c) override { return c; }
+    };
+
+
+    inline int s_checks = 0;
+    inline int s_failures = 0;
+    inline std::ostream s_console (std::cout.rdbuf());
+
+
+    /**
+     * @brief silence code under test while checks still report to console.
+     */
+    class CQuietConsole
+    {
+        public:
+
+            CQuietConsole()
+            {
+                m_cout = std::cout.rdbuf(&m_null);
+                m_cerr = std::cerr.rdbuf(&m_null);
+            }
+
+            ~CQuietConsole()
+            {
+                std::cout.rdbuf(m_cout);
+                std::cerr.rdbuf(m_cerr);
+            }
+
+        private:
+
+            CNullBuffer m_null;
+            std::streambuf* m_cout;
+            std::streambuf* m_cerr;
+    };
+
+
+    inline int report (const char* name)
+    {
+        s_console << name << ": " << (s_checks - s_failures) << "/" << s_checks << " checks passed." << std::endl;
+        return s_failures;
+    }
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * @brief decodes a flight recorder ring file to CSV or JSON.
+ *
+ * de_rpi_gpio_recorder_decode [--json] <ring file>
+ *
+ * Works on the ring of a running or crashed module. Records being written at that moment
+ * are skipped. Timestamps are converted to wall clock using the GPIO_RECORD_START record
+ * of each run.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "../gpio/gpio_recorder.hpp"
+#include "../gpio/gpio_latency.hpp"
+
+
+using namespace de::gpio;
+
+
+typedef struct DECODED_RECORD{
+        uint64_t sequence;
+        uint64_t timestamp_ns;
+        uint64_t value;
+        uint32_t extra;
+        uint8_t type;
+        uint8_t pin;
+        uint16_t source;
+    } DECODED_RECORD;
+
+
+static const char* type_names[] = {
+    "start",
+    "config",
+    "pin",
+    "pwm",
+    "command",
+    "edge"
+};
+
+
+static const char* getTypeName (const uint8_t type)
+{
+    if (type >= sizeof(type_names) / sizeof(type_names[0])) return "unknown";
+
+    return type_names[type];
+}
+
+
+static const char* getSourceName (const uint16_t source)
+{
+    return (source == GPIO_RECORD_SOURCE_INPUT) ? "input" : "write";
+}
+
+
+/**
+ * @brief action name for command records, empty otherwise.
+ */
+static const char* getDetail (const DECODED_RECORD& record)
+{
+    if (record.type != GPIO_RECORD_COMMAND) return "";
+
+    return CGPIOLatency::getActionName(static_cast<int>(record.value));
+}
+
+
+static bool readRing (const char* path, std::vector<DECODED_RECORD>& records, GPIO_RECORDER_HEADER& header)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Error: Unable to open " << path << std::endl;
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file
+        || (memcmp(header.magic, GPIO_RECORDER_MAGIC, sizeof(header.magic)) != 0)
+        || (header.version != GPIO_RECORDER_VERSION)
+        || (header.record_size != sizeof(GPIO_RECORD)))
+    {
+        std::cerr << "Error: " << path << " is not a flight recorder file of version " << GPIO_RECORDER_VERSION << std::endl;
+        return false;
+    }
+
+    std::vector<GPIO_RECORD> ring(header.capacity);
+    file.read(reinterpret_cast<char*>(ring.data()), header.capacity * sizeof(GPIO_RECORD));
+    if (!file)
+    {
+        std::cerr << "Error: " << path << " is truncated" << std::endl;
+        return false;
+    }
+
+    records.reserve(header.capacity);
+    for (uint64_t slot = 0; slot < header.capacity; ++slot)
+    {
+        const GPIO_RECORD& record = ring[slot];
+        const uint64_t sequence = record.sequence.load();
+        // empty slot, or record was being written.
+        if ((sequence == 0) || (((sequence - 1) & (header.capacity - 1)) != slot)) continue;
+
+        records.push_back({sequence, record.timestamp_ns, record.value, record.extra, record.type, record.pin, record.source});
+    }
+
+    std::sort(records.begin(), records.end(), [](const DECODED_RECORD& a, const DECODED_RECORD& b) { return a.sequence < b.sequence; });
+
+    return true;
+}
+
+
+int main (int argc, char *argv[])
+{
+    bool json = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else path = argv[i];
+    }
+
+    if (path == nullptr)
+    {
+        std::cerr << "usage: " << argv[0] << " [--json] <ring file>" << std::endl;
+        return 1;
+    }
+
+    GPIO_RECORDER_HEADER header;
+    std::vector<DECODED_RECORD> records;
+    if (!readRing(path, records, header)) return 1;
+
+    // wall clock = timestamp + offset of the run. runs whose START was overwritten use the file anchor.
+    int64_t offset_ns = static_cast<int64_t>(header.realtime_ns - header.monotonic_ns);
+
+    if (json) std::cout << "[";
+    else std::cout << "sequence,time_ns,monotonic_ns,type,pin,value,extra,source,detail" << std::endl;
+
+    bool first = true;
+    for (const DECODED_RECORD& record : records)
+    {
+        if (record.type == GPIO_RECORD_START)
+        {
+            offset_ns = static_cast<int64_t>(record.value - record.timestamp_ns);
+        }
+
+        const int64_t time_ns = static_cast<int64_t>(record.timestamp_ns) + offset_ns;
+        const int pin = (record.pin == GPIO_RECORD_NO_PIN) ? -1 : record.pin;
+
+        if (json)
+        {
+            std::cout << (first ? "" : ",") << std::endl
+                      << "{\"seq\":" << record.sequence
+                      << ",\"t\":" << time_ns
+                      << ",\"mono\":" << record.timestamp_ns
+                      << ",\"type\":\"" << getTypeName(record.type) << "\""
+                      << ",\"pin\":" << pin
+                      << ",\"value\":" << record.value
+                      << ",\"extra\":" << record.extra
+                      << ",\"source\":\"" << getSourceName(record.source) << "\""
+                      << ",\"detail\":\"" << getDetail(record) << "\"}";
+        }
+        else
+        {
+            std::cout << record.sequence << ","
+                      << time_ns << ","
+                      << record.timestamp_ns << ","
+                      << getTypeName(record.type) << ","
+                      << pin << ","
+                      << record.value << ","
+                      << record.extra << ","
+                      << getSourceName(record.source) << ","
+                      << getDetail(record) << std::endl;
+        }
+
+        first = false;
+    }
+
+    if (json) std::cout << std::endl << "]" << std::endl;
+
+    std::cerr << records.size() << " records, " << header.head.load() << " appended in total, ring of " << header.capacity << std::endl;
+
+    return 0;
+}